@@ -25,10 +25,20 @@ Author:
 #include <stdlib.h>
 #include <conio.h>
 #include <intrin.h>
+#include "PhaseRecord.h"
+#include "ClkWait.h"
+#include "TscPolicy.h"
 
 int gfErrorCorrection = 1;
+int gfVerifiedRead = 0;
+int gfChunkedWait = 0;                                  // interrupt friendly, CLKWAIT_CHUNK_US segments
+CLKWAIT_SEGREC gClkWaitSegRec;                          // segment end anchors of the last chunked wait
 
 uint16_t gPmTmrBlkAddr;
+volatile uint32_t* gpPmTmrMmio;                         // FADT X_PM_TMR_BLK in SystemMemory space, NULL if not available
+int gfPmTmrMmio = 0;                                    // read the PM timer via gpPmTmrMmio
+uint16_t gPm1aEvtBlkAddr;                               // PM1a_EVT_BLK, PM1_STS at offset 0
+int gfAcpiTmrSts = 0;                                   // wait long intervals coarse on TMR_STS
 int32_t pseudotimer;
 int32_t pseudotimer2;
 
@@ -45,74 +55,232 @@ uint32_t gCOUNTER_WIDTH = 24;
 
 unsigned GetACPICount(short p)
 {
-    return _inpd(p);
+    return gfPmTmrMmio ? *gpPmTmrMmio : _inpd(p);
 }
 
-int64_t AcpiClkWait/*pseudo delay upcount*/(int32_t Delay)
+/**
+  Get the cost of a single ACPI PM timer read via I/O or MMIO
+
+  The minimum of PMTMR_COST_ROUNDS rounds of PMTMR_COST_READS back-to-back reads is taken,
+  interrupts are disabled during each round.
+
+  @param  fMmio         read via gpPmTmrMmio instead of gPmTmrBlkAddr
+
+  @retval TSC per read, (uint64_t)~0 if the timer doesn't count on that path
+
+**/
+uint64_t AcpiPmTmrReadCost(int fMmio)
 {
-    static int cnt;
-    int64_t  count = Delay;
-    int64_t  qwTSCPerIntervall, qwTSCEnd, qwTSCStart;
+    uint64_t qwMin = (uint64_t)~0, qwTSC;
+    uint32_t dwFirst, dwLast = 0;
+    size_t eflags = __readeflags();                     // save flaags
+
+    for (int r = 0; r < PMTMR_COST_ROUNDS; r++)
+    {
+        _disable();
+
+        dwFirst = fMmio ? *gpPmTmrMmio : _inpd(gPmTmrBlkAddr);
+        qwTSC = ReadTSC();
+        for (int i = 0; i < PMTMR_COST_READS; i++)
+            dwLast = fMmio ? *gpPmTmrMmio : _inpd(gPmTmrBlkAddr);
+        qwTSC = ReadTSC() - qwTSC;
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        if (dwFirst == dwLast)                          // PMTMR_COST_READS reads take far longer than one tick
+            return (uint64_t)~0;
+
+        qwMin = qwTSC < qwMin ? qwTSC : qwMin;
+    }
+
+    return qwMin / PMTMR_COST_READS;
+}
+
+/**
+  Wait "Delay" ACPI ticks in the polling loop used before ClkWaitKernel.hpp
+
+  16 bit counter truncation, branchy wrap around and GetACPICount() per read.
+  Kept only as the reference of /BENCH "ACPI wait legacy", no error correction.
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, overshoot, number of reads, may be NULL
+
+  @retval number of TSC gone through
+
+**/
+int64_t AcpiClkWaitLegacy(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    int64_t count = Delay;
+    uint64_t qwTSCStart, qwTSCEnd;
+    uint32_t cntReads = 0;
+    uint16_t previous, current, diff = 0, maxdiff = 0;
     size_t eflags = __readeflags();                     // save flaags
 
     _disable();
-    GetACPICount(gPmTmrBlkAddr);
 
-    if (1)
+    previous = (uint16_t)GetACPICount(gPmTmrBlkAddr);
+    qwTSCStart = __rdtsc();
+
+    while (count > 0)
     {
-        uint16_t previous, current, diff = 0;
+        current = (uint16_t)GetACPICount(gPmTmrBlkAddr);
 
-        previous = (uint16_t)GetACPICount(gPmTmrBlkAddr);
-        qwTSCStart = __rdtsc();                             // get TSC start
+        if (current >= previous)
+            diff = current - previous;
+        else
+            diff = ~(previous - current) + 1;
 
-        while (count > 0)
-        {
-            current = (uint16_t)GetACPICount(gPmTmrBlkAddr);
+        previous = current;
 
-            if (current >= previous)
-                diff = current - previous;
-            else
-                diff = ~(previous - current) + 1;       //diff = ~(previous - current) + 1;
+        count -= diff;
+        cntReads++;
+        if (diff > maxdiff)
+            maxdiff = diff;
+    }
 
-            previous = current;
+    qwTSCEnd = __rdtsc();
 
-            count -= diff;
-        }
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
 
-        qwTSCEnd = __rdtsc();                                                   // get TSC end ~50ms
-        
-        printf("%lld       ", -count);                          // Additional ticks gone through: 
+    if (NULL != pDiag)
+    {
+        pDiag->qwOvershoot = -count;
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads;
+        pDiag->dwMaxStep = maxdiff;
+        pDiag->cntGlitch = 0;
+        pDiag->cntSegments = 1;
+        pDiag->cntWrapLost = 0;
+        pDiag->qwTSCWindowMax = 0;
+    }
 
-        //
-        // subtract the additional number of TSC gone through
-        //
-        //         TSCdiff          qwTSCPerIntervall
-        //     ---------------- == -------------------      ->
-        //      CLKWAIT - count        CLKWAIT
-        //
-        //
-        //                           TSCdiff * CLKWAIT
-        //      qwTSCPerIntervall = -------------------
-        //                            CLKWAIT - count
-        //
-        //          NOTE: "count" is negative. " - count " ADDs additional ticks gone through
-        //
-        if (1 == gfErrorCorrection)
+    return (int64_t)(qwTSCEnd - qwTSCStart);
+}
+
+//
+// let the CPU and the bus idle between two coarse reads
+//
+static void AcpiPauseBurst(void)
+{
+    for (int i = 0; i < ACPI_TMRSTS_PAUSES; i++)
+        _mm_pause();
+}
+
+/**
+  Wait "Delay" ACPI ticks coarse on the TMR_STS overflow edge and return the number of TSC gone through
+
+  The start and the end of the interval are taken by fine polling of the PM timer with interrupts
+  disabled. In between, whole MSB half periods are counted on the hardware latched TMR_STS bit
+  and the remainder is approached by sparse counter reads, both separated by PAUSE bursts.
+  Interrupts are enabled during that coarse phase, if they were before. The accuracy is
+  determined by the fine phases only.
+
+  @param  Delay         ACPI ticks to wait, >= ACPI_TMRSTS_MINDELAY
+  @param  pDiag         diagnostics, overshoot, number of counter and PM1_STS reads, may be NULL
+
+  @retval number of TSC per "Delay", overshoot subtracted if gfErrorCorrection
+
+**/
+int64_t AcpiTmrStsClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    uint32_t COUNTER_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    uint32_t MSB = (uint32_t)(1ULL << (gCOUNTER_WIDTH - 1));
+    uint32_t start, target, previous, current, diff, maxdiff = 0, cntReads = 0, cntEdges;
+    int64_t count;
+    uint64_t qwTSCStart, qwTSCEnd, qwTSCPerIntervall;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    //
+    // clear TMR_STS and start on a counter edge, retry if the MSB toggled in between
+    //
+    do {
+        _outpw(gPm1aEvtBlkAddr, ACPI_PM1_TMR_STS);
+
+        previous = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        while (previous == (start = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr)))
+            ;
+        qwTSCStart = ReadTSC();                         // get TSC start
+
+    } while (0 != (ACPI_PM1_TMR_STS & _inpw(gPm1aEvtBlkAddr)));
+
+    target = COUNTER_MASK & (start + Delay);
+
+    //
+    // MSB toggles before the fine phase, the remaining distance is then below 2^gCOUNTER_WIDTH
+    //
+    cntEdges = (uint32_t)(((uint64_t)(start & (MSB - 1)) + Delay - ACPI_TMRSTS_GUARD) / MSB);
+
+    if (0x200 & eflags)                                 // allow interrupts during the coarse phase
+        _enable();
+
+    while (cntEdges > 0)
+    {
+        AcpiPauseBurst();
+        cntReads++;
+        if (0 != (ACPI_PM1_TMR_STS & _inpw(gPm1aEvtBlkAddr)))
         {
-            qwTSCPerIntervall = ((qwTSCEnd - qwTSCStart) * Delay) / (Delay - count);
-        }
-        else {
-            qwTSCPerIntervall = qwTSCEnd - qwTSCStart;
+            _outpw(gPm1aEvtBlkAddr, ACPI_PM1_TMR_STS);
+            cntEdges--;
         }
+    }
 
-        if (0x200 & eflags)                                     // restore IF interrupt flag
-            _enable();
+    do {
+        AcpiPauseBurst();
+        cntReads++;
+        current = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        diff = COUNTER_MASK & (target - current);
+    } while (diff > ACPI_TMRSTS_GUARD && diff <= MSB + ACPI_TMRSTS_GUARD);
+
+    _disable();
+
+    //
+    // fine phase, "count" is negative if the target was passed during the coarse phase
+    //
+    previous = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+    count = (COUNTER_MASK & (target - previous)) <= MSB + ACPI_TMRSTS_GUARD ? (int64_t)(COUNTER_MASK & (target - previous)) : -(int64_t)(COUNTER_MASK & (previous - target));
+
+    while (count > 0)
+    {
+        current = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        diff = COUNTER_MASK & (current - previous);
+        previous = current;
+        count -= diff;
+        cntReads++;
+        maxdiff = diff > maxdiff ? diff : maxdiff;
+    }
+
+    qwTSCEnd = ReadTSC();                               // get TSC end
 
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    //
+    // subtract the additional number of TSC gone through, "count" is negative
+    //
+    if (1 == gfErrorCorrection)
+        qwTSCPerIntervall = ClkWaitErrorCorrect(qwTSCEnd - qwTSCStart, Delay, count);
+    else
+        qwTSCPerIntervall = qwTSCEnd - qwTSCStart;
+
+    if (NULL != pDiag)
+    {
+        pDiag->qwOvershoot = -count;                    // Additional ticks gone through
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads;
+        pDiag->dwMaxStep = maxdiff;                     // fine phase only
+        pDiag->cntGlitch = 0;
+        pDiag->cntSegments = 1;
+        pDiag->cntWrapLost = 0;
+        pDiag->qwTSCWindowMax = 0;
     }
+
     return (int64_t)qwTSCPerIntervall;
 }
 
-
 void PCIReset(void)
 {
     outp(0xCF9, 6);
@@ -124,16 +292,27 @@ void PCIReset(void)
   Stalls the CPU for at least the given number of ticks. It's invoked by
   MicroSecondDelay() and NanoSecondDelay().
 
+  If gfChunkedWait, each target is approached in CLKWAIT_CHUNK_US segments, pending
+  interrupts are let in between two of them. Each segment end is anchored in gClkWaitSegRec.
+  A window that lost a counter wrap has passed the current target, the target compare
+  can't tell, the target is taken as reached and the wrap is reported in cntWrapLost.
+
   @param  Delay     A period of time to delay in ticks.
+  @param  pDiag     diagnostics, overshoot, number of reads, may be NULL
 
 **/
-int64_t InternalAcpiDelay(uint32_t  Delay)
+int64_t InternalAcpiDelay(uint32_t  Delay, CLKWAIT_DIAG* pDiag)
 {
     uint32_t BIT22 = (1 << (gCOUNTER_WIDTH - 2));
     uint32_t BIT23 = (1 << (gCOUNTER_WIDTH - 1));
+    uint32_t COUNTER_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    uint32_t Chunk = gfChunkedWait ? (uint32_t)(TIMESTAMP_ACPI_HZ * CLKWAIT_CHUNK_US / 1000000) : 0;
     uint32_t    Ticks;
+    uint32_t    Segment;
     uint32_t    Times;
-    uint64_t qwTSCStart, qwTSCEnd;
+    uint32_t    Current = 0, cntReads = 0;
+    uint32_t dwAnchor = 0, cntSeg = 0, cntWrapLost = 0, wraps;
+    uint64_t qwTSCStart, qwTSCEnd, qwTSCAnchor, qwTSCWindow, qwTSCWindowMax = 0, qwTicks = 0;
     size_t eflags = __readeflags();                     // save flaags
 
     Times = Delay >> 22;
@@ -141,27 +320,71 @@ int64_t InternalAcpiDelay(uint32_t  Delay)
 
     _disable();
 
-    qwTSCStart = __rdtsc();                             // get TSC start
+    qwTSCStart = ReadTSC();                             // get TSC start
+
+    if (0 != Chunk)
+        dwAnchor = GetACPICount(gPmTmrBlkAddr);         // phase origin of the segment anchors
 
     do {
         //
         // The target timer count is calculated here
         //
-        Ticks = GetACPICount(gPmTmrBlkAddr) + Delay;
+        Ticks = (Current = GetACPICount(gPmTmrBlkAddr)) + Delay;
         Delay = BIT22;
         //
         // Wait until time out
         // Delay >= 2^23 could not be handled by this function
         // Timer wrap-arounds are handled correctly by this function
         //
-        while (((Ticks - GetACPICount(gPmTmrBlkAddr)) & BIT23) == 0)
-        {
-            ;
-        }
+        do {
+            Segment = 0 != Chunk && ((Ticks - Current - 2 * Chunk) & BIT23) == 0 ? Current + Chunk : Ticks;
+
+            while (((Segment - (Current = GetACPICount(gPmTmrBlkAddr))) & BIT23) == 0)
+            {
+                cntReads++;
+            }
+
+            if (Segment != Ticks)
+            {
+                //
+                // anchor the segment end, let interrupts in, check the window against the phase
+                //
+                qwTSCAnchor = ReadTSC();
+                qwTicks += COUNTER_MASK & (Current - dwAnchor);
+                dwAnchor = Current;
+                ClkWaitSegAnchor(cntSeg++, qwTSCAnchor - qwTSCStart, qwTicks);
+
+                ClkWaitChunkWindow(eflags);
+
+                Current = GetACPICount(gPmTmrBlkAddr);
+                qwTSCWindow = ReadTSC() - qwTSCAnchor;
+
+                wraps = ClkWaitLostWraps(qwTSCAnchor - qwTSCStart, qwTicks, qwTSCWindow, COUNTER_MASK & (Current - dwAnchor), (uint64_t)COUNTER_MASK + 1);
+                qwTicks += (uint64_t)wraps * ((uint64_t)COUNTER_MASK + 1);
+                cntWrapLost += wraps;
+                qwTSCWindowMax = qwTSCWindow > qwTSCWindowMax ? qwTSCWindow : qwTSCWindowMax;
+
+                if (0 != wraps)
+                    Segment = Ticks;                    // a whole counter range is beyond any target
+            }
+
+        } while (Segment != Ticks);
 
     } while (Times-- > 0);
 
-    qwTSCEnd = __rdtsc();                               // get TSC end ~50ms
+    qwTSCEnd = ReadTSC();                               // get TSC end ~50ms
+
+    if (NULL != pDiag)
+    {
+        pDiag->qwOvershoot = COUNTER_MASK & (Current - Ticks);  // Additional ticks gone through
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads + 1;
+        pDiag->dwMaxStep = 0;                                   // N/A, target count compare only
+        pDiag->cntGlitch = 0;
+        pDiag->cntSegments = cntSeg + 1;
+        pDiag->cntWrapLost = cntWrapLost;
+        pDiag->qwTSCWindowMax = qwTSCWindowMax;
+    }
 
     if (0x200 & eflags)                                 // restore IF interrupt flag
         _enable();
@@ -169,3 +392,79 @@ int64_t InternalAcpiDelay(uint32_t  Delay)
     return (int64_t)(qwTSCEnd - qwTSCStart);
 
 }
+
+/**
+  Capture a continuous TSC vs. ACPI timer phase record
+
+  The ACPI counter is polled continuously. Each time the accumulated number
+  of ticks crosses the next grid point (a multiple of dwTicksPerSample), the TSC
+  at that grid point is interpolated between the two enclosing reads.
+
+  @param  pRec          phase record, pRec->cnt == 0 starts a new record
+  @param  cntSamples    number of samples to add in this call
+
+  @retval number of samples in the record
+
+**/
+uint32_t AcpiPhaseCapture(PHASE_RECORD* pRec, uint32_t cntSamples)
+{
+    uint32_t COUNTER_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    uint32_t current, cntEnd = pRec->cnt + cntSamples;
+    uint64_t qwTSC, qwTicksPrev, qwGrid;
+    size_t eflags = __readeflags();                     // save flaags
+
+    if (cntEnd > pRec->cntMax)
+        cntEnd = pRec->cntMax;
+
+    _disable();
+
+    if (0 == pRec->cnt)
+    {
+        //
+        // start on an ACPI counter edge
+        //
+        pRec->dwCountPrev = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+
+        do {
+            current = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        } while (current == pRec->dwCountPrev);
+
+        pRec->qwTSCStart = pRec->qwTSCPrev = ReadTSC();
+        pRec->dwCountPrev = current;
+        pRec->qwTicks = 0;
+        pRec->rgqwTSC[pRec->cnt++] = 0;
+    }
+
+    qwGrid = (uint64_t)pRec->cnt * pRec->dwTicksPerSample;
+
+    while (pRec->cnt < cntEnd)
+    {
+        current = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        qwTSC = ReadTSC();
+
+        qwTicksPrev = pRec->qwTicks;
+        pRec->qwTicks += COUNTER_MASK & (current - pRec->dwCountPrev);
+
+        //
+        // interpolate TSC at each grid point gone through
+        //
+        while (pRec->qwTicks >= qwGrid && pRec->cnt < cntEnd)
+        {
+            uint64_t qwTSCGrid = pRec->qwTSCPrev;       // grid point left over from previous call
+
+            if (qwGrid > qwTicksPrev)
+                qwTSCGrid += ((qwTSC - pRec->qwTSCPrev) * (qwGrid - qwTicksPrev)) / (pRec->qwTicks - qwTicksPrev);
+
+            pRec->rgqwTSC[pRec->cnt++] = qwTSCGrid - pRec->qwTSCStart;
+            qwGrid += pRec->dwTicksPerSample;
+        }
+
+        pRec->dwCountPrev = current;
+        pRec->qwTSCPrev = qwTSC;
+    }
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return pRec->cnt;
+}
@@ -0,0 +1,307 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ApLoad.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    synthetic background load on APs during calibration
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <intrin.h>
+#include "ApLoad.h"
+
+const char* grgstrApLoadName[APLOAD_NUMTYPE] = { "MEM", "INT", "AVX", "IO" };
+
+static volatile uint64_t gqwApLoadSink;                 // keeps the compiler from dropping the work
+
+/**
+  Check AVX is usable on the calling AP: CPUID AVX and OSXSAVE, XMM and YMM state enabled in XCR0
+
+**/
+static int ApLoadAvxEnabled(void)
+{
+    int cpuInfo[4];
+
+    __cpuid(cpuInfo, 1);
+    if ((3 << 27) != (cpuInfo[2] & (3 << 27)))          // OSXSAVE, AVX
+        return 0;
+
+    return 6 == (_xgetbv(0) & 6);
+}
+
+static void ApLoadMem(APLOAD* pLoad, uint32_t n)
+{
+    size_t cqw = pLoad->cbMemPerAp / 2 / sizeof(uint64_t);
+    uint64_t* pSrc = (uint64_t*)(pLoad->pMem + (size_t)n * pLoad->cbMemPerAp);
+    uint64_t* pDst = pSrc + cqw;
+    uint64_t* pTmp;
+
+    while (0 == pLoad->fStop)
+    {
+        for (size_t i = 0; i < cqw; i++)
+            pDst[i] = pSrc[i] + 1;
+        pTmp = pSrc, pSrc = pDst, pDst = pTmp;          // copy back and forth
+        pLoad->rgqwRounds[n]++;
+    }
+}
+
+static void ApLoadInt(APLOAD* pLoad, uint32_t n)
+{
+    uint64_t x = 0x9E3779B97F4A7C15ULL + n, y = n | 1;
+
+    while (0 == pLoad->fStop)
+    {
+        for (int i = 0; i < APLOAD_INT_ROUNDS; i++)
+        {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            y = y * 0x5851F42D4C957F2DULL + x;
+        }
+        pLoad->rgqwRounds[n]++;
+    }
+
+    gqwApLoadSink = x + y;
+}
+
+static void ApLoadAvx(APLOAD* pLoad, uint32_t n)
+{
+    float rgf[8];
+    double rgdbl[2];
+
+    if (ApLoadAvxEnabled())
+    {
+        __m256 a = _mm256_set1_ps(0.999f), b = _mm256_set1_ps(0.001f);
+        __m256 x0 = _mm256_set1_ps(1.0f), x1 = x0, x2 = x0, x3 = x0;   // independent chains fill the pipeline
+
+        _InterlockedIncrement(&pLoad->cntAvx);
+
+        while (0 == pLoad->fStop)
+        {
+            for (int i = 0; i < APLOAD_FP_ROUNDS; i++)
+            {
+                x0 = _mm256_add_ps(_mm256_mul_ps(x0, a), b);
+                x1 = _mm256_add_ps(_mm256_mul_ps(x1, a), b);
+                x2 = _mm256_add_ps(_mm256_mul_ps(x2, a), b);
+                x3 = _mm256_add_ps(_mm256_mul_ps(x3, a), b);
+            }
+            pLoad->rgqwRounds[n]++;
+        }
+
+        _mm256_storeu_ps(rgf, _mm256_add_ps(_mm256_add_ps(x0, x1), _mm256_add_ps(x2, x3)));
+        _mm256_zeroupper();
+        gqwApLoadSink = (uint64_t)rgf[0];
+    }
+    else
+    {
+        __m128d a = _mm_set1_pd(0.999), b = _mm_set1_pd(0.001);
+        __m128d x0 = _mm_set1_pd(1.0), x1 = x0, x2 = x0, x3 = x0;
+
+        _InterlockedIncrement(&pLoad->cntSse);
+
+        while (0 == pLoad->fStop)
+        {
+            for (int i = 0; i < APLOAD_FP_ROUNDS; i++)
+            {
+                x0 = _mm_add_pd(_mm_mul_pd(x0, a), b);
+                x1 = _mm_add_pd(_mm_mul_pd(x1, a), b);
+                x2 = _mm_add_pd(_mm_mul_pd(x2, a), b);
+                x3 = _mm_add_pd(_mm_mul_pd(x3, a), b);
+            }
+            pLoad->rgqwRounds[n]++;
+        }
+
+        _mm_storeu_pd(rgdbl, _mm_add_pd(_mm_add_pd(x0, x1), _mm_add_pd(x2, x3)));
+        gqwApLoadSink = (uint64_t)rgdbl[0];
+    }
+}
+
+static void ApLoadIo(APLOAD* pLoad, uint32_t n)
+{
+    uint32_t dw = 0;
+
+    while (0 == pLoad->fStop)
+    {
+        for (int i = 0; i < APLOAD_IO_ROUNDS; i++)
+            dw += pLoad->pfnReadIo();
+        pLoad->rgqwRounds[n]++;
+    }
+
+    gqwApLoadSink = dw;
+}
+
+/**
+  AP procedure, run the load type of the ticket until ApLoadStop()
+
+  Runs on APs, no console output, no boot services.
+
+**/
+static void ApLoadProc(void* pArg)
+{
+    APLOAD* pLoad = (APLOAD*)pArg;
+    uint32_t n = (uint32_t)_InterlockedIncrement(&pLoad->nTicket) - 1;
+    uint32_t rgdwType[APLOAD_NUMTYPE], cntType = 0;
+
+    if (n >= pLoad->nActive)
+        return;
+
+    for (int i = 0; i < APLOAD_NUMTYPE; i++)
+        if ((1U << i) & pLoad->dwTypesActive)
+            rgdwType[cntType++] = 1U << i;
+
+    switch (rgdwType[n % cntType])
+    {
+    case APLOAD_MEM:    ApLoadMem(pLoad, n); break;
+    case APLOAD_INT:    ApLoadInt(pLoad, n); break;
+    case APLOAD_AVX:    ApLoadAvx(pLoad, n); break;
+    case APLOAD_IO:     ApLoadIo(pLoad, n); break;
+    }
+}
+
+/**
+  Parse load types MEM, INT, AVX, IO joined by '+', or ALL
+
+  @retval 0 on success, -1 on unknown or missing type
+
+**/
+int ApLoadParse(const char* pstr, uint32_t* pdwTypes)
+{
+    uint32_t dwTypes = 0;
+
+    while ('\0' != *pstr)
+    {
+        size_t len = strcspn(pstr, "+");
+        int i;
+
+        if (strlen("ALL") == len && 0 == _strnicmp(pstr, "ALL", len))
+            dwTypes |= APLOAD_ALL;
+        else
+        {
+            for (i = 0; i < APLOAD_NUMTYPE; i++)
+                if (strlen(grgstrApLoadName[i]) == len && 0 == _strnicmp(pstr, grgstrApLoadName[i], len))
+                    break;
+
+            if (APLOAD_NUMTYPE == i)
+                return -1;
+
+            dwTypes |= 1U << i;
+        }
+
+        pstr += len;
+        if ('+' == *pstr)
+            pstr++;
+    }
+
+    if (0 == dwTypes)
+        return -1;
+
+    *pdwTypes = dwTypes;
+
+    return 0;
+}
+
+/**
+  Start the load on pLoad->nAPs APs, all if 0, and return while the APs keep running
+
+  @param  pLoad         dwTypes and nAPs set, /APLOAD
+  @param  pPlat         AP startup backend
+
+  @retval number of APs loaded, 0 if no load selected, no AP available, out of memory or the startup failed
+
+**/
+int ApLoadStart(APLOAD* pLoad, const APLOAD_PLATFORM* pPlat)
+{
+    uint32_t nActive = 0 == pLoad->nAPs || pLoad->nAPs > pPlat->nAPs ? pPlat->nAPs : pLoad->nAPs;
+
+    pLoad->nActive = 0;
+    pLoad->dwTypesActive = pLoad->dwTypes & (NULL == pPlat->pfnReadIo ? ~APLOAD_IO : ~0U);
+    pLoad->nTicket = pLoad->fStop = pLoad->cntAvx = pLoad->cntSse = 0;
+    memset(pLoad->rgqwRounds, 0, sizeof(pLoad->rgqwRounds));
+
+    nActive = nActive < APLOAD_MAXCPU ? nActive : APLOAD_MAXCPU;
+    if (0 == pLoad->dwTypesActive || 0 == nActive)
+        return 0;
+
+    if (APLOAD_MEM & pLoad->dwTypesActive)
+    {
+        pLoad->cbMemPerAp = APLOAD_MEM_MAX / nActive < APLOAD_MEM_PER_AP ? (APLOAD_MEM_MAX / nActive) & ~(size_t)0xFFF : APLOAD_MEM_PER_AP;
+        pLoad->pMem = (uint8_t*)malloc((size_t)nActive * pLoad->cbMemPerAp);
+        if (NULL == pLoad->pMem)
+            return 0;
+        memset(pLoad->pMem, 0, (size_t)nActive * pLoad->cbMemPerAp);
+    }
+
+    pLoad->pfnReadIo = pPlat->pfnReadIo;
+    pLoad->nActive = nActive;
+
+    if (0 != pPlat->pfnStartAPs(ApLoadProc, pLoad))
+    {
+        free(pLoad->pMem);
+        pLoad->pMem = NULL;
+        return pLoad->nActive = 0;
+    }
+
+    return nActive;
+}
+
+/**
+  Stop the load and wait for the APs, nActive is kept for ApLoadDescribe()
+
+**/
+void ApLoadStop(APLOAD* pLoad, const APLOAD_PLATFORM* pPlat)
+{
+    if (0 == pLoad->nActive)
+        return;
+
+    pLoad->fStop = 1;
+    pPlat->pfnWaitAPs();
+
+    free(pLoad->pMem);
+    pLoad->pMem = NULL;
+}
+
+/**
+  Describe the load of the last run, e.g. "MEM+AVX on 7 APs, AVX 256 bit 3, SSE2 0"
+
+  A load that failed to start is described as "none, MEM+INT failed to start", an IO
+  load without port to read is appended as ", IO N/A".
+
+**/
+char* ApLoadDescribe(APLOAD* pLoad, char* pstrBuf, size_t cbBuf)
+{
+    char strTypes[32] = { "" };
+    uint32_t dwTypes = pLoad->dwTypesActive;
+    size_t cb;
+
+    for (int i = 0; i < APLOAD_NUMTYPE; i++)
+        if ((1U << i) & dwTypes)
+            strcat(strcat(strTypes, '\0' == strTypes[0] ? "" : "+"), grgstrApLoadName[i]);
+
+    if (0 == pLoad->nActive)
+        snprintf(pstrBuf, cbBuf, 0 == dwTypes ? "none" : "none, %s failed to start", strTypes);
+    else if (APLOAD_AVX & dwTypes)
+        snprintf(pstrBuf, cbBuf, "%s on %u APs, AVX 256 bit %ld, SSE2 %ld", strTypes, pLoad->nActive, pLoad->cntAvx, pLoad->cntSse);
+    else
+        snprintf(pstrBuf, cbBuf, "%s on %u APs", strTypes, pLoad->nActive);
+
+    cb = strlen(pstrBuf);
+    if (APLOAD_IO & pLoad->dwTypes & ~pLoad->dwTypesActive)
+        snprintf(pstrBuf + cb, cbBuf - cb, ", IO N/A");
+
+    return pstrBuf;
+}
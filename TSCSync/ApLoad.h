@@ -0,0 +1,95 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ApLoad.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    synthetic background load on APs during calibration
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _APLOAD_H_
+#define _APLOAD_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// NOTE:    The APs are started without waiting, the BSP calibrates meanwhile and stops
+//          the load by a shared flag afterwards. Each AP draws a ticket on entry, the
+//          selected load types are assigned round-robin to the tickets, APs beyond the
+//          requested number return immediately. AVX is used only if enabled on that AP,
+//          CPUID OSXSAVE and XCR0, SSE2 otherwise, the firmware may leave it disabled.
+//          IO is dropped, if the platform has no port to read, e.g. no ACPI PM timer.
+//          The MEM buffer is limited to APLOAD_MEM_MAX, the share of each AP shrinks on
+//          platforms with many APs.
+//
+#define APLOAD_MEM          (1 << 0)                    // memory bandwidth, streaming copy
+#define APLOAD_INT          (1 << 1)                    // integer multiply/xorshift chains
+#define APLOAD_AVX          (1 << 2)                    // 256 bit floating point, SSE2 if AVX not enabled
+#define APLOAD_IO           (1 << 3)                    // port I/O, ACPI PM timer reads
+#define APLOAD_NUMTYPE      4
+#define APLOAD_ALL          ((1 << APLOAD_NUMTYPE) - 1)
+
+#define APLOAD_MAXCPU       256
+#define APLOAD_MEM_PER_AP   (8 * 1024 * 1024)           // source and destination, beyond most L2
+#define APLOAD_MEM_MAX      (256 * 1024 * 1024)         // all APs
+#define APLOAD_INT_ROUNDS   (1024 * 1024)               // iterations between two stop checks
+#define APLOAD_FP_ROUNDS    (256 * 1024)
+#define APLOAD_IO_ROUNDS    1024
+
+typedef void (*APLOAD_PROC)(void* pArg);
+
+typedef struct _APLOAD_PLATFORM {
+    uint32_t nAPs;                                      // enabled APs, BSP excluded
+    int (*pfnStartAPs)(APLOAD_PROC pfnProc, void* pArg);    // start on all APs, don't wait, 0 on success
+    void (*pfnWaitAPs)(void);                           // wait until all APs returned
+    uint32_t (*pfnReadIo)(void);                        // port read of APLOAD_IO, NULL if N/A
+}APLOAD_PLATFORM;
+
+typedef struct _APLOAD {
+    uint32_t dwTypes;                                   // APLOAD_..., /APLOAD
+    uint32_t nAPs;                                      // APs to load, 0 all
+    //
+    // run state, shared with the APs
+    //
+    volatile long nTicket;
+    volatile long fStop;
+    volatile long cntAvx;                               // APs running 256 bit AVX
+    volatile long cntSse;                               // APs running the SSE2 fallback
+    uint32_t nActive;                                   // APs loaded, 0 if not running
+    uint32_t dwTypesActive;                             // dwTypes available on the platform
+    uint8_t* pMem;                                      // cbMemPerAp per AP
+    size_t cbMemPerAp;                                  // APLOAD_MEM_PER_AP, less on many APs
+    uint32_t (*pfnReadIo)(void);
+    uint64_t rgqwRounds[APLOAD_MAXCPU];                 // work done per AP
+}APLOAD;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const char* grgstrApLoadName[APLOAD_NUMTYPE];
+
+int ApLoadParse(const char* pstr, uint32_t* pdwTypes);
+int ApLoadStart(APLOAD* pLoad, const APLOAD_PLATFORM* pPlat);
+void ApLoadStop(APLOAD* pLoad, const APLOAD_PLATFORM* pPlat);
+char* ApLoadDescribe(APLOAD* pLoad, char* pstrBuf, size_t cbBuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_APLOAD_H_
@@ -0,0 +1,270 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ApicTimer.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    local APIC timer access, xAPIC MMIO and x2APIC MSR, characterization against ACPI and RTC
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <conio.h>
+#include <intrin.h>
+#include "ApicTimer.h"
+#include "ClkWait.h"
+#include "TscPolicy.h"
+
+extern uint32_t gCOUNTER_WIDTH;
+
+int gnApicAccess = APIC_ACCESS_NONE;
+volatile uint32_t* gpApicMmio;
+uint64_t gqwApicTimerFreq;
+APIC_TIMER_RESULT gApicTimerResult;
+
+static volatile uint32_t gdwApicSink;                   // keeps the compiler from removing the reads
+static uint64_t gqwApicModulus;                         // counter range, 0 if the timer doesn't count periodically
+
+static struct {
+    int fSaved;
+    uint32_t dwLvt;
+    uint32_t dwInitial;
+    uint32_t dwDivide;
+}gApicSave;
+
+static uint32_t ApicRd(uint32_t reg)
+{
+    if (APIC_ACCESS_X2APIC == gnApicAccess)
+        return (uint32_t)__readmsr(0x800 + (reg >> 4));
+    return gpApicMmio[reg >> 2];
+}
+
+static void ApicWr(uint32_t reg, uint32_t val)
+{
+    if (APIC_ACCESS_X2APIC == gnApicAccess)
+        __writemsr(0x800 + (reg >> 4), val);
+    else
+        gpApicMmio[reg >> 2] = val;
+}
+
+//
+// ticks between two reads of the periodic down counter
+//
+static __inline uint64_t ApicDiff(uint32_t previous, uint32_t current)
+{
+    return previous >= current ? previous - current : previous + gqwApicModulus - current;
+}
+
+/**
+  Detect the local APIC access mode and take the timer, if no one else uses it
+
+  @retval APIC_ACCESS_NONE, APIC_ACCESS_XAPIC or APIC_ACCESS_X2APIC
+
+**/
+int ApicTimerInit(void)
+{
+    int cpuInfo[4] = { 0,0,0,0 };
+    uint64_t qwApicBase;
+
+    memset(&gApicTimerResult, 0, sizeof(APIC_TIMER_RESULT));
+
+    __cpuid(cpuInfo, 1);
+
+    if (0 == (cpuInfo[3] & (1 << 9)))                   // CPUID.1:EDX.APIC
+        return gnApicAccess = APIC_ACCESS_NONE;
+
+    qwApicBase = __readmsr(MSR_IA32_APIC_BASE);
+
+    if (0 == (qwApicBase & APIC_BASE_ENABLE))
+        return gnApicAccess = APIC_ACCESS_NONE;
+
+    if (0 != (qwApicBase & APIC_BASE_X2APIC))
+        gnApicAccess = APIC_ACCESS_X2APIC;
+    else
+        gnApicAccess = APIC_ACCESS_XAPIC,
+        gpApicMmio = (volatile uint32_t*)(uintptr_t)(qwApicBase & APIC_BASE_MASK);
+
+    gApicSave.dwLvt = ApicRd(APIC_LVT_TIMER);
+    gApicSave.dwInitial = ApicRd(APIC_TMR_INITIAL);
+    gApicSave.dwDivide = ApicRd(APIC_TMR_DIVIDE);
+
+    if (0 != (gApicSave.dwLvt & APIC_LVT_MASKED))
+    {
+        //
+        // free running 32 bit down counter
+        //
+        ApicWr(APIC_TMR_DIVIDE, APIC_DIVIDE_BY_1);
+        ApicWr(APIC_LVT_TIMER, APIC_LVT_MASKED | APIC_LVT_PERIODIC | (gApicSave.dwLvt & 0xFF));
+        ApicWr(APIC_TMR_INITIAL, 0xFFFFFFFF);
+
+        gApicSave.fSaved = 1;
+        gqwApicModulus = 1ULL << 32;
+    }
+    else if (0 != (gApicSave.dwLvt & APIC_LVT_PERIODIC) && 0 != gApicSave.dwInitial)
+        gqwApicModulus = (uint64_t)gApicSave.dwInitial + 1;     // firmware owned, read-only
+
+    gApicTimerResult.nAccess = gnApicAccess;
+    gApicTimerResult.fOwned = gApicSave.fSaved;
+    gApicTimerResult.qwModulus = gqwApicModulus;
+
+    return gnApicAccess;
+}
+
+/**
+  Restore the original timer setting, if taken by ApicTimerInit()
+
+**/
+void ApicTimerRestore(void)
+{
+    if (0 == gApicSave.fSaved)
+        return;
+
+    ApicWr(APIC_TMR_INITIAL, 0);                        // stop
+    ApicWr(APIC_TMR_DIVIDE, gApicSave.dwDivide);
+    ApicWr(APIC_LVT_TIMER, gApicSave.dwLvt);
+    ApicWr(APIC_TMR_INITIAL, gApicSave.dwInitial);
+
+    gApicSave.fSaved = 0;
+}
+
+/**
+  Read the timer current count
+
+**/
+uint32_t ApicTimerRead(void)
+{
+    return ApicRd(APIC_TMR_CURRENT);
+}
+
+/**
+  Get the cost of a single APIC timer current count read
+
+  The minimum of APIC_COST_ROUNDS rounds of APIC_COST_READS back-to-back reads is taken,
+  interrupts are disabled during each round.
+
+  @retval TSC per read
+
+**/
+uint64_t ApicTimerReadCost(void)
+{
+    uint64_t qwMin = (uint64_t)~0, qwTSC;
+    size_t eflags = __readeflags();                     // save flaags
+
+    for (int r = 0; r < APIC_COST_ROUNDS; r++)
+    {
+        _disable();
+
+        qwTSC = ReadTSC();
+        for (int i = 0; i < APIC_COST_READS; i++)
+            gdwApicSink = ApicRd(APIC_TMR_CURRENT);
+        qwTSC = ReadTSC() - qwTSC;
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        qwMin = qwTSC < qwMin ? qwTSC : qwMin;
+    }
+
+    return qwMin / APIC_COST_READS;
+}
+
+/**
+  Measure APIC timer and TSC frequency against RTC and ACPI timer within the same interval
+
+  The APIC timer, the ACPI timer and RTC UIP are polled together, the counter ticks are
+  accumulated between the first and the last of "seconds" + 1 falling edges of UIP.
+  Interrupts are disabled for max. one second at once.
+
+  @param  pResult       result
+  @param  seconds       number of RTC seconds to measure
+
+  @retval 0 on success, -1 no local APIC or timer doesn't count periodically
+
+**/
+int ApicTimerCharacterize(APIC_TIMER_RESULT* pResult, int seconds)
+{
+    uint32_t ACPI_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    int fAcpi = 0 != gPmTmrBlkAddr || 0 != gfPmTmrMmio;
+    uint64_t qwApicTicks = 0, qwAcpiTicks = 0, qwApicStart = 0, qwAcpiStart = 0, qwTSCStart = 0, qwTSC = 0;
+    uint32_t dwApicPrev, dwApic, dwAcpiPrev = 0, dwAcpi;
+    int uip, uipPrev, cntEdges = 0;
+    size_t eflags = __readeflags();                     // save flaags
+
+    if (APIC_ACCESS_NONE == gnApicAccess)
+        return -1;
+
+    pResult->qwReadCost = ApicTimerReadCost();
+
+    if (0 == gqwApicModulus)
+        return -1;
+
+    _disable();
+    _outp(0x70, 0x0A);                                  // RTC Register A
+
+    uipPrev = 0x80 & _inp(0x71);
+    dwApicPrev = ApicTimerRead();
+    if (fAcpi)
+        dwAcpiPrev = GetACPICount(gPmTmrBlkAddr);
+
+    while (cntEdges <= seconds)
+    {
+        uip = 0x80 & _inp(0x71);
+
+        dwApic = ApicTimerRead();
+        qwApicTicks += ApicDiff(dwApicPrev, dwApic);
+        dwApicPrev = dwApic;
+
+        if (fAcpi)
+        {
+            dwAcpi = GetACPICount(gPmTmrBlkAddr);
+            qwAcpiTicks += ACPI_MASK & (dwAcpi - dwAcpiPrev);
+            dwAcpiPrev = dwAcpi;
+        }
+
+        if (0 != uipPrev && 0 == uip)                   // falling edge of UIP
+        {
+            qwTSC = ReadTSC();
+
+            if (0 == cntEdges++)
+                qwTSCStart = qwTSC, qwApicStart = qwApicTicks, qwAcpiStart = qwAcpiTicks;
+
+            if (0x200 & eflags)                         // allow pending interrupts once per second
+                _enable();
+            _disable();
+            _outp(0x70, 0x0A);                          // RTC Register A
+        }
+        uipPrev = uip;
+    }
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    qwApicTicks -= qwApicStart;
+    qwAcpiTicks -= qwAcpiStart;
+    qwTSC -= qwTSCStart;
+
+    pResult->dblSeconds = seconds;
+    pResult->dblHzRTC = (double)qwApicTicks / seconds;
+    pResult->dblTSCHzRTC = (double)qwTSC / seconds;
+
+    if (0 != qwAcpiTicks)
+        pResult->dblHzACPI = (double)qwApicTicks * TIMESTAMP_ACPI_HZ / qwAcpiTicks,
+        pResult->dblTSCHzACPI = (double)qwTSC * TIMESTAMP_ACPI_HZ / qwAcpiTicks;
+
+    return 0;
+}
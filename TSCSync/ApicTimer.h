@@ -0,0 +1,88 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ApicTimer.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    local APIC timer access, xAPIC MMIO and x2APIC MSR, characterization against ACPI and RTC
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _APICTIMER_H_
+#define _APICTIMER_H_
+
+#include <stdint.h>
+
+#define APIC_ACCESS_NONE        0                       // no local APIC
+#define APIC_ACCESS_XAPIC       1                       // MMIO at IA32_APIC_BASE
+#define APIC_ACCESS_X2APIC      2                       // MSR 0x800 + (offset >> 4)
+
+#define MSR_IA32_APIC_BASE      0x1B
+#define APIC_BASE_X2APIC        (1ULL << 10)            // x2APIC mode enabled
+#define APIC_BASE_ENABLE        (1ULL << 11)            // APIC global enable
+#define APIC_BASE_MASK          0xFFFFFF000ULL
+
+#define APIC_LVT_TIMER          0x320
+#define APIC_TMR_INITIAL        0x380
+#define APIC_TMR_CURRENT        0x390
+#define APIC_TMR_DIVIDE         0x3E0
+
+#define APIC_LVT_MASKED         (1 << 16)
+#define APIC_LVT_PERIODIC       (1 << 17)
+#define APIC_DIVIDE_BY_1        0xB
+
+#define APIC_COST_READS         64                      // back-to-back reads per round
+#define APIC_COST_ROUNDS        16
+#define APIC_DFLT_SECONDS       2                       // characterization time at startup
+
+//
+// NOTE:    The timer is programmed to a free running 32 bit down counter, periodic, divide by 1,
+//          initial count 0xFFFFFFFF, only if its LVT is masked, no one else gets interrupts from it.
+//          The original setting is restored by ApicTimerRestore().
+//          A firmware owned, unmasked timer is characterized read-only, it can't be used as
+//          calibration reference.
+//
+typedef struct _APIC_TIMER_RESULT {
+    int nAccess;                                        // APIC_ACCESS_...
+    int fOwned;                                         // timer programmed by TSCSync, usable as calibration reference
+    uint64_t qwModulus;                                 // counter range, initial count + 1, 0 if not periodic
+    double dblSeconds;                                  // measurement time in RTC seconds
+    double dblHzRTC;                                    // APIC timer frequency vs. RTC
+    double dblHzACPI;                                   // APIC timer frequency vs. ACPI timer
+    double dblTSCHzRTC;                                 // TSC frequency vs. RTC, same interval
+    double dblTSCHzACPI;                                // TSC frequency vs. ACPI timer, same interval
+    uint64_t qwReadCost;                                // TSC per APIC timer read
+}APIC_TIMER_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int gnApicAccess;                                // APIC_ACCESS_...
+extern volatile uint32_t* gpApicMmio;                   // xAPIC register base
+extern uint64_t gqwApicTimerFreq;                       // APIC timer ticks per second, 0 if not calibrated
+extern APIC_TIMER_RESULT gApicTimerResult;
+
+int ApicTimerInit(void);
+void ApicTimerRestore(void);
+uint32_t ApicTimerRead(void);
+uint64_t ApicTimerReadCost(void);
+int ApicTimerCharacterize(APIC_TIMER_RESULT* pResult, int seconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_APICTIMER_H_
@@ -0,0 +1,295 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Bench.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    micro benchmark of the timer read primitives
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <conio.h>
+#include <intrin.h>
+#include "Bench.h"
+#include "ApicTimer.h"
+#include "RtcSnapshot.h"
+#include "ClkWait.h"
+
+#define MSR_IA32_TIME_STAMP_COUNTER 0x10
+
+extern int rtcrd(int idx);
+
+static const char* grgstrBenchName[BENCH_NUMPRIM] = {
+    "RDTSC",
+    "RDTSCP",
+    "LFENCE+RDTSC",
+    "MFENCE+LFENCE+RDTSC",
+    "RDMSR TSC",
+    "ACPI PM timer _inpd",
+    "ACPI PM timer MMIO",
+    "PIT latch + 2 reads",
+    "RTC rtcrd()",
+    "local APIC timer",
+    "RTC rtcrd() hh:mm:ss",
+    "RTC snapshot",
+    "ACPI wait legacy/read",
+    "ACPI wait kernel/read",
+};
+
+static volatile uint64_t gqwBenchSink;                  // keeps the compiler from removing the primitive
+
+//
+// NOTE:    One sample is the TSC distance across the primitive, serialized by LFENCE
+//          on both sides. The median of the empty measurement is subtracted later.
+//          Interrupts are disabled for BENCH_CHUNK samples at once, except for the
+//          RTC snapshot that handles the interrupt flag itself.
+//
+#define BENCH_MEASURE(rgqw, OP) do {                                \
+    for (int c = 0; c < BENCH_SAMPLES; c += BENCH_CHUNK)            \
+    {                                                               \
+        size_t eflags = __readeflags();                             \
+        _disable();                                                 \
+        for (int i = c; i < c + BENCH_CHUNK; i++)                   \
+        {                                                           \
+            uint64_t qwTSCStart, qwTSCEnd;                          \
+            _mm_lfence();                                           \
+            qwTSCStart = __rdtsc();                                 \
+            _mm_lfence();                                           \
+            OP;                                                     \
+            _mm_lfence();                                           \
+            qwTSCEnd = __rdtsc();                                   \
+            rgqw[i] = qwTSCEnd - qwTSCStart;                        \
+        }                                                           \
+        if (0x200 & eflags)                                         \
+            _enable();                                              \
+    }                                                               \
+}while (0)
+
+static int BenchCompare(const void* p1, const void* p2)
+{
+    uint64_t q1 = *(const uint64_t*)p1, q2 = *(const uint64_t*)p2;
+
+    return q1 < q2 ? -1 : (q1 > q2 ? 1 : 0);
+}
+
+static uint32_t BenchReadPIT(void)
+{
+    uint32_t lo, hi;
+
+    _outp(0x43, (2/*TIMER*/ << 6) + 0x0);              // counter latch timer 2
+    lo = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get low byte
+    hi = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get high byte
+
+    return (hi << 8) | lo;
+}
+
+/**
+  Sample the TSC per loop iteration of an ACPI wait loop, the read and the loop
+  overhead together, over BENCH_WAIT_TICKS each. The wait disables interrupts itself.
+
+  @param  rgqw          samples
+  @param  pfnWait       AcpiClkWaitLegacy() or AcpiClkWait()
+
+**/
+static void BenchMeasureWait(uint64_t* rgqw, int64_t (*pfnWait)(uint32_t Delay, CLKWAIT_DIAG* pDiag))
+{
+    CLKWAIT_DIAG Diag;
+
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+        pfnWait(BENCH_WAIT_TICKS, &Diag);
+        rgqw[i] = 0 == Diag.cntReads ? 0 : Diag.qwTSCRaw / Diag.cntReads;
+    }
+}
+
+/**
+  Sample RtcSnapshotRead() with interrupts left as they are. The snapshot polls UIP
+  and disables interrupts itself, so it can't run inside a BENCH_MEASURE chunk.
+
+  @param  rgqw          samples
+
+**/
+static void BenchMeasureRtcSnap(uint64_t* rgqw)
+{
+    RTC_SNAPSHOT Snap;
+
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+    {
+        uint64_t qwTSCStart, qwTSCEnd;
+
+        _mm_lfence();
+        qwTSCStart = __rdtsc();
+        _mm_lfence();
+        gqwBenchSink = RtcSnapshotRead(&Snap) + Snap.bSec;
+        _mm_lfence();
+        qwTSCEnd = __rdtsc();
+        rgqw[i] = qwTSCEnd - qwTSCStart;
+    }
+}
+
+/**
+  Sort the samples, subtract measurement overhead and get the distribution
+
+  @param  pStat         statistics
+  @param  rgqw          samples
+  @param  qwOverhead    measurement overhead in TSC cycles
+
+**/
+static void BenchStat(BENCH_STAT* pStat, uint64_t* rgqw, uint64_t qwOverhead)
+{
+    double dblSum = 0.0;
+
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+        rgqw[i] = rgqw[i] > qwOverhead ? rgqw[i] - qwOverhead : 0;
+
+    qsort(rgqw, BENCH_SAMPLES, sizeof(uint64_t), BenchCompare);
+
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+        dblSum += (double)rgqw[i];
+
+    pStat->cntSamples = BENCH_SAMPLES;
+    pStat->qwMin = rgqw[0];
+    pStat->qwP50 = rgqw[BENCH_SAMPLES / 2];
+    pStat->qwP99 = rgqw[(BENCH_SAMPLES * 99) / 100];
+    pStat->qwMax = rgqw[BENCH_SAMPLES - 1];
+    pStat->dblAvg = dblSum / BENCH_SAMPLES;
+}
+
+/**
+  Measure the latency distribution of each timer read primitive
+
+  @param  pResult       result
+  @param  dblTSCPerSec  TSC frequency for cycles to ns conversion
+
+  @retval 0 on success, -1 out of memory
+
+**/
+int BenchRun(BENCH_RESULT* pResult, double dblTSCPerSec)
+{
+    uint64_t* rgqw = (uint64_t*)malloc(BENCH_SAMPLES * sizeof(uint64_t));
+    unsigned aux;
+    int fVerifiedRead;
+
+    if (NULL == rgqw)
+        return -1;
+
+    memset(pResult, 0, sizeof(BENCH_RESULT));
+    pResult->dblTSCPerSec = dblTSCPerSec;
+
+    //
+    // measurement overhead, empty primitive
+    //
+    BENCH_MEASURE(rgqw, (void)0);
+    qsort(rgqw, BENCH_SAMPLES, sizeof(uint64_t), BenchCompare);
+    pResult->qwOverhead = rgqw[BENCH_SAMPLES / 2];
+
+    for (int n = 0; n < BENCH_NUMPRIM; n++)
+    {
+        switch (n)
+        {
+        case BENCH_RDTSC:           BENCH_MEASURE(rgqw, gqwBenchSink = __rdtsc()); break;
+        case BENCH_RDTSCP:          BENCH_MEASURE(rgqw, gqwBenchSink = __rdtscp(&aux)); break;
+        case BENCH_LFENCE_RDTSC:    BENCH_MEASURE(rgqw, (_mm_lfence(), gqwBenchSink = __rdtsc())); break;
+        case BENCH_MFENCE_RDTSC:    BENCH_MEASURE(rgqw, (_mm_mfence(), _mm_lfence(), gqwBenchSink = __rdtsc())); break;
+        case BENCH_RDMSR:           BENCH_MEASURE(rgqw, gqwBenchSink = __readmsr(MSR_IA32_TIME_STAMP_COUNTER)); break;
+        case BENCH_ACPI:            if (0 == gPmTmrBlkAddr)
+                                        continue;       // no PM_TMR_BLK in SystemIO
+                                    BENCH_MEASURE(rgqw, gqwBenchSink = _inpd(gPmTmrBlkAddr)); break;
+        case BENCH_ACPI_MMIO:       if (NULL == gpPmTmrMmio)
+                                        continue;       // no X_PM_TMR_BLK in SystemMemory
+                                    BENCH_MEASURE(rgqw, gqwBenchSink = *gpPmTmrMmio); break;
+        case BENCH_PIT:             BENCH_MEASURE(rgqw, gqwBenchSink = BenchReadPIT()); break;
+        case BENCH_RTC:             BENCH_MEASURE(rgqw, gqwBenchSink = rtcrd(0)); break;
+        case BENCH_APIC:            if (APIC_ACCESS_NONE == gnApicAccess)
+                                        continue;       // no local APIC
+                                    BENCH_MEASURE(rgqw, gqwBenchSink = ApicTimerRead()); break;
+        case BENCH_RTC_HMS:         BENCH_MEASURE(rgqw, gqwBenchSink = rtcrd(0) + rtcrd(2) + rtcrd(4)); break;
+        case BENCH_RTC_SNAP:        BenchMeasureRtcSnap(rgqw); break;
+        case BENCH_WAIT_LEGACY:     if (0 == gPmTmrBlkAddr && 0 == gfPmTmrMmio)
+                                        continue;       // no ACPI PM timer
+                                    BenchMeasureWait(rgqw, AcpiClkWaitLegacy); break;
+        case BENCH_WAIT_KERNEL:     if (0 == gPmTmrBlkAddr && 0 == gfPmTmrMmio)
+                                        continue;
+                                    fVerifiedRead = gfVerifiedRead, gfVerifiedRead = 0;     // same single read as the legacy loop
+                                    BenchMeasureWait(rgqw, AcpiClkWait);
+                                    gfVerifiedRead = fVerifiedRead; break;
+        }
+
+        pResult->rgStat[pResult->cntStat].pstrName = grgstrBenchName[n];
+        BenchStat(&pResult->rgStat[pResult->cntStat], rgqw, BENCH_WAIT_LEGACY > n ? pResult->qwOverhead : 0);
+        pResult->cntStat++;
+    }
+
+    free(rgqw);
+
+    return 0;
+}
+
+/**
+  Print the result as table
+
+  @param  fp            output stream
+  @param  pResult       result
+
+**/
+void BenchPrintTable(FILE* fp, BENCH_RESULT* pResult)
+{
+    double dblNsPerCycle = 1e9 / pResult->dblTSCPerSec;
+
+    fprintf(fp, "%-22s %8s %8s %8s %10s %10s %10s\n", "primitive", "p50", "p99", "max", "p50", "p99", "max");
+    fprintf(fp, "%-22s %8s %8s %8s %10s %10s %10s\n", "", "[cyc]", "[cyc]", "[cyc]", "[ns]", "[ns]", "[ns]");
+
+    for (int n = 0; n < pResult->cntStat; n++)
+    {
+        BENCH_STAT* p = &pResult->rgStat[n];
+
+        fprintf(fp, "%-22s %8lld %8lld %8lld %10.1f %10.1f %10.1f\n",
+            p->pstrName,
+            p->qwP50, p->qwP99, p->qwMax,
+            p->qwP50 * dblNsPerCycle, p->qwP99 * dblNsPerCycle, p->qwMax * dblNsPerCycle);
+    }
+    fprintf(fp, "%d samples each, measurement overhead %lld cycles subtracted, TSC %.0fHz\n", BENCH_SAMPLES, pResult->qwOverhead, pResult->dblTSCPerSec);
+    fprintf(fp, "ACPI wait rows: loop iteration incl. read over %d ticks, no overhead subtracted\n", BENCH_WAIT_TICKS);
+}
+
+/**
+  Print the result as CSV
+
+  @param  fp            output stream
+  @param  pResult       result
+
+**/
+void BenchPrintCsv(FILE* fp, BENCH_RESULT* pResult)
+{
+    double dblNsPerCycle = 1e9 / pResult->dblTSCPerSec;
+
+    fprintf(fp, "primitive,samples,min_cyc,p50_cyc,p99_cyc,max_cyc,avg_cyc,p50_ns,p99_ns,max_ns\n");
+
+    for (int n = 0; n < pResult->cntStat; n++)
+    {
+        BENCH_STAT* p = &pResult->rgStat[n];
+
+        fprintf(fp, "%s,%u,%lld,%lld,%lld,%lld,%.1f,%.1f,%.1f,%.1f\n",
+            p->pstrName,
+            p->cntSamples,
+            p->qwMin, p->qwP50, p->qwP99, p->qwMax,
+            p->dblAvg,
+            p->qwP50 * dblNsPerCycle, p->qwP99 * dblNsPerCycle, p->qwMax * dblNsPerCycle);
+    }
+}
@@ -0,0 +1,78 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Bench.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    micro benchmark of the timer read primitives
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define BENCH_RDTSC         0                           // __rdtsc()
+#define BENCH_RDTSCP        1                           // __rdtscp()
+#define BENCH_LFENCE_RDTSC  2                           // _mm_lfence() + __rdtsc()
+#define BENCH_MFENCE_RDTSC  3                           // _mm_mfence() + _mm_lfence() + __rdtsc()
+#define BENCH_RDMSR         4                           // __readmsr(IA32_TIME_STAMP_COUNTER)
+#define BENCH_ACPI          5                           // _inpd() PM timer
+#define BENCH_ACPI_MMIO     6                           // PM timer via X_PM_TMR_BLK SystemMemory, if available
+#define BENCH_PIT           7                           // PIT counter latch + 2 reads
+#define BENCH_RTC           8                           // rtcrd(), RTC index/data with 0xED IODELAY
+#define BENCH_APIC          9                           // local APIC timer current count, xAPIC MMIO or x2APIC MSR
+#define BENCH_RTC_HMS       10                          // rtcrd(0), rtcrd(2), rtcrd(4), drift test hh:mm:ss before RtcSnapshotRead()
+#define BENCH_RTC_SNAP      11                          // RtcSnapshotRead(), hh:mm:ss in one UIP safe window
+#define BENCH_WAIT_LEGACY   12                          // ACPI wait loop before ClkWaitKernel.hpp, TSC per loop iteration
+#define BENCH_WAIT_KERNEL   13                          // AcpiClkWait() ClkWaitKernel.hpp, TSC per loop iteration
+#define BENCH_NUMPRIM       14
+
+#define BENCH_SAMPLES       4096                        // samples per primitive
+#define BENCH_CHUNK         256                         // samples per interrupt disabled chunk
+#define BENCH_WAIT_TICKS    358                         // ACPI ticks per wait loop sample, ~100us
+
+typedef struct _BENCH_STAT {
+    const char* pstrName;
+    uint32_t cntSamples;
+    uint64_t qwMin;                                     // TSC cycles, measurement overhead subtracted
+    uint64_t qwP50;
+    uint64_t qwP99;
+    uint64_t qwMax;
+    double dblAvg;
+}BENCH_STAT;
+
+typedef struct _BENCH_RESULT {
+    double dblTSCPerSec;                                // TSC frequency, cycles to ns conversion
+    uint64_t qwOverhead;                                // median of empty measurement, subtracted from each sample
+    int cntStat;                                        // number of primitives measured, 0 if not yet run
+    BENCH_STAT rgStat[BENCH_NUMPRIM];
+}BENCH_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int BenchRun(BENCH_RESULT* pResult, double dblTSCPerSec);
+void BenchPrintTable(FILE* fp, BENCH_RESULT* pResult);
+void BenchPrintCsv(FILE* fp, BENCH_RESULT* pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_BENCH_H_
@@ -0,0 +1,255 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Campaign.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    unattended cold boot calibration campaign, RTC alarm wake from S5
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "Campaign.h"
+#include "RtcSnapshot.h"
+
+static uint8_t CampaignRtcRead(const CAMPAIGN_IO* pIo, uint8_t idx)
+{
+    pIo->pfnOutp(RTC_INDEX, idx);
+    return pIo->pfnInp(RTC_DATA);
+}
+
+static void CampaignRtcWrite(const CAMPAIGN_IO* pIo, uint8_t idx, uint8_t bData)
+{
+    pIo->pfnOutp(RTC_INDEX, idx);
+    pIo->pfnOutp(RTC_DATA, bData);
+}
+
+/**
+  Convert an RTC register to binary, BCD unless RTC_B_DM
+
+**/
+static uint32_t CampaignRtcToBin(uint8_t b, uint8_t bRegB)
+{
+    return RTC_B_DM & bRegB ? b : (b >> 4) * 10 + (b & 0x0F);
+}
+
+static uint8_t CampaignBinToRtc(uint32_t n, uint8_t bRegB)
+{
+    return (uint8_t)(RTC_B_DM & bRegB ? n : ((n / 10) << 4) + n % 10);
+}
+
+/**
+  Read the RTC hour register to 0..23, 12 hour mode included
+
+**/
+static uint32_t CampaignRtcHourToBin(uint8_t b, uint8_t bRegB)
+{
+    uint32_t hour = CampaignRtcToBin(b & ~RTC_HOUR_PM, bRegB);
+
+    if (RTC_B_24H & bRegB)
+        return hour;
+
+    return hour % 12 + (RTC_HOUR_PM & b ? 12 : 0);
+}
+
+static uint8_t CampaignBinToRtcHour(uint32_t hour, uint8_t bRegB)
+{
+    if (RTC_B_24H & bRegB)
+        return CampaignBinToRtc(hour, bRegB);
+
+    return CampaignBinToRtc(0 == hour % 12 ? 12 : hour % 12, bRegB) | (hour >= 12 ? RTC_HOUR_PM : 0);
+}
+
+/**
+  Read date and time in one UIP safe window through the backend, RtcSnapshotReadIo()
+
+  @retval 0 on success, -1 if no consistent window was found
+
+**/
+static int CampaignRtcNow(const CAMPAIGN_IO* pIo, uint32_t rgdwDate[3], uint32_t* pdwSecOfDay)
+{
+    RTC_SNAPSHOT_IO SnapIo = { pIo->pfnInp, pIo->pfnOutp };
+    RTC_SNAPSHOT Snap;
+    RTC_SNAPSHOT_DATE Date;
+
+    if (0 != RtcSnapshotReadIo(&Snap, &Date, &SnapIo))
+        return -1;
+
+    if (NULL != rgdwDate)
+    {
+        rgdwDate[0] = 2000 + CampaignRtcToBin(Date.bYear, Date.bRegB);
+        rgdwDate[1] = CampaignRtcToBin(Date.bMonth, Date.bRegB);
+        rgdwDate[2] = CampaignRtcToBin(Date.bDay, Date.bRegB);
+    }
+
+    *pdwSecOfDay = CampaignRtcHourToBin(Snap.bHour, Date.bRegB) * 3600 + CampaignRtcToBin(Snap.bMin, Date.bRegB) * 60 + CampaignRtcToBin(Snap.bSec, Date.bRegB);
+
+    return 0;
+}
+
+/**
+  Get the number of records in the dataset, the header line excluded
+
+**/
+uint32_t CampaignCount(const char* pstrFile)
+{
+    FILE* fp = fopen(pstrFile, "r");
+    uint32_t cntLines = 0;
+    int c, cPrev = '\n';
+
+    if (NULL == fp)
+        return 0;
+
+    while (EOF != (c = fgetc(fp)))
+    {
+        if ('\n' == c)
+            cntLines++;
+        cPrev = c;
+    }
+    if ('\n' != cPrev)                                  // last line without new line
+        cntLines++;
+
+    fclose(fp);
+
+    return cntLines > 0 ? cntLines - 1 : 0;
+}
+
+/**
+  Append one record to the dataset, write the header line to a new one
+
+  @retval number of records, 0 on failure
+
+**/
+static uint32_t CampaignAppend(const CAMPAIGN_IO* pIo, const char* pstrFile, CAMPAIGN_RECORD* pRecord)
+{
+    uint32_t nDone = CampaignCount(pstrFile), rgdwDate[3], dwSecOfDay;
+    FILE* fp;
+
+    if (0 != CampaignRtcNow(pIo, rgdwDate, &dwSecOfDay))
+        return 0;
+
+    fp = fopen(pstrFile, "a");
+    if (NULL == fp)
+        return 0;
+
+    if (0 == nDone)
+        fprintf(fp, "iteration,date,time,TSC at record,TSC per sec RTC,TSC per sec ACPI,TSC per sec rounded,EFI_TIMESTAMP_PROTOCOL per sec,method\n");
+
+    fprintf(fp, "%u,%04u-%02u-%02u,%02u:%02u:%02u,%llu,%lld,%lld,%lld,%lld,%s\n",
+        nDone + 1,
+        rgdwDate[0], rgdwDate[1], rgdwDate[2],
+        dwSecOfDay / 3600, dwSecOfDay / 60 % 60, dwSecOfDay % 60,
+        (unsigned long long)pRecord->qwTSC,
+        (long long)pRecord->llTSCPerSecRTC,
+        (long long)pRecord->llTSCPerSecACPI,
+        (long long)pRecord->llTSCPerSecACPIRnd,
+        (long long)pRecord->llTimestampPerSec,
+        NULL != pRecord->pstrMethod ? pRecord->pstrMethod : "");
+
+    fclose(fp);
+
+    return nDone + 1;
+}
+
+/**
+  Set the RTC alarm to now + dwWakeSec and enable the RTC wake event
+
+  The alarm matches hours, minutes and seconds, a wake time below 24h is unique.
+  Pending alarm flag and RTC_STS are cleared before RTC_EN is set.
+
+  @retval 0 on success, -1 if the RTC is not readable
+
+**/
+int CampaignArm(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo)
+{
+    uint32_t dwSecOfDay;
+    uint8_t bRegB;
+
+    if (0 != CampaignRtcNow(pIo, NULL, &dwSecOfDay))
+        return -1;
+
+    pCampaign->dwAlarmSec = (dwSecOfDay + pCampaign->dwWakeSec) % 86400;
+
+    bRegB = CampaignRtcRead(pIo, RTC_REG_B);
+    CampaignRtcWrite(pIo, RTC_REG_B, bRegB & ~RTC_B_AIE);
+    CampaignRtcWrite(pIo, RTC_REG_ALARM_SEC, CampaignBinToRtc(pCampaign->dwAlarmSec % 60, bRegB));
+    CampaignRtcWrite(pIo, RTC_REG_ALARM_MIN, CampaignBinToRtc(pCampaign->dwAlarmSec / 60 % 60, bRegB));
+    CampaignRtcWrite(pIo, RTC_REG_ALARM_HOUR, CampaignBinToRtcHour(pCampaign->dwAlarmSec / 3600, bRegB));
+    CampaignRtcRead(pIo, RTC_REG_C);                    // clear pending AF
+    CampaignRtcWrite(pIo, RTC_REG_B, bRegB | RTC_B_AIE);
+
+    pIo->pfnOutpw(pCampaign->wPm1aEvtBlk, PM1_RTC_STS);
+    pIo->pfnOutpw(pCampaign->wPm1aEn, pIo->pfnInpw(pCampaign->wPm1aEn) | PM1_RTC_EN);
+
+    return 0;
+}
+
+/**
+  Disable the RTC alarm and the RTC wake event
+
+**/
+void CampaignDisarm(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo)
+{
+    CampaignRtcWrite(pIo, RTC_REG_B, CampaignRtcRead(pIo, RTC_REG_B) & ~RTC_B_AIE);
+    CampaignRtcRead(pIo, RTC_REG_C);                    // clear pending AF
+
+    pIo->pfnOutpw(pCampaign->wPm1aEn, pIo->pfnInpw(pCampaign->wPm1aEn) & ~PM1_RTC_EN);
+    pIo->pfnOutpw(pCampaign->wPm1aEvtBlk, PM1_RTC_STS);
+}
+
+/**
+  Enter S5, SLP_TYP | SLP_EN as FILE menu "Switch off"
+
+**/
+void CampaignSwitchOff(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo)
+{
+    pIo->pfnOutp(pCampaign->wPm1aCntBlk + 1, (uint8_t)((pCampaign->bS5Val | PM1_SLP_EN) << 2));
+}
+
+/**
+  One campaign step per boot: append the record, then arm and enter S5 or finish
+
+  On hardware CampaignSwitchOff() doesn't return for CAMPAIGN_CONTINUE.
+
+  @param  pCampaign     campaign, nTotal, dwWakeSec and PM1 addresses set
+  @param  pIo           port backend, hardware or a simulation
+  @param  pstrFile      dataset, e.g. CAMPAIGN_FILENAME
+  @param  pRecord       calibration of this boot
+
+  @retval CAMPAIGN_CONTINUE, CAMPAIGN_DONE or CAMPAIGN_ERROR
+
+**/
+int CampaignStep(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo, const char* pstrFile, CAMPAIGN_RECORD* pRecord)
+{
+    pCampaign->nDone = CampaignAppend(pIo, pstrFile, pRecord);
+
+    if (0 == pCampaign->nDone)
+        return CAMPAIGN_ERROR;
+
+    if (pCampaign->nDone >= pCampaign->nTotal)
+    {
+        CampaignDisarm(pCampaign, pIo);
+        return CAMPAIGN_DONE;
+    }
+
+    if (0 != CampaignArm(pCampaign, pIo))
+        return CAMPAIGN_ERROR;
+
+    CampaignSwitchOff(pCampaign, pIo);
+
+    return CAMPAIGN_CONTINUE;
+}
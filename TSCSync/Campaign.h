@@ -0,0 +1,100 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Campaign.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    unattended cold boot calibration campaign, RTC alarm wake from S5
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CAMPAIGN_H_
+#define _CAMPAIGN_H_
+
+#include <stdint.h>
+
+//
+// NOTE:    Each boot appends its calibration to CAMPAIGN_FILENAME, the number of records
+//          is the iteration count, no further state is kept across boots. Until the
+//          requested number is reached, the RTC alarm is set to now + wake time, RTC_EN
+//          is set in PM1_EN and the platform enters S5. TSCSync must be started by
+//          startup.nsh with the same /CAMPAIGN parameters.
+//          All port accesses go through CAMPAIGN_IO, so the sequence can be run against
+//          a simulated RTC/PM1 backend, Samples/CampaignSim.c.
+//
+#define CAMPAIGN_FILENAME   "campaign.csv"
+#define CAMPAIGN_DFLT_WAKE  60                          // seconds in S5
+#define CAMPAIGN_MIN_WAKE   10                          // S5 entry and POST must not pass the alarm
+#define CAMPAIGN_MAXITER    10000
+
+#define CAMPAIGN_CONTINUE   0                           // alarm armed, S5 entered
+#define CAMPAIGN_DONE       1                           // requested number of records reached, alarm disarmed
+#define CAMPAIGN_ERROR      -1                          // dataset not writable or RTC not readable
+
+#define RTC_REG_ALARM_SEC   0x01
+#define RTC_REG_ALARM_MIN   0x03
+#define RTC_REG_ALARM_HOUR  0x05
+#define RTC_REG_C           0x0C                        // interrupt flags, cleared by read
+#define RTC_B_AIE           0x20                        // alarm interrupt enable
+#define RTC_B_DM            0x04                        // binary mode, BCD if clear
+#define RTC_B_24H           0x02                        // 24 hour mode
+#define RTC_HOUR_PM         0x80                        // 12 hour mode PM flag
+
+#define PM1_RTC_STS         (1 << 10)                   // PM1_STS, write 1 to clear
+#define PM1_RTC_EN          (1 << 10)                   // PM1_EN, RTC alarm wakes from S5
+#define PM1_SLP_EN          0x08                        // SLP_EN in SLP_TYP | SLP_EN nibble, PM1_CNT bits 13:10
+
+typedef struct _CAMPAIGN_IO {
+    uint8_t (*pfnInp)(uint16_t wPort);
+    void (*pfnOutp)(uint16_t wPort, uint8_t bData);
+    uint16_t (*pfnInpw)(uint16_t wPort);
+    void (*pfnOutpw)(uint16_t wPort, uint16_t wData);
+}CAMPAIGN_IO;
+
+typedef struct _CAMPAIGN {
+    uint32_t nTotal;                                    // requested number of records
+    uint32_t dwWakeSec;                                 // seconds in S5
+    uint16_t wPm1aEvtBlk;                               // PM1_STS
+    uint16_t wPm1aEn;                                   // PM1_EN, PM1a_EVT_BLK + PM1_EVT_LEN / 2
+    uint16_t wPm1aCntBlk;                               // PM1_CNT
+    uint8_t bS5Val;                                     // SLP_TYP of \_S5 from DSDT
+    uint32_t nDone;                                     // records in the dataset, CampaignStep()
+    uint32_t dwAlarmSec;                                // armed alarm, seconds of the day
+}CAMPAIGN;
+
+typedef struct _CAMPAIGN_RECORD {
+    uint64_t qwTSC;                                     // TSC at record, time since reset
+    int64_t llTSCPerSecRTC;
+    int64_t llTSCPerSecACPI;
+    int64_t llTSCPerSecACPIRnd;
+    int64_t llTimestampPerSec;                          // EFI_TIMESTAMP_PROTOCOL, 0 if N/A
+    const char* pstrMethod;
+}CAMPAIGN_RECORD;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t CampaignCount(const char* pstrFile);
+int CampaignArm(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo);
+void CampaignDisarm(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo);
+void CampaignSwitchOff(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo);
+int CampaignStep(CAMPAIGN* pCampaign, const CAMPAIGN_IO* pIo, const char* pstrFile, CAMPAIGN_RECORD* pRecord);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_CAMPAIGN_H_
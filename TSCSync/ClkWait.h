@@ -0,0 +1,196 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ClkWait.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    timed measurement kernels, ACPI and PIT delay loops, diagnostics output
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CLKWAIT_H_
+#define _CLKWAIT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <intrin.h>
+
+//
+// NOTE:    The measurement kernels don't do any console I/O. Diagnostics are
+//          returned in CLKWAIT_DIAG and displayed later, outside the timed section.
+//
+typedef struct _CLKWAIT_DIAG {
+    int64_t qwOvershoot;                                // additional ticks gone through beyond "Delay"
+    uint64_t qwTSCRaw;                                  // TSC end - TSC start, without error correction
+    uint32_t cntReads;                                  // number of counter reads
+    uint32_t dwMaxStep;                                 // largest counter step between two reads
+    uint32_t cntGlitch;                                 // rejected verified reads + implausible counter steps
+    uint32_t cntSegments;                               // interrupt disabled segments, 1 if not chunked
+    uint32_t cntWrapLost;                               // counter wraps lost in interrupt windows, restored
+    uint64_t qwTSCWindowMax;                            // longest interrupt window incl. the anchor reads
+}CLKWAIT_DIAG;
+
+//
+// NOTE:    The ACPI PM timer is accessed as described by the FADT, X_PM_TMR_BLK supersedes PM_TMR_BLK.
+//          If the timer is available via both SystemIO and SystemMemory, the faster path is selected.
+//
+#define PMTMR_ACCESS_AUTO   0                           // faster one of I/O and MMIO
+#define PMTMR_ACCESS_IO     1
+#define PMTMR_ACCESS_MMIO   2
+
+#define PMTMR_COST_READS    64                          // back-to-back reads per round
+#define PMTMR_COST_ROUNDS   16
+
+//
+// NOTE:    Long intervals are waited coarse on the PM1_STS TMR_STS bit, set by hardware each time the
+//          PM timer MSB toggles, and PAUSE bursts, the counter is polled fine only at start and end.
+//          TMR_STS must not be serviced by anyone else, e.g. an SCI handler.
+//
+#define ACPI_PM1_TMR_STS        (1 << 0)                // PM1_STS TMR_STS, write 1 to clear
+#define ACPI_TMRSTS_MINDELAY    (3579545 / 2)           // min. "Delay" in ACPI ticks to wait coarse
+#define ACPI_TMRSTS_GUARD       (3579545 / 500)         // fine polling for the last 2ms
+#define ACPI_TMRSTS_PAUSES      2048                    // PAUSE instructions between two coarse reads
+
+//
+// NOTE:    EFI_TIMESTAMP_PROTOCOL GetTimestamp() as reference counter, the only fast
+//          reference of hardware-reduced ACPI platforms without PM timer and PIT.
+//          The "Delay" in ACPI ticks is converted to GetTimestamp() ticks.
+//
+#define TIMESTAMP_ACPI_HZ       3579545ULL
+#define TIMESTAMP_COST_CALLS    64                      // back-to-back calls per round
+#define TIMESTAMP_COST_ROUNDS   16
+
+//
+// NOTE:    PIT OUT2 edge counting, intervals are built from reload periods of channel 2 in MODE 3
+//
+#define PIT_OUT2_MINRELOAD      64                      // min. OUT2 period, 54us, resolved by port 0x61 polling
+
+//
+// NOTE:    A counter step above MAXSTEP is a glitch, the value is dropped and the counter read again,
+//          neither the previous value nor the remaining ticks are updated. After CLKWAIT_GLITCH_RESYNC
+//          glitches in a row the counter is taken as is, e.g. behind a long SMI, the step is lost.
+//
+//          Chunked waits split long intervals into short interrupt disabled segments. Each segment
+//          end is anchored, TSC and ticks since the start of the wait, in gClkWaitSegRec. The
+//          counter read behind an interrupt window is stitched to the phase of the segments before:
+//          the ticks per TSC up to the anchor predict the ticks across the window, whole counter
+//          ranges missing in the step read across the window are lost wraps, e.g. a handler longer
+//          than 55ms on the PIT. They are added back and reported in cntWrapLost. Start and end of
+//          the wait stay anchored on counter reads.
+//
+#define CLKWAIT_GLITCH_RESYNC   16                      // glitches in a row to take the counter as is
+
+#define CLKWAIT_CHUNK_US        1000                    // interrupt disabled segment length
+#define CLKWAIT_CHUNK_RTCREADS  1000                    // RTC register A reads per segment, ~1us each
+#define CLKWAIT_MAXANCHOR       1024                    // segment end anchors kept per wait
+
+typedef struct _CLKWAIT_ANCHOR {
+    uint64_t qwTSC;                                     // TSC since the start of the wait
+    uint64_t qwTicks;                                   // counter ticks since the start of the wait
+}CLKWAIT_ANCHOR;
+
+typedef struct _CLKWAIT_SEGREC {
+    uint32_t cntSeg;                                    // segment ends of the last chunked wait
+    CLKWAIT_ANCHOR rgAnchor[CLKWAIT_MAXANCHOR];         // the first CLKWAIT_MAXANCHOR of them
+}CLKWAIT_SEGREC;
+
+//
+// scale the TSC gone through to "Ticks", "count" is the negative overshoot, double keeps
+// TSC * Ticks from overflowing 64 bit on long waits and fast reference counters
+//
+static __inline uint64_t ClkWaitErrorCorrect(uint64_t qwTSC, int64_t Ticks, int64_t count)
+{
+    return (uint64_t)((double)qwTSC * (double)Ticks / (double)(Ticks - count) + 0.5);
+}
+
+//
+// counter wraps lost in an interrupt window, the ticks per TSC up to the anchor predict the
+// ticks across the window, "qwStep" is the masked counter step read across the window
+//
+static __inline uint32_t ClkWaitLostWraps(uint64_t qwTSCAnchor, uint64_t qwTicksAnchor, uint64_t qwTSCWindow, uint64_t qwStep, uint64_t qwRange)
+{
+    double dblTicks;
+
+    if (0 == qwTSCAnchor)
+        return 0;
+
+    dblTicks = (double)qwTSCWindow * (double)qwTicksAnchor / (double)qwTSCAnchor;
+    if (dblTicks < (double)qwStep + (double)qwRange / 2)
+        return 0;
+
+    return (uint32_t)((dblTicks - (double)qwStep) / (double)qwRange + 0.5);
+}
+
+//
+// let pending interrupts in between two segments, the STI shadow covers one instruction only
+//
+static __inline void ClkWaitChunkWindow(size_t eflags)
+{
+    if (0x200 & eflags)
+    {
+        _enable();
+        _mm_pause();
+        _disable();
+    }
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int gfVerifiedRead;                              // verified counter reads, slower, glitch resistant
+extern int gfChunkedWait;                               // interrupt friendly, CLKWAIT_CHUNK_US segments
+extern CLKWAIT_SEGREC gClkWaitSegRec;                   // segment end anchors of the last chunked wait
+extern uint16_t gPmTmrBlkAddr;                          // PM timer SystemIO address
+extern volatile uint32_t* gpPmTmrMmio;                  // PM timer SystemMemory address, NULL if not available
+extern int gfPmTmrMmio;                                 // PM timer is read via gpPmTmrMmio
+extern uint16_t gPm1aEvtBlkAddr;                        // PM1a_EVT_BLK SystemIO address, PM1_STS, 0 if not available
+extern int gfAcpiTmrSts;                                // wait long intervals coarse on TMR_STS
+
+unsigned GetACPICount(short p);
+uint64_t AcpiPmTmrReadCost(int fMmio);
+
+extern uint64_t(*gpfnGetTimestamp)(void);              // EFI_TIMESTAMP_PROTOCOL.GetTimestamp(), NULL if not available
+extern uint64_t gqwTimestampFreq;                       // GetTimestamp() ticks per second, measured against RTC
+extern uint64_t gqwTimestampEnd;                        // GetTimestamp() EndValue
+
+int64_t TimestampClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+uint64_t TimestampLatency(void);
+uint64_t TimestampFreqRtc(int seconds);
+
+int64_t AcpiClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t AcpiClkWaitLegacy(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t PITClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t PITOut2ClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t AcpiTmrStsClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t InternalAcpiDelay(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+int64_t ApicClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag);
+
+#ifdef __cplusplus
+}
+#endif
+
+//
+// anchor the end of segment "nSeg" before an interrupt window
+//
+static __inline void ClkWaitSegAnchor(uint32_t nSeg, uint64_t qwTSC, uint64_t qwTicks)
+{
+    if (nSeg < CLKWAIT_MAXANCHOR)
+        gClkWaitSegRec.rgAnchor[nSeg].qwTSC = qwTSC, gClkWaitSegRec.rgAnchor[nSeg].qwTicks = qwTicks;
+
+    gClkWaitSegRec.cntSeg = nSeg + 1;
+}
+
+#endif//_CLKWAIT_H_
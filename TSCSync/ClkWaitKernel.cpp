@@ -0,0 +1,107 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ClkWaitKernel.cpp
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    ACPI and PIT wait kernel instantiations
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include "ClkWaitKernel.hpp"
+
+extern "C" int gfErrorCorrection;
+extern "C" uint32_t gCOUNTER_WIDTH;
+
+//
+// error correction, verified read mode and segment length are selected once per call
+//
+template<class COUNTER>
+static int64_t ClkWaitDispatch(uint32_t Ticks, CLKWAIT_DIAG* pDiag)
+{
+    uint32_t Chunk = 0;
+
+    if (gfChunkedWait)
+        Chunk = (uint32_t)((0 != COUNTER::HZ ? COUNTER::HZ : gqwApicTimerFreq) * CLKWAIT_CHUNK_US / 1000000);
+
+    if (1 == gfErrorCorrection)
+        return gfVerifiedRead ? ClkWaitKernel<COUNTER, true, true>(Ticks, Chunk, pDiag) : ClkWaitKernel<COUNTER, true, false>(Ticks, Chunk, pDiag);
+    else
+        return gfVerifiedRead ? ClkWaitKernel<COUNTER, false, true>(Ticks, Chunk, pDiag) : ClkWaitKernel<COUNTER, false, false>(Ticks, Chunk, pDiag);
+}
+
+/**
+  Wait "Delay" ACPI ticks and return the number of TSC gone through
+
+  Counter width, I/O or MMIO access, error correction and verified read mode are
+  selected once per call, the kernel itself is specialized on all of them.
+  Long intervals are waited coarse on TMR_STS, if gfAcpiTmrSts.
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, overshoot, number of reads, may be NULL
+
+  @retval number of TSC per "Delay"
+
+**/
+extern "C" int64_t AcpiClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    if (gfAcpiTmrSts && 0 != gPm1aEvtBlkAddr && Delay >= ACPI_TMRSTS_MINDELAY)
+        return AcpiTmrStsClkWait(Delay, pDiag);
+
+    if (gfPmTmrMmio)
+        return 32 == gCOUNTER_WIDTH ? ClkWaitDispatch<CLKPOLICY_ACPI32_MMIO>(Delay, pDiag) : ClkWaitDispatch<CLKPOLICY_ACPI24_MMIO>(Delay, pDiag);
+    else
+        return 32 == gCOUNTER_WIDTH ? ClkWaitDispatch<CLKPOLICY_ACPI32>(Delay, pDiag) : ClkWaitDispatch<CLKPOLICY_ACPI24>(Delay, pDiag);
+}
+
+/**
+  Wait "Delay" ACPI ticks, Delay / 3 PIT ticks, and return the number of TSC gone through
+
+  NOTE: 3579545Hz / 3 == 1193181.666Hz, the ACPI timer and the PIT share the 14.31818MHz crystal
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, overshoot in PIT ticks, number of reads, may be NULL
+
+  @retval number of TSC per "Delay"
+
+**/
+extern "C" int64_t PITClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    return ClkWaitDispatch<CLKPOLICY_PIT>(Delay / 3, pDiag);
+}
+
+/**
+  Wait "Delay" ACPI ticks on the local APIC timer and return the number of TSC gone through
+
+  "Delay" is converted to APIC timer ticks by the frequency measured against RTC.
+  Available only if the timer is free running, programmed by ApicTimerInit().
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, overshoot in APIC timer ticks, number of reads, may be NULL
+
+  @retval number of TSC per "Delay"
+
+**/
+extern "C" int64_t ApicClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    uint32_t Ticks = (uint32_t)(((uint64_t)Delay * gqwApicTimerFreq + TIMESTAMP_ACPI_HZ / 2) / TIMESTAMP_ACPI_HZ);
+
+    if (APIC_ACCESS_X2APIC == gnApicAccess)
+        return ClkWaitDispatch<CLKPOLICY_X2APIC>(Ticks, pDiag);
+    else
+        return ClkWaitDispatch<CLKPOLICY_XAPIC>(Ticks, pDiag);
+}
@@ -0,0 +1,239 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ClkWaitKernel.hpp
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    width generic wait kernel, template specialized on counter policy and error correction
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CLKWAITKERNEL_HPP_
+#define _CLKWAITKERNEL_HPP_
+
+#include <stdint.h>
+#include <conio.h>
+#include <intrin.h>
+#include "ClkWait.h"
+#include "ApicTimer.h"
+#include "TscPolicy.h"
+
+//
+// NOTE:    A counter policy provides
+//
+//              WIDTH       counter width in bits
+//              DOWN        true for down counters
+//              HZ          tick rate
+//              MAXSTEP     largest plausible step between two loop iterations
+//              VERIFYSTEP  largest plausible step between two back-to-back reads
+//              Read()      counter read, inlined into the kernel
+//
+//          All of them are compile time constants, the kernel inner loop has no
+//          width or direction check. The only other branch is the MAXSTEP glitch check.
+//          The loop rate is bound by the counter read, the kernel isn't faster per read
+//          than the loop it replaced, /BENCH "ACPI wait" rows. It removes the 16 bit
+//          truncation and the I/O or MMIO selection per read.
+//
+struct CLKPOLICY_ACPI24 {
+    static const uint32_t WIDTH = 24;
+    static const bool DOWN = false;
+    static const uint32_t HZ = 3579545;
+    static const uint32_t MAXSTEP = 1 << 22;            // 1.17s
+    static const uint32_t VERIFYSTEP = 64;
+    static __forceinline uint32_t Read(void) { return (uint32_t)_inpd(gPmTmrBlkAddr); }
+};
+
+struct CLKPOLICY_ACPI32 {
+    static const uint32_t WIDTH = 32;
+    static const bool DOWN = false;
+    static const uint32_t HZ = 3579545;
+    static const uint32_t MAXSTEP = 1 << 22;            // 1.17s
+    static const uint32_t VERIFYSTEP = 64;
+    static __forceinline uint32_t Read(void) { return (uint32_t)_inpd(gPmTmrBlkAddr); }
+};
+
+struct CLKPOLICY_ACPI24_MMIO : CLKPOLICY_ACPI24 {
+    static __forceinline uint32_t Read(void) { return *gpPmTmrMmio; }
+};
+
+struct CLKPOLICY_ACPI32_MMIO : CLKPOLICY_ACPI32 {
+    static __forceinline uint32_t Read(void) { return *gpPmTmrMmio; }
+};
+
+struct CLKPOLICY_XAPIC {
+    static const uint32_t WIDTH = 32;
+    static const bool DOWN = true;
+    static const uint32_t HZ = 0;                       // calibrated at runtime, gqwApicTimerFreq
+    static const uint32_t MAXSTEP = 1U << 30;
+    static const uint32_t VERIFYSTEP = 4096;            // up to ~1GHz timer clock, divide by 1
+    static __forceinline uint32_t Read(void) { return gpApicMmio[APIC_TMR_CURRENT >> 2]; }
+};
+
+struct CLKPOLICY_X2APIC : CLKPOLICY_XAPIC {
+    static __forceinline uint32_t Read(void) { return (uint32_t)__readmsr(0x800 + (APIC_TMR_CURRENT >> 4)); }
+};
+
+struct CLKPOLICY_PIT {
+    static const uint32_t WIDTH = 16;
+    static const bool DOWN = true;
+    static const uint32_t HZ = 1193182;                 // 14.31818MHz / 12
+    static const uint32_t MAXSTEP = 1 << 15;            // 27ms, half the counter range
+    static const uint32_t VERIFYSTEP = 64;              // less than a torn high byte
+    static __forceinline uint32_t Read(void)
+    {
+        uint32_t lo, hi;
+
+        _outp(0x43, (2/*TIMER*/ << 6) + 0x0);          // counter latch timer 2
+        lo = (uint8_t)_inp(0x40 + 2/*TIMER*/);          // get low byte
+        hi = (uint8_t)_inp(0x40 + 2/*TIMER*/);          // get high byte
+
+        return (hi << 8) | lo;
+    }
+};
+
+/**
+  Wait "Ticks" counter ticks and return the number of TSC gone through
+
+  Interrupts are disabled while waiting. No console I/O, diagnostics are returned in pDiag.
+
+  fVerified: each counter value is read twice, a pair further apart than VERIFYSTEP
+  is a glitch (spurious PM timer value, torn PIT latch read) and is read again.
+  Steps above MAXSTEP are glitches in both modes, dropped without updating "previous"
+  and "count", see CLKWAIT_GLITCH_RESYNC.
+
+  Chunk: the wait is split into segments of "Chunk" ticks, pending interrupts are let in
+  between two segments. The last segment is at least "Chunk" ticks long. Each segment end
+  is anchored in gClkWaitSegRec, wraps lost in a window are restored, see ClkWaitLostWraps().
+
+  @param  Ticks         counter ticks to wait
+  @param  Chunk         counter ticks per interrupt disabled segment, 0 for a single segment
+  @param  pDiag         diagnostics, overshoot, number of reads, may be nullptr
+
+  @retval number of TSC per "Ticks", overshoot subtracted if fErrorCorrection
+
+**/
+template<class COUNTER, bool fErrorCorrection, bool fVerified>
+int64_t ClkWaitKernel(uint32_t Ticks, uint32_t Chunk, CLKWAIT_DIAG* pDiag)
+{
+    const uint32_t COUNTER_MASK = (uint32_t)((1ULL << COUNTER::WIDTH) - 1);
+    int64_t count = Ticks, segment;
+    uint64_t qwTSCStart, qwTSCEnd, qwTSCPerIntervall;
+    uint64_t qwTSCAnchor, qwTSCWindow, qwTSCWindowMax = 0;
+    uint32_t previous, current, verify, diff, maxdiff = 0, cntReads = 0, cntGlitch = 0, cntInRow = 0;
+    uint32_t cntSeg = 0, cntWrapLost = 0, wraps;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+    COUNTER::Read();                                    // warm up I/O path
+
+    previous = COUNTER::Read();
+    qwTSCStart = ReadTSC();                             // get TSC start
+
+    while (count > 0)
+    {
+        segment = 0 != Chunk && count > 2 * (int64_t)Chunk ? count - Chunk : 0;
+
+        while (count > segment)
+        {
+            current = COUNTER::Read();
+
+            if (fVerified)
+            {
+                verify = COUNTER::Read();
+
+                if ((COUNTER_MASK & (COUNTER::DOWN ? current - verify : verify - current)) > COUNTER::VERIFYSTEP)
+                {
+                    cntGlitch++;
+                    continue;
+                }
+            }
+
+            diff = COUNTER_MASK & (COUNTER::DOWN ? previous - current : current - previous);
+            if (diff > COUNTER::MAXSTEP)
+            {
+                cntGlitch++;
+                if (++cntInRow < CLKWAIT_GLITCH_RESYNC)
+                    continue;
+                diff = 0;                               // resync, the step is lost
+            }
+            cntInRow = 0;
+            previous = current;
+            count -= diff;
+            cntReads++;
+            maxdiff = diff > maxdiff ? diff : maxdiff;
+        }
+
+        if (count > 0)
+        {
+            //
+            // anchor the segment end, let interrupts in, stitch the next segment to the phase
+            //
+            qwTSCAnchor = ReadTSC();
+            ClkWaitSegAnchor(cntSeg++, qwTSCAnchor - qwTSCStart, Ticks - count);
+
+            ClkWaitChunkWindow(eflags);
+
+            for (uint32_t n = 0; ; n++)
+            {
+                current = COUNTER::Read();
+                if (!fVerified || CLKWAIT_GLITCH_RESYNC == n)
+                    break;
+
+                verify = COUNTER::Read();
+                if ((COUNTER_MASK & (COUNTER::DOWN ? current - verify : verify - current)) <= COUNTER::VERIFYSTEP)
+                    break;
+                cntGlitch++;
+            }
+            qwTSCWindow = ReadTSC() - qwTSCAnchor;
+
+            diff = COUNTER_MASK & (COUNTER::DOWN ? previous - current : current - previous);
+            wraps = ClkWaitLostWraps(qwTSCAnchor - qwTSCStart, Ticks - count, qwTSCWindow, diff, (uint64_t)COUNTER_MASK + 1);
+            previous = current;
+            count -= diff + (int64_t)wraps * ((int64_t)COUNTER_MASK + 1);
+            cntReads++;
+            cntWrapLost += wraps;
+            qwTSCWindowMax = qwTSCWindow > qwTSCWindowMax ? qwTSCWindow : qwTSCWindowMax;
+        }
+    }
+
+    qwTSCEnd = ReadTSC();                               // get TSC end
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    //
+    // subtract the additional number of TSC gone through, "count" is negative
+    //
+    if (fErrorCorrection)
+        qwTSCPerIntervall = ClkWaitErrorCorrect(qwTSCEnd - qwTSCStart, Ticks, count);
+    else
+        qwTSCPerIntervall = qwTSCEnd - qwTSCStart;
+
+    if (nullptr != pDiag)
+    {
+        pDiag->qwOvershoot = -count;                    // Additional ticks gone through
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads;
+        pDiag->dwMaxStep = maxdiff;
+        pDiag->cntGlitch = cntGlitch;
+        pDiag->cntSegments = cntSeg + 1;
+        pDiag->cntWrapLost = cntWrapLost;
+        pDiag->qwTSCWindowMax = qwTSCWindowMax;
+    }
+
+    return (int64_t)qwTSCPerIntervall;
+}
+
+#endif//_CLKWAITKERNEL_HPP_
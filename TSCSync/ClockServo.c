@@ -0,0 +1,202 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ClockServo.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    PLL/FLL clock discipline of a TSC based clock against RTC second edges
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <conio.h>
+#include <intrin.h>
+#include "ClockServo.h"
+#include "TscPolicy.h"
+
+/**
+  Initialize the servo before the first ServoUpdate() call
+
+  @param  pServo        servo state
+  @param  dblTSCNominal TSC frequency of the free running clock
+
+**/
+void ServoInit(CLOCK_SERVO* pServo, double dblTSCNominal)
+{
+    memset(pServo, 0, sizeof(CLOCK_SERVO));
+
+    pServo->dblTSCNominal = dblTSCNominal;
+    pServo->nState = SERVO_NSET;
+    pServo->nPollExp = SERVO_MINPOLL;
+    pServo->dblLockTime = -1.0;
+}
+
+/**
+  Disciplined clock
+
+  @param  pServo        servo state
+  @param  qwTSC         TSC
+
+  @retval time in seconds since first reference edge
+
+**/
+double ServoClock(CLOCK_SERVO* pServo, uint64_t qwTSC)
+{
+    return pServo->dblClkBase + (double)(int64_t)(qwTSC - pServo->qwTSCBase) / pServo->dblTSCNominal * (1.0 + pServo->dblFreq);
+}
+
+/**
+  Take one reference edge, clock discipline in the style of NTP
+
+  NSET  the first edge sets the clock
+  FREQ  after SERVO_FREQ_INTERVAL the frequency is measured directly from the offset, the clock is set
+  SYNC  type II PLL, phase corrected by SERVO_KP * offset, frequency by SERVO_KI * offset / interval.
+        The FLL part, the offset change not explained by the previous residual, is blended
+        in with a weight growing with the update interval, like NTP does above the Allan intercept.
+
+  The poll interval is doubled after SERVO_POLL_HYST consecutive offsets below SERVO_LOCK_US
+  and halved if the offset exceeds 4 * SERVO_LOCK_US.
+
+  @param  pServo        servo state
+  @param  qwTSC         TSC at reference second edge
+
+**/
+void ServoUpdate(CLOCK_SERVO* pServo, uint64_t qwTSC)
+{
+    double dblRefTime, dblOffset, dblOffsetFree, mu;
+
+    //
+    // reference time, number of seconds gone through is taken from the free running clock
+    //
+    if (SERVO_NSET == pServo->nState)
+    {
+        pServo->qwTSCStart = pServo->qwTSCBase = pServo->qwTSCRef = qwTSC;
+        pServo->dblRefTime = pServo->dblClkBase = 0.0;
+        pServo->nState = SERVO_FREQ;
+        pServo->cntUpdates++;
+        return;
+    }
+
+    mu = (double)(qwTSC - pServo->qwTSCRef) / pServo->dblTSCNominal;
+    dblRefTime = pServo->dblRefTime + floor(mu + 0.5);
+    mu = dblRefTime - pServo->dblRefTime;
+
+    if (mu < 1.0)
+        return;
+
+    dblOffset = dblRefTime - ServoClock(pServo, qwTSC);
+    dblOffsetFree = dblRefTime - (double)(qwTSC - pServo->qwTSCStart) / pServo->dblTSCNominal;
+
+    switch (pServo->nState)
+    {
+    case SERVO_FREQ:
+        if (dblRefTime < SERVO_FREQ_INTERVAL)
+            return;                                     // keep measuring, don't take the edge
+
+        pServo->dblFreq += dblOffset / dblRefTime;
+        pServo->dblClkBase = dblRefTime;
+        pServo->qwTSCBase = qwTSC;
+        pServo->dblResidual = 0.0;
+        pServo->nState = SERVO_SYNC;
+        break;
+
+    case SERVO_SYNC:
+    {
+        double wFll = mu / (mu + SERVO_ALLAN);
+        double dblPll = SERVO_KI * dblOffset / mu;
+        double dblFll = (dblOffset - pServo->dblResidual) / mu;
+        double dblClk = dblRefTime - dblOffset;         // clock at this edge, before the frequency changes
+
+        pServo->dblFreq += (1.0 - wFll) * dblPll + wFll * dblFll;
+        pServo->dblClkBase = dblClk + SERVO_KP * dblOffset;
+        pServo->qwTSCBase = qwTSC;
+        pServo->dblResidual = (1.0 - SERVO_KP) * dblOffset;
+
+        pServo->dblJitter = sqrt(0.75 * pServo->dblJitter * pServo->dblJitter + 0.25 * dblOffset * dblOffset);
+
+        //
+        // poll interval and convergence
+        //
+        if (fabs(dblOffset) < SERVO_LOCK_US * 1e-6)
+        {
+            if (++pServo->cntGood >= SERVO_POLL_HYST)
+            {
+                if (pServo->dblLockTime < 0.0)
+                    pServo->dblLockTime = dblRefTime;
+
+                if (pServo->nPollExp < SERVO_MAXPOLL)
+                    pServo->nPollExp++, pServo->cntGood = 0;
+            }
+        }
+        else
+        {
+            if (fabs(dblOffset) > 4 * SERVO_LOCK_US * 1e-6 && pServo->nPollExp > SERVO_MINPOLL)
+                pServo->nPollExp--;
+
+            pServo->cntGood = 0;
+        }
+        break;
+    }
+    }
+
+    pServo->qwTSCRef = qwTSC;
+    pServo->dblRefTime = dblRefTime;
+    pServo->dblOffset = dblOffset;
+    pServo->cntUpdates++;
+
+    if (pServo->cntHist < SERVO_MAXHIST)
+    {
+        SERVO_HIST* pHist = &pServo->rgHist[pServo->cntHist++];
+
+        pHist->dblTime = dblRefTime;
+        pHist->dblOffset = dblOffset;
+        pHist->dblOffsetFree = dblOffsetFree;
+        pHist->dblFreq = pServo->dblFreq;
+        pHist->nPoll = 1U << pServo->nPollExp;
+    }
+}
+
+/**
+  Wait for the RTC update ended edge, falling edge of UIP
+
+  Interrupts are disabled for max. one second.
+
+  @retval TSC at edge
+
+**/
+uint64_t ServoWaitRtcEdge(void)
+{
+    uint64_t qwTSC;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    _outp(0x70, 0x0A);                                  // RTC Register A
+
+    while (0 == (0x80 & _inp(0x71)))
+        ;
+    while (0 != (0x80 & _inp(0x71)))
+        ;
+    qwTSC = ReadTSC();                                  // get TSC at falling edge
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return qwTSC;
+}
@@ -0,0 +1,89 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ClockServo.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    PLL/FLL clock discipline of a TSC based clock against RTC second edges
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CLOCKSERVO_H_
+#define _CLOCKSERVO_H_
+
+#include <stdint.h>
+
+#define SERVO_NSET          0                           // no reference yet
+#define SERVO_FREQ          1                           // initial frequency measurement
+#define SERVO_SYNC          2                           // PLL/FLL tracking
+
+#define SERVO_FREQ_INTERVAL 4.0                         // initial frequency measurement interval in seconds
+#define SERVO_KP            0.7                         // PLL proportional gain, phase
+#define SERVO_KI            0.3                         // PLL integral gain, frequency
+#define SERVO_ALLAN         256.0                       // FLL weight is 50% at this update interval in seconds
+#define SERVO_MINPOLL       0                           // min. poll interval 2^0 seconds
+#define SERVO_MAXPOLL       6                           // max. poll interval 2^6 seconds
+#define SERVO_POLL_HYST     4                           // consecutive good updates before the poll interval is doubled
+#define SERVO_LOCK_US       20.0                        // offset below this is "good"/locked
+#define SERVO_MAXHIST       4096                        // number of update history entries
+
+typedef struct _SERVO_HIST {
+    double dblTime;                                     // reference time in seconds since start
+    double dblOffset;                                   // offset reference - disciplined clock in seconds, before correction
+    double dblOffsetFree;                               // offset reference - free running clock in seconds
+    double dblFreq;                                     // fractional frequency correction after update
+    uint32_t nPoll;                                     // poll interval in seconds
+}SERVO_HIST;
+
+typedef struct _CLOCK_SERVO {
+    double dblTSCNominal;                               // TSC frequency of the free running clock, frozen
+    int nState;                                         // SERVO_NSET, SERVO_FREQ, SERVO_SYNC
+    //
+    // disciplined clock, time = dblClkBase + (TSC - qwTSCBase) / dblTSCNominal * (1 + dblFreq)
+    //
+    uint64_t qwTSCBase;
+    double dblClkBase;
+    double dblFreq;                                     // fractional frequency correction
+    //
+    // reference
+    //
+    uint64_t qwTSCStart;                                // TSC at first reference edge
+    uint64_t qwTSCRef;                                  // TSC at previous reference edge
+    double dblRefTime;                                  // reference time of previous edge
+    double dblOffset;                                   // offset at previous update
+    double dblResidual;                                 // offset left after phase correction of previous update
+    double dblJitter;                                   // RMS offset, exponential average
+    uint32_t nPollExp;                                  // poll interval 2^nPollExp seconds
+    uint32_t cntGood;                                   // consecutive updates below SERVO_LOCK_US
+    uint32_t cntUpdates;                                // number of reference edges taken
+    double dblLockTime;                                 // convergence time in seconds, < 0 if not yet locked
+    uint32_t cntHist;
+    SERVO_HIST rgHist[SERVO_MAXHIST];
+}CLOCK_SERVO;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void ServoInit(CLOCK_SERVO* pServo, double dblTSCNominal);
+double ServoClock(CLOCK_SERVO* pServo, uint64_t qwTSC);
+void ServoUpdate(CLOCK_SERVO* pServo, uint64_t qwTSC);
+uint64_t ServoWaitRtcEdge(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_CLOCKSERVO_H_
@@ -0,0 +1,259 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    CrossRef.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    simultaneous ACPI timer vs. PIT cross-reference, frequency ratio, ratio drift and jitter
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <conio.h>
+#include <intrin.h>
+#include "CrossRef.h"
+#include "TscPolicy.h"
+
+extern uint16_t gPmTmrBlkAddr;
+extern uint32_t gCOUNTER_WIDTH;
+extern unsigned GetACPICount(short p);
+
+const char* grgstrXRefName[XREF_NUMREF] = { "ACPI", "i8254" };
+
+static const double grgdblXRefFreq[XREF_NUMREF] = { XREF_ACPI_FREQ, XREF_PIT_FREQ };
+
+/**
+  Initialize the cross-reference before the first CrossRefCapture() call
+
+  @param  pXR           cross-reference state
+  @param  dblTSCNominal nominal TSC frequency, e.g. from ACPI calibration
+
+**/
+void CrossRefInit(XREF_RESULT* pXR, double dblTSCNominal)
+{
+    memset(pXR, 0, sizeof(XREF_RESULT));
+
+    pXR->dblTSCNominal = dblTSCNominal;
+}
+
+/**
+  Read PIT i8254 timer 2, programmed to MODE 2, 65536 by main()
+
+**/
+static uint16_t CrossRefPitRead(void)
+{
+    uint8_t counterLoHi[2];
+
+    _outp(0x43, (2/*TIMER*/ << 6) + 0x0);                           // counter latch timer 2
+    counterLoHi[0] = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get low byte
+    counterLoHi[1] = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get high byte
+
+    return *(uint16_t*)&counterLoHi[0];
+}
+
+/**
+  Resolve counter wrap arounds by the number of ticks expected from the TSC
+
+  @param  qwDelta       counter difference modulo qwModulus
+  @param  qwModulus     counter modulus
+  @param  dblExpected   number of ticks expected from the TSC
+
+  @retval number of ticks gone through
+
+**/
+static uint64_t CrossRefUnwrap(uint64_t qwDelta, uint64_t qwModulus, double dblExpected)
+{
+    double k = floor((dblExpected - (double)qwDelta) / (double)qwModulus + 0.5);
+
+    return qwDelta + (k > 0.0 ? (uint64_t)k * qwModulus : 0);
+}
+
+/**
+  Poll ACPI timer and PIT alternately with interrupts disabled, add a sample every XREF_SAMPLE_TICKS
+
+  Each read is TSC stamped, a sample holds the latest ACPI and PIT read of the same loop.
+  Counter wrap arounds during the pause between two calls are resolved by the TSC,
+  so CrossRefCapture() can be called repeatedly to update the screen in between.
+
+  @param  pXR           cross-reference state, initialized by CrossRefInit()
+  @param  qwTSCWidth    time to poll in TSC ticks
+
+  @retval number of samples added in this call
+
+**/
+uint64_t CrossRefCapture(XREF_RESULT* pXR, uint64_t qwTSCWidth)
+{
+    uint32_t COUNTER_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    double dblTSCPerAcpiTick = pXR->dblTSCNominal / XREF_ACPI_FREQ;
+    double dblTSCPerPitTick = pXR->dblTSCNominal / XREF_PIT_FREQ;
+    uint64_t qwTSC, qwTSCEnd, cntSamples = 0;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    if (0 == pXR->qwTSCStart)
+    {
+        pXR->dwAcpiPrev = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        pXR->qwTSCStart = pXR->rgqwTSCPrev[XREF_REF_ACPI] = ReadTSC();
+        pXR->wPitPrev = CrossRefPitRead();
+        pXR->rgqwTSCPrev[XREF_REF_PIT] = ReadTSC();
+        pXR->qwAcpiGrid = XREF_SAMPLE_TICKS;
+    }
+
+    qwTSCEnd = ReadTSC() + qwTSCWidth;
+
+    do
+    {
+        uint32_t dwAcpi = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        uint16_t wPit;
+
+        qwTSC = ReadTSC();
+
+        pXR->rgqwTicks[XREF_REF_ACPI] += CrossRefUnwrap(COUNTER_MASK & (dwAcpi - pXR->dwAcpiPrev), COUNTER_MASK + 1ULL, (qwTSC - pXR->rgqwTSCPrev[XREF_REF_ACPI]) / dblTSCPerAcpiTick);
+        pXR->dwAcpiPrev = dwAcpi;
+        pXR->rgqwTSCPrev[XREF_REF_ACPI] = qwTSC;
+
+        wPit = CrossRefPitRead();                       // PIT counts down
+
+        qwTSC = ReadTSC();
+
+        pXR->rgqwTicks[XREF_REF_PIT] += CrossRefUnwrap((uint16_t)(pXR->wPitPrev - wPit), 0x10000ULL, (qwTSC - pXR->rgqwTSCPrev[XREF_REF_PIT]) / dblTSCPerPitTick);
+        pXR->wPitPrev = wPit;
+        pXR->rgqwTSCPrev[XREF_REF_PIT] = qwTSC;
+
+        pXR->cntReads++;
+
+        if (pXR->rgqwTicks[XREF_REF_ACPI] >= pXR->qwAcpiGrid && pXR->cntSamples < XREF_MAXSAMPLES)
+        {
+            XREF_SAMPLE* pSample = &pXR->rgSample[pXR->cntSamples++];
+
+            for (int n = 0; n < XREF_NUMREF; n++)
+            {
+                pSample->rgqwTSC[n] = pXR->rgqwTSCPrev[n] - pXR->qwTSCStart;
+                pSample->rgqwTicks[n] = pXR->rgqwTicks[n];
+            }
+
+            pXR->qwAcpiGrid = pXR->rgqwTicks[XREF_REF_ACPI] - pXR->rgqwTicks[XREF_REF_ACPI] % XREF_SAMPLE_TICKS + XREF_SAMPLE_TICKS;
+            cntSamples++;
+        }
+
+    } while (qwTSC < qwTSCEnd);
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return cntSamples;
+}
+
+/**
+  Least squares fit of reference seconds over TSC seconds for samples first..last - 1
+
+**/
+static void CrossRefFit(XREF_RESULT* pXR, int nRef, uint32_t first, uint32_t last, double rgdblFit[2])
+{
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, mx, my, n = (double)(last - first);
+
+    for (uint32_t i = first; i < last; i++)
+    {
+        sx += (double)pXR->rgSample[i].rgqwTSC[nRef] / pXR->dblTSCNominal;
+        sy += (double)pXR->rgSample[i].rgqwTicks[nRef] / grgdblXRefFreq[nRef];
+    }
+
+    mx = sx / n;
+    my = sy / n;
+
+    for (uint32_t i = first; i < last; i++)
+    {
+        double x = (double)pXR->rgSample[i].rgqwTSC[nRef] / pXR->dblTSCNominal - mx;
+        double y = (double)pXR->rgSample[i].rgqwTicks[nRef] / grgdblXRefFreq[nRef] - my;
+
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    rgdblFit[1] = 0.0 != sxx ? sxy / sxx : 1.0;
+    rgdblFit[0] = my - rgdblFit[1] * mx;
+}
+
+/**
+  Residual of sample "idx" to the fit of reference "nRef" in seconds, valid after CrossRefAnalyze()
+
+**/
+double CrossRefResidual(XREF_RESULT* pXR, int nRef, uint32_t idx)
+{
+    double x = (double)pXR->rgSample[idx].rgqwTSC[nRef] / pXR->dblTSCNominal;
+    double y = (double)pXR->rgSample[idx].rgqwTicks[nRef] / grgdblXRefFreq[nRef];
+
+    return y - (pXR->rgdblFit[nRef][0] + pXR->rgdblFit[nRef][1] * x);
+}
+
+/**
+  Get frequency ratio, ratio drift, jitter and calibration time from the samples
+
+  The ratio drift compares the ratio of the first and the second half of the samples.
+  The calibration time is the time a two point calibration needs to get below
+  XREF_PPM_TARGET with the measured jitter at both ends.
+
+  @param  pXR           cross-reference state, 4 samples at least
+
+**/
+void CrossRefAnalyze(XREF_RESULT* pXR)
+{
+    uint32_t cnt = pXR->cntSamples, half = cnt / 2;
+    double rgdblHalf[2][XREF_NUMREF][2], dblSum;
+
+    if (cnt < 4)
+        return;
+
+    pXR->dblSeconds = (double)pXR->rgSample[cnt - 1].rgqwTSC[XREF_REF_ACPI] / pXR->dblTSCNominal;
+
+    for (int n = 0; n < XREF_NUMREF; n++)
+    {
+        CrossRefFit(pXR, n, 0, cnt, pXR->rgdblFit[n]);
+        CrossRefFit(pXR, n, 0, half, rgdblHalf[0][n]);
+        CrossRefFit(pXR, n, half, cnt, rgdblHalf[1][n]);
+
+        pXR->rgdblHz[n] = pXR->rgdblFit[n][1] * grgdblXRefFreq[n];
+
+        dblSum = 0.0;
+        for (uint32_t i = 0; i < cnt; i++)
+            dblSum += CrossRefResidual(pXR, n, i) * CrossRefResidual(pXR, n, i);
+        pXR->rgdblJitter[n] = sqrt(dblSum / cnt);
+
+        pXR->rgdblCalSec[n] = sqrt(2.0) * pXR->rgdblJitter[n] / (XREF_PPM_TARGET * 1e-6);
+    }
+
+    pXR->dblRatio = pXR->rgdblHz[XREF_REF_ACPI] / pXR->rgdblHz[XREF_REF_PIT];
+    pXR->dblRatioPpm = (pXR->dblRatio / XREF_RATIO_NOMINAL - 1.0) * 1e6;
+
+    //
+    // ratio drift, the halves are dblSeconds / 2 apart
+    //
+    pXR->dblRatioDrift = (rgdblHalf[1][XREF_REF_ACPI][1] / rgdblHalf[1][XREF_REF_PIT][1] - rgdblHalf[0][XREF_REF_ACPI][1] / rgdblHalf[0][XREF_REF_PIT][1]) * 1e6 / (pXR->dblSeconds / 2);
+
+    dblSum = 0.0;
+    for (uint32_t i = 0; i < cnt; i++)
+    {
+        double d = CrossRefResidual(pXR, XREF_REF_ACPI, i) - CrossRefResidual(pXR, XREF_REF_PIT, i);
+        dblSum += d * d;
+    }
+    pXR->dblJitterRel = sqrt(dblSum / cnt);
+
+    pXR->nRecommended = pXR->rgdblJitter[XREF_REF_PIT] < pXR->rgdblJitter[XREF_REF_ACPI] ? XREF_REF_PIT : XREF_REF_ACPI;
+}
@@ -0,0 +1,97 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    CrossRef.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    simultaneous ACPI timer vs. PIT cross-reference, frequency ratio, ratio drift and jitter
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CROSSREF_H_
+#define _CROSSREF_H_
+
+#include <stdint.h>
+
+//
+// NOTE:    ACPI timer and PIT are read alternately in one loop, each read is TSC stamped.
+//          Both are expected to derive from the 14.31818MHz crystal, / 4 and / 12, the
+//          ACPI:PIT frequency ratio is 3. The frequency of each reference on TSC time scale
+//          is the slope of a least squares fit, the jitter is the RMS residual of that fit.
+//
+#define XREF_ACPI_FREQ      3579545.0                   // ACPI timer frequency
+#define XREF_PIT_FREQ       1193181.666                 // PIT i8254 frequency, 14.31818MHz / 12
+#define XREF_RATIO_NOMINAL  3.0                         // ACPI:PIT
+#define XREF_SAMPLE_TICKS   35795                       // one sample every ~10ms of ACPI time
+#define XREF_PPM_TARGET     0.1                         // calibration time is given for this resolution
+
+#define XREF_WIDTH_MS       500                         // max. time interrupts are disabled at once
+#define XREF_DFLT_SECONDS   20                          // default run time in seconds
+#define XREF_MAXSAMPLES     12000                       // 120s at XREF_SAMPLE_TICKS
+
+#define XREF_REF_ACPI       0
+#define XREF_REF_PIT        1
+#define XREF_NUMREF         2
+
+typedef struct _XREF_SAMPLE {
+    uint64_t rgqwTSC[XREF_NUMREF];                      // TSC at read, relative to start
+    uint64_t rgqwTicks[XREF_NUMREF];                    // ticks since start
+}XREF_SAMPLE;
+
+typedef struct _XREF_RESULT {
+    double dblTSCNominal;                               // nominal TSC frequency, TSC time scale
+    //
+    // capture state, preserved between two CrossRefCapture() calls
+    //
+    uint64_t qwTSCStart;                                // TSC at start
+    uint64_t rgqwTSCPrev[XREF_NUMREF];                  // TSC at previous read
+    uint64_t rgqwTicks[XREF_NUMREF];                    // ticks since start
+    uint32_t dwAcpiPrev;                                // ACPI counter at previous read
+    uint16_t wPitPrev;                                  // PIT counter at previous read
+    uint64_t qwAcpiGrid;                                // next sample
+    uint64_t cntReads;                                  // number of ACPI/PIT read pairs
+    //
+    // analysis, CrossRefAnalyze()
+    //
+    double dblSeconds;                                  // run time, TSC time scale
+    double rgdblHz[XREF_NUMREF];                        // reference frequency, TSC time scale
+    double rgdblJitter[XREF_NUMREF];                    // RMS residual vs. TSC in seconds
+    double rgdblCalSec[XREF_NUMREF];                    // calibration time for XREF_PPM_TARGET
+    double rgdblFit[XREF_NUMREF][2];                    // reference seconds = [0] + [1] * TSC seconds
+    double dblRatio;                                    // ACPI:PIT frequency ratio
+    double dblRatioPpm;                                 // deviation from XREF_RATIO_NOMINAL
+    double dblRatioDrift;                               // ratio change in ppm per second, 1st vs. 2nd half
+    double dblJitterRel;                                // RMS of ACPI minus PIT residual in seconds
+    int nRecommended;                                   // XREF_REF_..., lower jitter
+    uint32_t cntSamples;
+    XREF_SAMPLE rgSample[XREF_MAXSAMPLES];
+}XREF_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const char* grgstrXRefName[XREF_NUMREF];
+
+void CrossRefInit(XREF_RESULT* pXR, double dblTSCNominal);
+uint64_t CrossRefCapture(XREF_RESULT* pXR, uint64_t qwTSCWidth);
+void CrossRefAnalyze(XREF_RESULT* pXR);
+double CrossRefResidual(XREF_RESULT* pXR, int nRef, uint32_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_CROSSREF_H_
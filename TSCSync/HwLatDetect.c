@@ -0,0 +1,149 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    HwLatDetect.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    hardware latency (SMI/stall) detector, firmware equivalent of Linux hwlatdetect
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <intrin.h>
+#include "HwLatDetect.h"
+#include "TscPolicy.h"
+
+static const uint32_t grgdwHwLatBinScale[HWLAT_NUMBINS] = HWLAT_BINSCALE;
+
+/**
+  Initialize the detector result before the first HwLatDetect() call
+
+  @param  pResult       result buffer
+  @param  qwTSCPerUs    TSC ticks per microsecond
+  @param  dwThresholdUs gaps above this value are recorded, histogram bins are scaled from it
+  @param  fSMICount     MSR_SMI_COUNT is available (Intel only)
+
+**/
+void HwLatDetectInit(HWLAT_RESULT* pResult, uint64_t qwTSCPerUs, uint32_t dwThresholdUs, int fSMICount)
+{
+    memset(pResult, 0, sizeof(HWLAT_RESULT));
+
+    pResult->qwTSCPerUs = qwTSCPerUs;
+    pResult->qwTSCThreshold = qwTSCPerUs * dwThresholdUs;
+    pResult->dwThresholdUs = dwThresholdUs;
+    pResult->fSMICount = fSMICount;
+
+    for (int i = 0; i < HWLAT_NUMBINS; i++)
+    {
+        pResult->rgdwBinLimitUs[i] = dwThresholdUs * grgdwHwLatBinScale[i];
+        pResult->rgqwTSCBinLimit[i] = qwTSCPerUs * pResult->rgdwBinLimitUs[i];
+    }
+}
+
+/**
+  Spin reading TSC with interrupts disabled and record each gap between two
+  consecutive reads that exceeds the threshold.
+
+  Nothing but "read TSC, compare" is done in the hot path. Gap bookkeeping,
+  including the MSR_SMI_COUNT read, is excluded from the next gap by taking
+  a fresh TSC afterwards.
+
+  HwLatDetect() can be called repeatedly, results are accumulated.
+
+  @param  pResult       result buffer, initialized by HwLatDetectInit()
+  @param  qwTSCWidth    time to spin in TSC ticks
+
+  @retval number of gaps above threshold found in this call
+
+**/
+uint64_t HwLatDetect(HWLAT_RESULT* pResult, uint64_t qwTSCWidth)
+{
+    uint64_t qwTSCNow, qwTSCPrev, qwTSCEnd, qwTSCGap, qwTSCFirst;
+    uint64_t qwTSCThreshold = pResult->qwTSCThreshold;
+    uint64_t cntLoops = 0, cntGaps = 0;
+    uint32_t dwSMIPrev = 0, dwSMINow = 0, dwSMIFirst = 0;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    if (pResult->fSMICount)
+        dwSMIFirst = dwSMIPrev = (uint32_t)__readmsr(MSR_SMI_COUNT);
+
+    qwTSCFirst = qwTSCPrev = ReadTSC();
+
+    if (0 == pResult->qwTSCStart)
+        pResult->qwTSCStart = qwTSCFirst;
+
+    qwTSCEnd = qwTSCFirst + qwTSCWidth;
+
+    do
+    {
+        qwTSCNow = ReadTSC();
+        qwTSCGap = qwTSCNow - qwTSCPrev;
+        cntLoops++;
+
+        if (qwTSCGap > qwTSCThreshold)
+        {
+            int bin;
+
+            if (pResult->fSMICount)
+                dwSMINow = (uint32_t)__readmsr(MSR_SMI_COUNT);
+
+            for (bin = 0; bin < HWLAT_NUMBINS && qwTSCGap >= pResult->rgqwTSCBinLimit[bin]; bin++)
+                ;
+            pResult->rgcntBin[bin]++;
+
+            if (pResult->cntRecorded < HWLAT_MAXGAPS)
+            {
+                HWLAT_GAP* pGap = &pResult->rgGap[pResult->cntRecorded++];
+
+                pGap->qwTSCTimestamp = qwTSCNow - pResult->qwTSCStart;
+                pGap->qwTSCDuration = qwTSCGap;
+                pGap->dwSMIDelta = dwSMINow - dwSMIPrev;
+            }
+
+            if (qwTSCGap > pResult->qwTSCWorst)
+            {
+                pResult->qwTSCWorst = qwTSCGap;
+                pResult->qwTSCWorstTimestamp = qwTSCNow - pResult->qwTSCStart;
+                pResult->dwSMIWorst = dwSMINow - dwSMIPrev;
+            }
+
+            pResult->qwTSCStalled += qwTSCGap;
+            dwSMIPrev = dwSMINow;
+            cntGaps++;
+
+            qwTSCNow = ReadTSC();                       // don't count the bookkeeping
+        }
+
+        qwTSCPrev = qwTSCNow;
+
+    } while (qwTSCNow < qwTSCEnd);
+
+    if (pResult->fSMICount)
+        pResult->dwSMITotal += (uint32_t)__readmsr(MSR_SMI_COUNT) - dwSMIFirst;
+
+    pResult->qwTSCSampled += qwTSCNow - qwTSCFirst;
+    pResult->cntLoops += cntLoops;
+    pResult->cntGaps += cntGaps;
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return cntGaps;
+}
@@ -0,0 +1,79 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    HwLatDetect.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    hardware latency (SMI/stall) detector definitions
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _HWLATDETECT_H_
+#define _HWLATDETECT_H_
+
+#include <stdint.h>
+
+#define MSR_SMI_COUNT       0x34                        // Intel only, number of SMIs since reset
+
+#define HWLAT_MAXGAPS       4096                        // number of gaps recorded in detail, all gaps are counted in histogram
+#define HWLAT_NUMBINS       12                          // number of histogram bins, one additional bin for "above"
+#define HWLAT_WIDTH_MS      500                         // max. time interrupts are disabled at once
+#define HWLAT_DFLT_WINDOW   5000                        // default detection window in ms
+#define HWLAT_DFLT_THRSHLD  10                          // default threshold in us, same as Linux hwlatdetect
+
+//
+// upper limits of the histogram bins as multiple of the threshold, the first bin starts at the threshold
+//
+#define HWLAT_BINSCALE      { 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000 }
+
+typedef struct _HWLAT_GAP {
+    uint64_t qwTSCTimestamp;                            // TSC at end of gap, relative to detection start
+    uint64_t qwTSCDuration;                             // TSC ticks gone through between two consecutive reads
+    uint32_t dwSMIDelta;                                // SMI_COUNT delta since previous gap
+}HWLAT_GAP;
+
+typedef struct _HWLAT_RESULT {
+    uint64_t qwTSCPerUs;                                // TSC ticks per microsecond
+    uint64_t qwTSCThreshold;                            // gap threshold in TSC ticks
+    uint32_t dwThresholdUs;                             // gap threshold in us, lower limit of the first bin
+    uint64_t qwTSCStart;                                // TSC at detection start
+    uint64_t qwTSCSampled;                              // TSC ticks spent with interrupts disabled in detector loop
+    uint64_t qwTSCStalled;                              // sum of all gaps above threshold
+    uint64_t qwTSCWorst;                                // longest gap
+    uint64_t qwTSCWorstTimestamp;                       // timestamp of longest gap
+    uint32_t dwSMIWorst;                                // SMI_COUNT delta of longest gap
+    uint32_t dwSMITotal;                                // SMI_COUNT delta of entire detection
+    int      fSMICount;                                 // MSR_SMI_COUNT available
+    uint64_t cntLoops;                                  // number of TSC reads
+    uint64_t cntGaps;                                   // number of gaps above threshold
+    uint32_t cntRecorded;                               // number of gaps recorded in rgGap[]
+    uint32_t rgdwBinLimitUs[HWLAT_NUMBINS];             // upper limit of each bin in us
+    uint64_t rgqwTSCBinLimit[HWLAT_NUMBINS];            // upper limit of each bin in TSC ticks
+    uint64_t rgcntBin[HWLAT_NUMBINS + 1];               // histogram, last bin counts gaps above all limits
+    HWLAT_GAP rgGap[HWLAT_MAXGAPS];
+}HWLAT_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void HwLatDetectInit(HWLAT_RESULT* pResult, uint64_t qwTSCPerUs, uint32_t dwThresholdUs, int fSMICount);
+uint64_t HwLatDetect(HWLAT_RESULT* pResult, uint64_t qwTSCWidth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_HWLATDETECT_H_
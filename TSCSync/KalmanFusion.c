@@ -0,0 +1,371 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    KalmanFusion.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    Kalman filter TSC frequency/drift estimator fusing ACPI, PIT and RTC observations
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <conio.h>
+#include <intrin.h>
+#include "KalmanFusion.h"
+#include "TscPolicy.h"
+
+extern uint16_t gPmTmrBlkAddr;
+extern uint32_t gCOUNTER_WIDTH;
+extern unsigned GetACPICount(short p);
+
+static const double grgdblKalmanSigma[KF_NUMREF] = { KF_SIGMA_RTC, KF_SIGMA_ACPI, KF_SIGMA_PIT };
+
+/**
+  Initialize the filter before the first KalmanCapture()/KalmanObserve() call
+
+  @param  pKF           filter state
+  @param  dblTSCNominal nominal TSC frequency, e.g. from ACPI calibration
+
+**/
+void KalmanInit(KALMAN_STATE* pKF, double dblTSCNominal)
+{
+    memset(pKF, 0, sizeof(KALMAN_STATE));
+
+    pKF->dblTSCNominal = dblTSCNominal;
+
+    pKF->P[KF_Y][KF_Y] = KF_SIGMA_Y0 * KF_SIGMA_Y0;
+    pKF->P[KF_D][KF_D] = KF_SIGMA_D0 * KF_SIGMA_D0;
+    pKF->P[KF_B_ACPI][KF_B_ACPI] = KF_SIGMA_B0 * KF_SIGMA_B0;
+    pKF->P[KF_B_PIT][KF_B_PIT] = KF_SIGMA_B0 * KF_SIGMA_B0;
+}
+
+/**
+  Time update, propagate state and covariance by dt seconds
+
+  Process noise is the exact discretization of white noise driving TSC frequency,
+  TSC drift and the ACPI/PIT vs. RTC frequency offsets.
+
+**/
+static void KalmanPredict(KALMAN_STATE* pKF, double dt)
+{
+    double F[KF_NSTATE][KF_NSTATE], FP[KF_NSTATE][KF_NSTATE], x[KF_NSTATE];
+    double t2 = dt * dt, t3 = t2 * dt, t4 = t3 * dt, t5 = t4 * dt;
+    int i, j, k;
+
+    memset(F, 0, sizeof(F));
+
+    for (i = 0; i < KF_NSTATE; i++)
+        F[i][i] = 1.0;
+
+    for (i = KF_P_RTC; i <= KF_P_PIT; i++)
+        F[i][KF_Y] = dt, F[i][KF_D] = 0.5 * t2;
+
+    F[KF_P_ACPI][KF_B_ACPI] = -dt;
+    F[KF_P_PIT][KF_B_PIT] = -dt;
+    F[KF_Y][KF_D] = dt;
+
+    //
+    // x = F x, P = F P F'
+    //
+    for (i = 0; i < KF_NSTATE; i++)
+    {
+        x[i] = 0.0;
+
+        for (k = 0; k < KF_NSTATE; k++)
+            x[i] += F[i][k] * pKF->x[k];
+
+        for (j = 0; j < KF_NSTATE; j++)
+        {
+            FP[i][j] = 0.0;
+
+            for (k = 0; k < KF_NSTATE; k++)
+                FP[i][j] += F[i][k] * pKF->P[k][j];
+        }
+    }
+
+    for (i = 0; i < KF_NSTATE; i++)
+    {
+        pKF->x[i] = x[i];
+
+        for (j = 0; j < KF_NSTATE; j++)
+        {
+            pKF->P[i][j] = 0.0;
+
+            for (k = 0; k < KF_NSTATE; k++)
+                pKF->P[i][j] += FP[i][k] * F[j][k];
+        }
+    }
+
+    //
+    // P += Q
+    //
+    for (i = KF_P_RTC; i <= KF_P_PIT; i++)
+    {
+        for (j = KF_P_RTC; j <= KF_P_PIT; j++)
+            pKF->P[i][j] += KF_Q_Y * t3 / 3.0 + KF_Q_D * t5 / 20.0;
+
+        pKF->P[i][KF_Y] += KF_Q_Y * t2 / 2.0 + KF_Q_D * t4 / 8.0;
+        pKF->P[KF_Y][i] += KF_Q_Y * t2 / 2.0 + KF_Q_D * t4 / 8.0;
+        pKF->P[i][KF_D] += KF_Q_D * t3 / 6.0;
+        pKF->P[KF_D][i] += KF_Q_D * t3 / 6.0;
+    }
+
+    pKF->P[KF_Y][KF_Y] += KF_Q_Y * dt + KF_Q_D * t3 / 3.0;
+    pKF->P[KF_Y][KF_D] += KF_Q_D * t2 / 2.0;
+    pKF->P[KF_D][KF_Y] += KF_Q_D * t2 / 2.0;
+    pKF->P[KF_D][KF_D] += KF_Q_D * dt;
+
+    pKF->P[KF_P_ACPI][KF_P_ACPI] += KF_Q_B * t3 / 3.0;
+    pKF->P[KF_P_ACPI][KF_B_ACPI] -= KF_Q_B * t2 / 2.0;
+    pKF->P[KF_B_ACPI][KF_P_ACPI] -= KF_Q_B * t2 / 2.0;
+    pKF->P[KF_B_ACPI][KF_B_ACPI] += KF_Q_B * dt;
+
+    pKF->P[KF_P_PIT][KF_P_PIT] += KF_Q_B * t3 / 3.0;
+    pKF->P[KF_P_PIT][KF_B_PIT] -= KF_Q_B * t2 / 2.0;
+    pKF->P[KF_B_PIT][KF_P_PIT] -= KF_Q_B * t2 / 2.0;
+    pKF->P[KF_B_PIT][KF_B_PIT] += KF_Q_B * dt;
+
+    pKF->dblTime += dt;
+}
+
+/**
+  Fuse one reference observation
+
+  The observation is the TSC count at a known reference time. The measurement
+  is z = TSC time - reference time, H selects the phase state of the reference.
+  The first observation of a reference initializes its phase.
+  The covariance update uses the Joseph form to stay symmetric positive definite.
+
+  @param  pKF           filter state
+  @param  nRef          KF_REF_RTC, KF_REF_ACPI, KF_REF_PIT
+  @param  dblRefTime    reference time in seconds since the reference's first observation
+  @param  qwTSC         TSC count since start
+
+**/
+void KalmanObserve(KALMAN_STATE* pKF, int nRef, double dblRefTime, uint64_t qwTSC)
+{
+    double dblTau = (double)qwTSC / pKF->dblTSCNominal;
+    double z = dblTau - dblRefTime;
+    double R = grgdblKalmanSigma[nRef] * grgdblKalmanSigma[nRef];
+    double K[KF_NSTATE], AP[KF_NSTATE][KF_NSTATE], S, dblInnov;
+    int i, j;
+
+    if (dblTau > pKF->dblTime)
+        KalmanPredict(pKF, dblTau - pKF->dblTime);
+
+    pKF->rgcntObs[nRef]++;
+
+    if (0 == pKF->rgfInit[nRef])
+    {
+        for (i = 0; i < KF_NSTATE; i++)
+            pKF->P[i][nRef] = pKF->P[nRef][i] = 0.0;
+
+        pKF->x[nRef] = z;
+        pKF->P[nRef][nRef] = R;
+        pKF->rgfInit[nRef] = 1;
+        return;
+    }
+
+    S = pKF->P[nRef][nRef] + R;
+    dblInnov = z - pKF->x[nRef];
+
+    for (i = 0; i < KF_NSTATE; i++)
+    {
+        K[i] = pKF->P[i][nRef] / S;
+        pKF->x[i] += K[i] * dblInnov;
+    }
+
+    //
+    // P = (I - K H) P (I - K H)' + K R K'
+    //
+    for (i = 0; i < KF_NSTATE; i++)
+        for (j = 0; j < KF_NSTATE; j++)
+            AP[i][j] = pKF->P[i][j] - K[i] * pKF->P[nRef][j];
+
+    for (i = 0; i < KF_NSTATE; i++)
+        for (j = 0; j < KF_NSTATE; j++)
+            pKF->P[i][j] = AP[i][j] - AP[i][nRef] * K[j] + R * K[i] * K[j];
+}
+
+/**
+  Current best estimate with standard deviations
+
+  @param  pKF           filter state
+  @param  pEst          estimate
+
+**/
+void KalmanEstimate(KALMAN_STATE* pKF, KALMAN_ESTIMATE* pEst)
+{
+    double F0 = pKF->dblTSCNominal;
+    double(*P)[KF_NSTATE] = pKF->P;
+
+    pEst->dblTime = pKF->dblTime;
+    pEst->dblTSCPerSec = F0 * (1.0 + pKF->x[KF_Y]);
+    pEst->dblTSCPerSecSigma = F0 * sqrt(P[KF_Y][KF_Y]);
+    pEst->dblTSCPerSecACPI = F0 * (1.0 + pKF->x[KF_Y] - pKF->x[KF_B_ACPI]);
+    pEst->dblTSCPerSecACPISigma = F0 * sqrt(fabs(P[KF_Y][KF_Y] + P[KF_B_ACPI][KF_B_ACPI] - 2.0 * P[KF_Y][KF_B_ACPI]));
+    pEst->dblACPIvsRTC = pKF->x[KF_B_ACPI];
+    pEst->dblACPIvsRTCSigma = sqrt(P[KF_B_ACPI][KF_B_ACPI]);
+    pEst->dblPITvsRTC = pKF->x[KF_B_PIT];
+    pEst->dblPITvsRTCSigma = sqrt(P[KF_B_PIT][KF_B_PIT]);
+    pEst->dblDrift = pKF->x[KF_D];
+    pEst->dblDriftSigma = sqrt(P[KF_D][KF_D]);
+}
+
+/**
+  Read PIT i8254 timer 2, programmed to MODE 2, 65536 by main()
+
+**/
+static uint16_t KalmanPitRead(void)
+{
+    uint8_t counterLoHi[2];
+
+    _outp(0x43, (2/*TIMER*/ << 6) + 0x0);                           // counter latch timer 2
+    counterLoHi[0] = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get low byte
+    counterLoHi[1] = (uint8_t)_inp(0x40 + 2/*TIMER*/);              // get high byte
+
+    return *(uint16_t*)&counterLoHi[0];
+}
+
+/**
+  Resolve counter wrap arounds by the number of ticks expected from the TSC
+
+  @param  qwDelta       counter difference modulo qwModulus
+  @param  qwModulus     counter modulus
+  @param  dblExpected   number of ticks expected from the TSC
+
+  @retval number of ticks gone through
+
+**/
+static uint64_t KalmanUnwrap(uint64_t qwDelta, uint64_t qwModulus, double dblExpected)
+{
+    double k = floor((dblExpected - (double)qwDelta) / (double)qwModulus + 0.5);
+
+    return qwDelta + (k > 0.0 ? (uint64_t)k * qwModulus : 0);
+}
+
+/**
+  Poll ACPI timer, PIT and RTC with interrupts disabled and fuse each observation
+
+  ACPI is read in every loop, observed every KF_ACPI_TICKS. PIT and RTC are read
+  in every 4th loop, alternately. PIT is observed every KF_PIT_TICKS, RTC on the
+  falling edge of UIP (update in progress), once per second.
+
+  Counter wrap arounds and RTC seconds gone through during the pause between
+  two calls are resolved by the TSC, so KalmanCapture() can be called repeatedly
+  to update the screen in between. A convergence history entry is added per call.
+
+  @param  pKF           filter state, initialized by KalmanInit()
+  @param  qwTSCWidth    time to poll in TSC ticks
+
+  @retval number of observations fused in this call
+
+**/
+uint64_t KalmanCapture(KALMAN_STATE* pKF, uint64_t qwTSCWidth)
+{
+    uint32_t COUNTER_MASK = (uint32_t)((1ULL << gCOUNTER_WIDTH) - 1);
+    double dblTSCPerAcpiTick = pKF->dblTSCNominal / KF_ACPI_FREQ;
+    double dblTSCPerPitTick = pKF->dblTSCNominal / KF_PIT_FREQ;
+    uint64_t qwTSC, qwTSCEnd, cntObs = 0;
+    uint32_t i = 0;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    _outp(0x70, 0x0A);                                  // RTC Register A
+
+    if (0 == pKF->qwTSCStart)
+    {
+        pKF->dwAcpiPrev = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+        pKF->qwTSCStart = pKF->qwTSCAcpiPrev = ReadTSC();
+        pKF->wPitPrev = KalmanPitRead();
+        pKF->qwTSCPitPrev = ReadTSC();
+        pKF->qwAcpiGrid = KF_ACPI_TICKS;
+        pKF->qwPitGrid = KF_PIT_TICKS;
+    }
+
+    pKF->fRtcUIP = 0x80 & _inp(0x71);                   // don't take an edge during the pause
+
+    qwTSCEnd = ReadTSC() + qwTSCWidth;
+
+    do
+    {
+        uint32_t dwAcpi = COUNTER_MASK & GetACPICount(gPmTmrBlkAddr);
+
+        qwTSC = ReadTSC();
+
+        pKF->qwAcpiTicks += KalmanUnwrap(COUNTER_MASK & (dwAcpi - pKF->dwAcpiPrev), COUNTER_MASK + 1ULL, (qwTSC - pKF->qwTSCAcpiPrev) / dblTSCPerAcpiTick);
+        pKF->dwAcpiPrev = dwAcpi;
+        pKF->qwTSCAcpiPrev = qwTSC;
+
+        if (pKF->qwAcpiTicks >= pKF->qwAcpiGrid)
+        {
+            KalmanObserve(pKF, KF_REF_ACPI, pKF->qwAcpiTicks / KF_ACPI_FREQ, qwTSC - pKF->qwTSCStart);
+            pKF->qwAcpiGrid = pKF->qwAcpiTicks - pKF->qwAcpiTicks % KF_ACPI_TICKS + KF_ACPI_TICKS;
+            cntObs++;
+        }
+
+        if (1 == (3 & i))
+        {
+            uint16_t wPit = KalmanPitRead();            // PIT counts down
+
+            qwTSC = ReadTSC();
+
+            pKF->qwPitTicks += KalmanUnwrap((uint16_t)(pKF->wPitPrev - wPit), 0x10000ULL, (qwTSC - pKF->qwTSCPitPrev) / dblTSCPerPitTick);
+            pKF->wPitPrev = wPit;
+            pKF->qwTSCPitPrev = qwTSC;
+
+            if (pKF->qwPitTicks >= pKF->qwPitGrid)
+            {
+                KalmanObserve(pKF, KF_REF_PIT, pKF->qwPitTicks / KF_PIT_FREQ, qwTSC - pKF->qwTSCStart);
+                pKF->qwPitGrid = pKF->qwPitTicks - pKF->qwPitTicks % KF_PIT_TICKS + KF_PIT_TICKS;
+                cntObs++;
+            }
+        }
+
+        if (3 == (3 & i))
+        {
+            int fUIP = 0x80 & _inp(0x71);
+
+            qwTSC = ReadTSC();
+
+            if (0 != pKF->fRtcUIP && 0 == fUIP)         // falling edge, update ended
+            {
+                if (0 != pKF->qwTSCRtcPrev)
+                    pKF->dwRtcSeconds += (uint32_t)((double)(qwTSC - pKF->qwTSCRtcPrev) / pKF->dblTSCNominal + 0.5);
+
+                KalmanObserve(pKF, KF_REF_RTC, (double)pKF->dwRtcSeconds, qwTSC - pKF->qwTSCStart);
+                pKF->qwTSCRtcPrev = qwTSC;
+                cntObs++;
+            }
+            pKF->fRtcUIP = fUIP;
+        }
+
+        i++;
+
+    } while (qwTSC < qwTSCEnd);
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    if (pKF->cntHist < KF_MAXHIST)
+        KalmanEstimate(pKF, &pKF->rgHist[pKF->cntHist++]);
+
+    return cntObs;
+}
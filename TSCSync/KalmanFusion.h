@@ -0,0 +1,132 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    KalmanFusion.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    Kalman filter TSC frequency/drift estimator fusing ACPI, PIT and RTC observations
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _KALMANFUSION_H_
+#define _KALMANFUSION_H_
+
+#include <stdint.h>
+
+//
+// NOTE:    State vector, all phases are TSC time minus reference time in seconds
+//
+//          x[KF_P_RTC]     phase vs. RTC
+//          x[KF_P_ACPI]    phase vs. ACPI timer
+//          x[KF_P_PIT]     phase vs. PIT
+//          x[KF_Y]         TSC fractional frequency offset vs. nominal, on RTC time scale
+//          x[KF_D]         TSC frequency drift in 1/s
+//          x[KF_B_ACPI]    ACPI timer fractional frequency offset vs. RTC
+//          x[KF_B_PIT]     PIT fractional frequency offset vs. RTC
+//
+//          The RTC 32kHz crystal is the long term anchor, ACPI and PIT provide the
+//          high resolution short term observations. Their frequency offset against
+//          the RTC is a random walk, modelling their poor long term stability.
+//
+#define KF_P_RTC            0
+#define KF_P_ACPI           1
+#define KF_P_PIT            2
+#define KF_Y                3
+#define KF_D                4
+#define KF_B_ACPI           5
+#define KF_B_PIT            6
+#define KF_NSTATE           7
+
+#define KF_REF_RTC          KF_P_RTC                    // reference index == phase state index
+#define KF_REF_ACPI         KF_P_ACPI
+#define KF_REF_PIT          KF_P_PIT
+#define KF_NUMREF           3
+
+#define KF_ACPI_FREQ        3579545.0                   // ACPI timer frequency
+#define KF_PIT_FREQ         1193181.666                 // PIT i8254 frequency, 14.31818MHz / 12
+#define KF_ACPI_TICKS       3579                        // ACPI observation every ~1ms
+#define KF_PIT_TICKS        11932                       // PIT observation every ~10ms
+
+#define KF_SIGMA_ACPI       0.5e-6                      // measurement noise in seconds, one tick + read latency
+#define KF_SIGMA_PIT        3.0e-6                      // latch + two 8 bit reads, polled every 4th loop
+#define KF_SIGMA_RTC        3.0e-6                      // UIP falling edge, polled every 4th loop
+#define KF_SIGMA_Y0         1.0e-4                      // initial uncertainty of TSC frequency, 100ppm
+#define KF_SIGMA_D0         1.0e-8                      // initial uncertainty of TSC drift, 1/s
+#define KF_SIGMA_B0         1.0e-4                      // initial uncertainty of ACPI/PIT vs. RTC, 100ppm
+#define KF_Q_Y              1.0e-20                     // TSC frequency random walk, 1/s
+#define KF_Q_D              1.0e-26                     // TSC drift random walk, 1/s^3
+#define KF_Q_B              1.0e-18                     // ACPI/PIT vs. RTC frequency random walk, 1/s
+
+#define KF_WIDTH_MS         500                         // max. time interrupts are disabled at once
+#define KF_DFLT_SECONDS     30                          // default run time in seconds
+#define KF_MAXHIST          7200                        // number of convergence history entries
+
+typedef struct _KALMAN_ESTIMATE {
+    double dblTime;                                     // seconds since start
+    double dblTSCPerSec;                                // TSC frequency, RTC time scale
+    double dblTSCPerSecSigma;
+    double dblTSCPerSecACPI;                            // TSC frequency, ACPI time scale
+    double dblTSCPerSecACPISigma;
+    double dblACPIvsRTC;                                // ACPI vs. RTC fractional frequency offset
+    double dblACPIvsRTCSigma;
+    double dblPITvsRTC;                                 // PIT vs. RTC fractional frequency offset
+    double dblPITvsRTCSigma;
+    double dblDrift;                                    // TSC frequency drift in 1/s
+    double dblDriftSigma;
+}KALMAN_ESTIMATE;
+
+typedef struct _KALMAN_STATE {
+    double dblTSCNominal;                               // nominal TSC frequency the state is relative to
+    double x[KF_NSTATE];                                // state
+    double P[KF_NSTATE][KF_NSTATE];                     // state covariance
+    double dblTime;                                     // TSC time of the state in seconds since start
+    int rgfInit[KF_NUMREF];                             // first observation of reference done
+    uint64_t rgcntObs[KF_NUMREF];                       // number of observations per reference
+    //
+    // capture state, preserved between two KalmanCapture() calls
+    //
+    uint64_t qwTSCStart;                                // TSC at start
+    uint64_t qwTSCAcpiPrev;                             // TSC at previous ACPI read
+    uint32_t dwAcpiPrev;                                // ACPI counter at previous read
+    uint64_t qwAcpiTicks;                               // ACPI ticks since start
+    uint64_t qwAcpiGrid;                                // next ACPI observation
+    uint64_t qwTSCPitPrev;                              // TSC at previous PIT read
+    uint16_t wPitPrev;                                  // PIT counter at previous read
+    uint64_t qwPitTicks;                                // PIT ticks since start
+    uint64_t qwPitGrid;                                 // next PIT observation
+    uint64_t qwTSCRtcPrev;                              // TSC at previous RTC second edge
+    uint32_t dwRtcSeconds;                              // RTC seconds since first edge
+    int fRtcUIP;                                        // RTC update in progress at previous read
+    //
+    // convergence history, one entry per KalmanCapture() call
+    //
+    uint32_t cntHist;
+    KALMAN_ESTIMATE rgHist[KF_MAXHIST];
+}KALMAN_STATE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void KalmanInit(KALMAN_STATE* pKF, double dblTSCNominal);
+void KalmanObserve(KALMAN_STATE* pKF, int nRef, double dblRefTime, uint64_t qwTSC);
+void KalmanEstimate(KALMAN_STATE* pKF, KALMAN_ESTIMATE* pEst);
+uint64_t KalmanCapture(KALMAN_STATE* pKF, uint64_t qwTSCWidth);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_KALMANFUSION_H_
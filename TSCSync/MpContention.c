@@ -0,0 +1,268 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    MpContention.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    multi-core concurrent timer read throughput and port I/O contention benchmark
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <intrin.h>
+#include "MpContention.h"
+#include "TscPolicy.h"
+
+const char* grgstrMpContName[MPCONT_NUMSRC] = {
+    "ACPI PM timer",
+    "PIT latch + 2 reads",
+};
+
+static const double grgdblMpContFreq[MPCONT_NUMSRC] = { 3579545.0, 1193181.666 };
+static const uint32_t grgdwMpContMask[MPCONT_NUMSRC] = { MPCONT_ACPI_MASK, 0xFFFF };
+
+//
+// state of one run, shared by all APs
+//
+typedef struct _MPCONT_RUN {
+    volatile long nTicket;                              // drawn on entry, AP 0 calibrates
+    volatile long nArrived;                             // start barrier
+    volatile long fDone;                                // set by AP 0 or on timeout
+    uint32_t nActive;                                   // requested number of cores
+    int nSrc;
+    double dblTSCPerSec;
+    uint32_t (*pfnRead)(void);
+    MPCONT_CORE rgCore[MPCONT_MAXCPU];
+}MPCONT_RUN;
+
+static MPCONT_RUN gMpContRun;
+
+/**
+  AP procedure, poll the timer until AP 0 has calibrated over MPCONT_CAL_MS
+
+  Runs on APs, no console output, no boot services.
+
+**/
+static void MpContentionProc(void* pArg)
+{
+    MPCONT_RUN* pRun = (MPCONT_RUN*)pArg;
+    uint32_t n = (uint32_t)_InterlockedIncrement(&pRun->nTicket) - 1;
+    double dblTicksPerTSC = grgdblMpContFreq[pRun->nSrc] / pRun->dblTSCPerSec;
+    uint64_t qwCalTicks = (uint64_t)(grgdblMpContFreq[pRun->nSrc] * MPCONT_CAL_MS / 1000);
+    uint64_t qwTimeout = (uint64_t)(pRun->dblTSCPerSec * MPCONT_TIMEOUT_MS / 1000);
+    uint64_t qwTSC, qwTSCFirst, qwTSCPrev, qwTSCGood, qwTSCGoodEnd, qwTSCCalStart = 0, qwTicks;
+    uint64_t cntReads = 0, cntTorn = 0, qwMaxCyc = 0;  // kept local, rgCore[] entries share cache lines
+    uint32_t dw, dwPrev, dwCalStart = 0, dwMask = grgdwMpContMask[pRun->nSrc], cntInRow = 0;
+    MPCONT_CORE* pCore;
+
+    if (n >= pRun->nActive)
+        return;
+
+    pCore = &pRun->rgCore[n];
+
+    _InterlockedIncrement(&pRun->nArrived);
+    while (pRun->nArrived < (long)pRun->nActive)
+        _mm_pause();
+
+    qwTSCGood = ReadTSC();
+    dwPrev = pRun->pfnRead();
+    qwTSCFirst = qwTSCPrev = qwTSCGoodEnd = ReadTSC();
+
+    while (0 == pRun->fDone)
+    {
+        uint64_t qwDelta, qwLo, qwWidth, qwTSCBefore = qwTSCPrev;  // TSC before the read started
+
+        dw = pRun->pfnRead();
+        qwTSC = ReadTSC();
+
+        cntReads++;
+        qwMaxCyc = qwTSC - qwTSCPrev > qwMaxCyc ? qwTSC - qwTSCPrev : qwMaxCyc;
+        qwTSCPrev = qwTSC;
+
+        if (qwTSC - qwTSCFirst > qwTimeout)
+            pRun->fDone = 1;
+
+        //
+        // the ticks since the last good read are between the end of that read and the start of
+        // this one, and the start of that read and the end of this one, unwrapped within that window
+        //
+        qwLo = (uint64_t)((qwTSCBefore - qwTSCGoodEnd) * dblTicksPerTSC);
+        qwWidth = (uint64_t)((qwTSC - qwTSCGood) * dblTicksPerTSC) - qwLo + 2 * MPCONT_TORN_SLACK;
+        qwLo = qwLo > MPCONT_TORN_SLACK ? qwLo - MPCONT_TORN_SLACK : 0;
+        qwDelta = MPCONT_ACPI == pRun->nSrc ? dw - dwPrev : dwPrev - dw;    // PIT counts down
+        qwDelta = qwLo + ((qwDelta - qwLo) & dwMask);
+
+        if (qwWidth <= dwMask / 2 && qwDelta - qwLo > qwWidth && ++cntInRow < MPCONT_TORN_RESYNC)
+        {
+            cntTorn++;                                  // keep the last good read
+            continue;
+        }
+
+        if (qwWidth > dwMask / 2 || 0 != cntInRow)      // can't be checked or torn in a row, take it as is
+        {
+            cntTorn += 0 != cntInRow;
+            qwDelta = 0;                                // unchecked, no calibration edge
+        }
+
+        //
+        // AP 0 calibrates between two checked edges, the ticks in between are unwrapped
+        // around the TSC time gone through, a resync in between doesn't lose ticks. The window
+        // is the uncertainty of an edge, windows longer than 2 average reads are no edge.
+        //
+        if (0 == n && 0 != qwDelta && (qwTSC - qwTSCGood) * cntReads <= 2 * (qwTSC - qwTSCFirst))
+        {
+            if (0 == qwTSCCalStart)                     // first edge
+                qwTSCCalStart = qwTSC, dwCalStart = dw;
+            else if ((qwTicks = (uint64_t)((qwTSC - qwTSCCalStart) * dblTicksPerTSC)) >= qwCalTicks)
+            {
+                qwTicks -= dwMask / 2;
+                qwTicks += ((MPCONT_ACPI == pRun->nSrc ? dw - dwCalStart : dwCalStart - dw) - qwTicks) & dwMask;
+                pCore->dblCalTSCPerSec = (double)(qwTSC - qwTSCCalStart) * grgdblMpContFreq[pRun->nSrc] / (double)qwTicks;
+                pRun->fDone = 1;
+            }
+        }
+
+        dwPrev = dw;
+        qwTSCGood = qwTSCBefore;                        // window of the next read includes this whole read
+        qwTSCGoodEnd = qwTSC;
+        cntInRow = 0;
+    }
+
+    pCore->qwTSCFirst = qwTSCFirst;
+    pCore->cntReads = cntReads;
+    pCore->cntTorn = cntTorn;
+    pCore->qwMaxCyc = qwMaxCyc;
+    pCore->qwTSCLast = qwTSCPrev;
+}
+
+/**
+  Reduce the per core records of one run to a measurement point
+
+**/
+static void MpContentionEvaluate(MPCONT_RUN* pRun, MPCONT_POINT* pPoint)
+{
+    uint64_t qwTSCFirst = (uint64_t)~0, qwTSCLast = 0, qwMaxCyc = 0;
+    double dblLatSum = 0;
+
+    pPoint->nCores = pRun->nActive;
+
+    for (uint32_t i = 0; i < pRun->nActive; i++)
+    {
+        MPCONT_CORE* p = &pRun->rgCore[i];
+
+        pPoint->cntReads += p->cntReads;
+        pPoint->cntTorn += p->cntTorn;
+        qwTSCFirst = p->qwTSCFirst < qwTSCFirst ? p->qwTSCFirst : qwTSCFirst;
+        qwTSCLast = p->qwTSCLast > qwTSCLast ? p->qwTSCLast : qwTSCLast;
+        qwMaxCyc = p->qwMaxCyc > qwMaxCyc ? p->qwMaxCyc : qwMaxCyc;
+
+        if (0 != p->cntReads)
+            dblLatSum += (double)(p->qwTSCLast - p->qwTSCFirst) / (double)p->cntReads;
+    }
+
+    if (qwTSCLast > qwTSCFirst)
+        pPoint->dblReadsPerSec = (double)pPoint->cntReads * pRun->dblTSCPerSec / (double)(qwTSCLast - qwTSCFirst);
+
+    pPoint->dblAvgLatNs = dblLatSum / pRun->nActive * 1e9 / pRun->dblTSCPerSec;
+    pPoint->dblMaxLatNs = (double)qwMaxCyc * 1e9 / pRun->dblTSCPerSec;
+    pPoint->dblCalTSCPerSec = pRun->rgCore[0].dblCalTSCPerSec;
+}
+
+/**
+  Run the timer read loops on 1..N APs concurrently, ACPI PM timer and PIT
+
+  @param  pResult       result, 1..pPlat->nAPs cores per timer
+  @param  pPlat         AP startup and timer read backend, hardware or a simulation
+  @param  dblTSCPerSec  calibrated TSC frequency, time base of latency and throughput
+
+  @retval 0 on success, -1 if no AP is available or an AP startup failed
+
+**/
+int MpContentionRun(MPCONT_RESULT* pResult, const MPCONT_PLATFORM* pPlat, double dblTSCPerSec)
+{
+    memset(pResult, 0, sizeof(MPCONT_RESULT));
+
+    if (0 == pPlat->nAPs || 0 == dblTSCPerSec)
+        return -1;
+
+    pResult->nAPs = pPlat->nAPs < MPCONT_MAXCPU ? pPlat->nAPs : MPCONT_MAXCPU;
+
+    for (int nSrc = 0; nSrc < MPCONT_NUMSRC; nSrc++)
+    {
+        uint32_t (*pfnRead)(void) = MPCONT_ACPI == nSrc ? pPlat->pfnReadAcpi : pPlat->pfnReadPit;
+
+        if (NULL == pfnRead)                            // timer not available on this platform
+            continue;
+
+        pResult->rgfAvailable[nSrc] = 1;
+
+        for (uint32_t nCores = 1; nCores <= pResult->nAPs; nCores++)
+        {
+            MPCONT_POINT* pPoint = &pResult->rgPoint[nSrc][nCores - 1];
+
+            memset(&gMpContRun, 0, sizeof(gMpContRun));
+            gMpContRun.nActive = nCores;
+            gMpContRun.nSrc = nSrc;
+            gMpContRun.dblTSCPerSec = dblTSCPerSec;
+            gMpContRun.pfnRead = pfnRead;
+
+            if (0 != pPlat->pfnStartupAllAPs(MpContentionProc, &gMpContRun))
+                return -1;
+
+            MpContentionEvaluate(&gMpContRun, pPoint);
+
+            if (0 != pResult->rgPoint[nSrc][0].dblCalTSCPerSec && 0 != pPoint->dblCalTSCPerSec)
+                pPoint->dblCalPpm = (pPoint->dblCalTSCPerSec / pResult->rgPoint[nSrc][0].dblCalTSCPerSec - 1.0) * 1e6;
+        }
+
+        if (0 != pResult->rgPoint[nSrc][0].dblReadsPerSec)
+            pResult->rgdblScaling[nSrc] = pResult->rgPoint[nSrc][pResult->nAPs - 1].dblReadsPerSec / pResult->rgPoint[nSrc][0].dblReadsPerSec;
+    }
+
+    pResult->dblTSCPerSec = dblTSCPerSec;
+
+    return 0;
+}
+
+void MpContentionPrintTable(FILE* fp, MPCONT_RESULT* pResult)
+{
+    fprintf(fp, "%-20s %5s %12s %12s %12s %8s %16s %10s\n", "timer", "cores", "reads/s", "avg [ns]", "max [ns]", "torn", "AP 0 TSC [Hz]", "cal. [ppm]");
+
+    for (int n = 0; n < MPCONT_NUMSRC; n++)
+    {
+        if (!pResult->rgfAvailable[n])
+        {
+            fprintf(fp, "%-20s %5s\n", grgstrMpContName[n], "N/A");
+            continue;
+        }
+
+        for (uint32_t i = 0; i < pResult->nAPs; i++)
+        {
+            MPCONT_POINT* p = &pResult->rgPoint[n][i];
+
+            fprintf(fp, "%-20s %5u %12.0f %12.1f %12.1f %8llu %16.0f %10.2f\n", 0 == i ? grgstrMpContName[n] : "", p->nCores, p->dblReadsPerSec, p->dblAvgLatNs, p->dblMaxLatNs, (unsigned long long)p->cntTorn, p->dblCalTSCPerSec, p->dblCalPpm);
+        }
+    }
+
+    fprintf(fp, "aggregate scaling %u vs. 1 core:", pResult->nAPs);
+    for (int n = 0; n < MPCONT_NUMSRC; n++)
+        if (pResult->rgfAvailable[n])
+            fprintf(fp, " %s %.2fx", grgstrMpContName[n], pResult->rgdblScaling[n]);
+        else
+            fprintf(fp, " %s N/A", grgstrMpContName[n]);
+    fprintf(fp, "\n");
+}
@@ -0,0 +1,108 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    MpContention.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    multi-core concurrent timer read throughput and port I/O contention benchmark
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _MPCONTENTION_H_
+#define _MPCONTENTION_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+//
+// NOTE:    1..N APs poll the same legacy timer at the same time. AP 0 calibrates the TSC
+//          over MPCONT_CAL_MS on edges of that timer, the other APs poll until AP 0 has
+//          finished. The APs are started through MPCONT_PLATFORM, EFI_MP_SERVICES_PROTOCOL
+//          StartupAllAPs() on hardware, pthreads with a simulated timer in
+//          Samples/MpContentionSim.c. Each AP draws a ticket on entry, APs with a ticket
+//          beyond the requested number of cores return immediately.
+//          The PIT latch sequence of 3 port accesses is not atomic across cores, a read
+//          that doesn't fit the TSC time gone through is counted as torn and dropped.
+//          The window of a read spans the TSC from the start of the last good read to the
+//          end of this one, its width is the duration of both reads, it doesn't grow with the
+//          time since the last good read. After MPCONT_TORN_RESYNC torn reads in a row, or
+//          a read too long to be checked, the read is taken as the new base. AP 0 calibrates
+//          between two checked edges with a short window, unwrapped around the TSC time.
+//          A source without read function, e.g. no ACPI PM timer in the FADT, is skipped
+//          and reported N/A.
+//
+#define MPCONT_ACPI         0                           // ACPI PM timer, one 32 bit port read
+#define MPCONT_PIT          1                           // PIT timer 2, latch + 2 byte reads
+#define MPCONT_NUMSRC       2
+
+#define MPCONT_MAXCPU       64                          // max. number of APs measured
+#define MPCONT_CAL_MS       100                         // calibration interval of AP 0
+#define MPCONT_TIMEOUT_MS   1000                        // polling ends, if the timer doesn't count
+#define MPCONT_AP_TIMEOUT_US 10000000                   // StartupAllAPs() timeout
+#define MPCONT_ACPI_MASK    0xFFFFFF                    // 24 bit unwrap, fits 32 bit timers too
+#define MPCONT_TORN_SLACK   4                           // ticks beyond the TSC window of a read
+#define MPCONT_TORN_RESYNC  8                           // torn reads in a row to take the counter as is
+
+typedef void (*MPCONT_PROC)(void* pArg);
+
+typedef struct _MPCONT_PLATFORM {
+    uint32_t nAPs;                                      // enabled APs, BSP excluded
+    int (*pfnStartupAllAPs)(MPCONT_PROC pfnProc, void* pArg);   // run on all APs simultaneously, 0 on success
+    uint32_t (*pfnReadAcpi)(void);                      // NULL if N/A
+    uint32_t (*pfnReadPit)(void);                       // NULL if N/A
+}MPCONT_PLATFORM;
+
+typedef struct _MPCONT_CORE {
+    uint64_t cntReads;
+    uint64_t cntTorn;                                   // reads dropped as torn
+    uint64_t qwTSCFirst;                                // TSC at the first and the last read
+    uint64_t qwTSCLast;
+    uint64_t qwMaxCyc;                                  // longest single read
+    double dblCalTSCPerSec;                             // AP 0 only
+}MPCONT_CORE;
+
+typedef struct _MPCONT_POINT {
+    uint32_t nCores;                                    // APs polling concurrently
+    uint64_t cntReads;                                  // all cores
+    uint64_t cntTorn;
+    double dblReadsPerSec;                              // aggregate throughput
+    double dblAvgLatNs;                                 // mean of the per core average read latency
+    double dblMaxLatNs;                                 // longest single read of all cores
+    double dblCalTSCPerSec;                             // AP 0 calibration while the others poll
+    double dblCalPpm;                                   // vs. the single core calibration
+}MPCONT_POINT;
+
+typedef struct _MPCONT_RESULT {
+    double dblTSCPerSec;                                // 0 if not yet run
+    uint32_t nAPs;                                      // 1..nAPs cores measured per source
+    int rgfAvailable[MPCONT_NUMSRC];                    // source measured, N/A otherwise
+    MPCONT_POINT rgPoint[MPCONT_NUMSRC][MPCONT_MAXCPU];
+    double rgdblScaling[MPCONT_NUMSRC];                 // aggregate reads per second nAPs vs. 1 core
+}MPCONT_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const char* grgstrMpContName[MPCONT_NUMSRC];
+
+int MpContentionRun(MPCONT_RESULT* pResult, const MPCONT_PLATFORM* pPlat, double dblTSCPerSec);
+void MpContentionPrintTable(FILE* fp, MPCONT_RESULT* pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_MPCONTENTION_H_
@@ -25,103 +25,8 @@ Author:
 #include <stdlib.h>
 #include <conio.h>
 #include <intrin.h>
-
-extern int gfErrorCorrection;
-
-//int iCPD;
-//typedef struct _CURPREVDIFF {
-//    uint32_t curr;
-//    uint32_t prev;
-//    uint32_t diff;
-//    int32_t delay;
-//}CURPREVDIFF;
-//CURPREVDIFF curprevdiff[65536];
-
-#define COUNTER_WIDTH 16
-__inline uint16_t GetPITCount(void)
-{
-    uint32_t COUNTER_MASK = ((1 << COUNTER_WIDTH) - 1);
-    uint8_t counterLoHi[2];
-    uint16_t* pwCount = (uint16_t*)&counterLoHi[0];
-
-    outp(0x43, (2/*TIMER*/ << 6) + 0x0),                            // counter latch timer 2
-        counterLoHi[0] = (unsigned char)inp(0x40 + 2/*TIMER*/),     // get low byte
-        counterLoHi[1] = (unsigned char)inp(0x40 + 2/*TIMER*/);     // get high byte
-
-    return *pwCount;
-    //return COUNTER_MASK & ~*pwCount;
-}
-
-int64_t PITClkWait/*pseudo delay upcount*/(int32_t Delay)
-{
-    static int cnt;
-    int64_t  delay3 = Delay / 3, count = delay3, maxdrift = 0;
-    uint64_t qwTSCPerIntervall, qwTSCEnd=0, qwTSCStart=0;
-    size_t eflags = __readeflags();                     // save flaags
-    int syncprogress = 1;
-
-    _disable();
-    GetPITCount();
-
-    if (1)
-    {
-        uint16_t previous,current,diff = 0;
-
-        while (syncprogress)
-        {
-            for (int i = 0; i < 5 && syncprogress; i++)
-            {
-                count = delay3 = Delay / 3;
-                previous = GetPITCount();
-                qwTSCStart = __rdtsc();                             // get TSC start
-
-                while (count > 0)
-                {
-                    current = GetPITCount();
-
-                    if (previous >= current)
-                        diff = previous - current;
-                    else
-                        diff = ~(current - previous) + 1;
-
-                    //curprevdiff[iCPD].diff = diff;//kgtest
-                    //curprevdiff[iCPD].curr = current;//kgtest
-                    //curprevdiff[iCPD].prev = previous;//kgtest
-
-                    previous = current;
-
-                    count -= diff;
-
-                    //curprevdiff[iCPD++].delay = delay;//kgtest
-
-                }
-
-                qwTSCEnd = __rdtsc();                           // get TSC end ~50ms
-
-                //if ((count + maxdrift) >= 0)
-                //{
-                    syncprogress = 0;
-                    break;
-                //}
-            }
-            maxdrift++;
-        }
-        printf("%lld       ", -count);                          // Additional ticks gone through: 
-
-        //
-        // subtract the additional number of TSC gone through
-        //
-        if (1 == gfErrorCorrection)
-            qwTSCPerIntervall = ((qwTSCEnd - qwTSCStart) * delay3) / (delay3 - count);    // get number of CPU TSC per 8254 ClkTick (1,19MHz)
-        else
-            qwTSCPerIntervall = qwTSCEnd - qwTSCStart;
-
-        if (0x200 & eflags)                                     // restore IF interrupt flag
-            _enable();
-
-    }
-    return (int64_t)qwTSCPerIntervall;
-}
+#include "ClkWait.h"
+#include "TscPolicy.h"
 
 ///////////////////////////////////////
 extern void _disable(void);
@@ -167,7 +72,7 @@ unsigned long long __osifIbmAtGetTscPer62799(uint32_t delay) {
     outp(0x42, 0xFF);                       // write counter value high 65535
     outp(0x61, 1);                          // start counter
 
-    qwTSCStart = __rdtsc();                 // get TSC start
+    qwTSCStart = ReadTSC();                 // get TSC start
 
     //
     // repeat counter latch command until 50ms
@@ -180,7 +85,7 @@ unsigned long long __osifIbmAtGetTscPer62799(uint32_t delay) {
         //
     } while (*pwCount > (65535 - 62799));                           // until 62799 ticks gone
 
-    qwTSCEnd = __rdtsc();                               // get TSC end ~50ms
+    qwTSCEnd = ReadTSC();                               // get TSC end ~50ms
 
     *pwCount = 65535 - *pwCount;                        // get true, not inverted, number of clock ticks...
     // ... that really happened
@@ -208,4 +113,107 @@ unsigned long long __osifIbmAtGetTscPer62799(uint32_t delay) {
         _enable();
 
     return 1 * (qwTSCEnd - qwTSCStart - qwTSCDrift);   // subtract the drift from TSC difference, scale to 1 second
-}
\ No newline at end of file
+}
+
+/**
+  Get the PIT reload value for an OUT2 edge counted interval
+
+  The reload is the largest divisor of "Ticks" that fits into 16 bit, the interval is
+  then exactly "Ticks" / reload OUT2 periods.
+
+  @param  Ticks         PIT ticks to wait
+  @param  pcntEdges     number of OUT2 periods
+
+  @retval reload value, 0 if "Ticks" has no divisor in PIT_OUT2_MINRELOAD..65535
+
+**/
+static uint32_t PITOut2Reload(uint32_t Ticks, uint32_t* pcntEdges)
+{
+    for (uint32_t k = (Ticks + 65534) / 65535; k <= Ticks / PIT_OUT2_MINRELOAD; k++)
+    {
+        if (0 == Ticks % k)
+        {
+            *pcntEdges = k;
+            return Ticks / k;
+        }
+    }
+    return 0;
+}
+
+/**
+  Wait "Delay" ACPI ticks, Delay / 3 PIT ticks, by counting OUT2 edges and return the number of TSC gone through
+
+  Channel 2 is programmed for MODE 3, square wave, with an exact reload. Each rising edge of OUT2,
+  polled in port 0x61 bit 5 by a single read, marks the end of a reload period. Compared to
+  PITClkWait() counter latch + 2 reads per iteration, the edge is detected with a third of
+  the I/O cost. The start is synchronized to a rising edge too, there is no overshoot to correct.
+
+  Channel 2 is reprogrammed to free running MODE 2 afterwards, as expected by PITClkWait().
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, number of port 0x61 reads, reload in dwMaxStep, may be NULL
+
+  @retval number of TSC per "Delay", PITClkWait() result if "Delay" / 3 can't be built from reload periods
+
+**/
+int64_t PITOut2ClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    uint32_t Ticks = Delay / 3, cntEdges = 0, cntReads = 0, dwReload;
+    uint64_t qwTSCStart, qwTSCEnd;
+    int out2, out2Prev;
+    size_t eflags = __readeflags();                     // save flaags
+
+    dwReload = PITOut2Reload(Ticks, &cntEdges);
+
+    if (0 == dwReload)
+        return PITClkWait(Delay, pDiag);
+
+    _disable();
+
+    outp(0x61, 0);                                      // stop counter
+    outp(0x43, (TIMER << 6) + 0x36);                    // program timer 2 for MODE 3
+    outp(0x42, 0xFF & dwReload);                        // write counter value low
+    outp(0x42, 0xFF & (dwReload >> 8));                 // write counter value high
+    outp(0x61, 1);                                      // start counter, OUT2 is high
+
+    //
+    // synchronize to the first rising edge
+    //
+    while (0 != (0x20 & inp(0x61)))
+        ;
+    while (0 == (0x20 & inp(0x61)))
+        ;
+    qwTSCStart = ReadTSC();                             // get TSC start
+
+    for (out2Prev = 0x20; 0 != cntEdges; out2Prev = out2)
+    {
+        out2 = 0x20 & inp(0x61);
+        cntEdges -= (0 == out2Prev && 0 != out2);       // count rising edges
+        cntReads++;
+    }
+
+    qwTSCEnd = ReadTSC();                               // get TSC end
+
+    outp(0x61, 0);                                      // stop counter
+    outp(0x43, (TIMER << 6) + 0x34);                    // program timer 2 for MODE 2
+    outp(0x42, 0x0);                                    // write counter value low 65536
+    outp(0x42, 0x0);                                    // write counter value high 65536
+    outp(0x61, 1);                                      // start counter
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    if (NULL != pDiag)
+    {
+        pDiag->qwOvershoot = 0;
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads;
+        pDiag->dwMaxStep = dwReload;
+        pDiag->cntGlitch = 0;
+        pDiag->cntSegments = 1;
+        pDiag->cntWrapLost = 0;
+        pDiag->qwTSCWindowMax = 0;
+    }
+
+    return (int64_t)(qwTSCEnd - qwTSCStart);
+}
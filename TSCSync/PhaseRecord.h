@@ -0,0 +1,64 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    PhaseRecord.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    continuous TSC vs. reference counter phase record
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _PHASERECORD_H_
+#define _PHASERECORD_H_
+
+#include <stdint.h>
+
+#define PHASE_MAXNUM        (4 * 1024 * 1024)           // max. number of samples in a phase record, 32MB
+#define PHASE_ACPI_TAU0     3579                        // default sample interval in ACPI ticks, ~1ms
+#define PHASE_ACPI_FREQ     3579545.0                   // ACPI timer frequency
+
+//
+// NOTE:    rgqwTSC[n] holds the TSC at reference counter grid point n * dwTicksPerSample,
+//          relative to rgqwTSC[0]. The TSC at a grid point is interpolated between
+//          the two consecutive reads that enclose the grid point.
+//          Capture can be split into multiple calls, e.g. to update the screen in between.
+//          Continuity is kept as long as the pause between two calls is shorter than
+//          the reference counter wrap around time.
+//
+typedef struct _PHASE_RECORD {
+    uint32_t dwTicksPerSample;                          // reference ticks per sample, tau0
+    uint32_t cntMax;                                    // number of entries in rgqwTSC
+    uint32_t cnt;                                       // number of samples captured
+    uint64_t* rgqwTSC;                                  // TSC at each grid point relative to first sample
+    //
+    // capture state, preserved between two calls
+    //
+    uint64_t qwTSCStart;                                // TSC at first grid point
+    uint64_t qwTSCPrev;                                 // TSC at previous read
+    uint64_t qwTicks;                                   // reference ticks since first grid point
+    uint32_t dwCountPrev;                               // reference counter at previous read
+}PHASE_RECORD;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t AcpiPhaseCapture(PHASE_RECORD* pRec, uint32_t cntSamples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_PHASERECORD_H_
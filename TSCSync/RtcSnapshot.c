@@ -0,0 +1,117 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    RtcSnapshot.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    atomic RTC time snapshot with TSC stamp
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+#include <stdint.h>
+#include <conio.h>
+#include <intrin.h>
+#include "RtcSnapshot.h"
+#include "TscPolicy.h"
+
+static uint8_t RtcInp(uint16_t wPort)
+{
+    return (uint8_t)_inp(wPort);
+}
+
+static void RtcOutp(uint16_t wPort, uint8_t bData)
+{
+    _outp(wPort, bData);
+}
+
+static const RTC_SNAPSHOT_IO gRtcSnapIo = { RtcInp, RtcOutp };
+
+static __inline uint8_t RtcRead(const RTC_SNAPSHOT_IO* pIo, uint8_t idx)
+{
+    pIo->pfnOutp(RTC_INDEX, idx);
+    return pIo->pfnInp(RTC_DATA);
+}
+
+/**
+  Read seconds, minutes and hours in one UIP safe window, the date optionally
+
+  The TSC is taken at the seconds register read, so the snapshot can be related
+  to TSC time without the latency of the remaining reads. The date is read only
+  if requested, the drift test needs hh:mm:ss only.
+
+  @param  pSnap         snapshot
+  @param  pDate         day, month, year and register B in the same window, NULL if not needed
+  @param  pIo           port backend
+
+  @retval 0 on success, -1 if no consistent window was found within RTC_SNAP_MAXTRIES
+
+**/
+int RtcSnapshotReadIo(RTC_SNAPSHOT* pSnap, RTC_SNAPSHOT_DATE* pDate, const RTC_SNAPSHOT_IO* pIo)
+{
+    size_t eflags = __readeflags();                     // save flags
+    int nRet = -1;
+
+    for (pSnap->cntTries = 1; pSnap->cntTries <= RTC_SNAP_MAXTRIES; pSnap->cntTries++)
+    {
+        //
+        // UIP is polled outside the interrupt disabled window, an update takes up to 2ms
+        //
+        while (RTC_UIP & RtcRead(pIo, RTC_REG_A))
+            _mm_pause();
+
+        _disable();
+
+        if (0 == (RTC_UIP & RtcRead(pIo, RTC_REG_A)))
+        {
+            pSnap->qwTSC = ReadTSC();
+            pSnap->bSec = RtcRead(pIo, RTC_REG_SEC);
+            pSnap->bMin = RtcRead(pIo, RTC_REG_MIN);
+            pSnap->bHour = RtcRead(pIo, RTC_REG_HOUR);
+
+            if (NULL != pDate)
+            {
+                pDate->bDay = RtcRead(pIo, RTC_REG_DAY);
+                pDate->bMonth = RtcRead(pIo, RTC_REG_MONTH);
+                pDate->bYear = RtcRead(pIo, RTC_REG_YEAR);
+                pDate->bRegB = RtcRead(pIo, RTC_REG_B);
+            }
+
+            if (0 == (RTC_UIP & RtcRead(pIo, RTC_REG_A)) && pSnap->bSec == RtcRead(pIo, RTC_REG_SEC))
+                nRet = 0;
+        }
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        if (0 == nRet)
+            break;
+    }
+
+    return nRet;
+}
+
+/**
+  Read seconds, minutes and hours in one UIP safe window from the RTC ports
+
+  @param  pSnap         snapshot
+
+  @retval 0 on success, -1 if no consistent window was found within RTC_SNAP_MAXTRIES
+
+**/
+int RtcSnapshotRead(RTC_SNAPSHOT* pSnap)
+{
+    return RtcSnapshotReadIo(pSnap, NULL, &gRtcSnapIo);
+}
@@ -0,0 +1,79 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    RtcSnapshot.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    atomic RTC time snapshot with TSC stamp
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _RTCSNAPSHOT_H_
+#define _RTCSNAPSHOT_H_
+
+#include <stdint.h>
+
+//
+// NOTE:    The MC146818 compatible RTC guarantees 244us between UIP going 1 and the
+//          update of the time registers. The time registers are read in one window after
+//          UIP was seen 0, with interrupts disabled and without 0xED IODELAY writes.
+//          The window is repeated until UIP is still 0 and the seconds register did
+//          not change, so an SMI in the window can't produce a torn hh:mm:ss.
+//
+#define RTC_INDEX           0x70
+#define RTC_DATA            0x71
+#define RTC_REG_SEC         0x00
+#define RTC_REG_MIN         0x02
+#define RTC_REG_HOUR        0x04
+#define RTC_REG_DAY         0x07
+#define RTC_REG_MONTH       0x08
+#define RTC_REG_YEAR        0x09
+#define RTC_REG_A           0x0A                        // bit 7 UIP, update in progress
+#define RTC_REG_B           0x0B                        // bit 2 DM binary, bit 1 24h
+#define RTC_UIP             0x80
+#define RTC_SNAP_MAXTRIES   16                          // 16 windows fail on a broken RTC only
+
+typedef struct _RTC_SNAPSHOT {
+    uint8_t bSec;                                       // raw register content, BCD unless RTC_REG_B bit 2
+    uint8_t bMin;
+    uint8_t bHour;
+    uint32_t cntTries;                                  // windows needed
+    uint64_t qwTSC;                                     // TSC at the seconds register read
+}RTC_SNAPSHOT;
+
+typedef struct _RTC_SNAPSHOT_DATE {
+    uint8_t bDay;                                       // raw register content as RTC_SNAPSHOT
+    uint8_t bMonth;
+    uint8_t bYear;
+    uint8_t bRegB;
+}RTC_SNAPSHOT_DATE;
+
+typedef struct _RTC_SNAPSHOT_IO {
+    uint8_t (*pfnInp)(uint16_t wPort);
+    void (*pfnOutp)(uint16_t wPort, uint8_t bData);
+}RTC_SNAPSHOT_IO;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int RtcSnapshotRead(RTC_SNAPSHOT* pSnap);
+int RtcSnapshotReadIo(RTC_SNAPSHOT* pSnap, RTC_SNAPSHOT_DATE* pDate, const RTC_SNAPSHOT_IO* pIo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_RTCSNAPSHOT_H_
@@ -0,0 +1,232 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    BenchSim.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    simulated port backend for the timer read primitives benchmark of ../Bench.c
+
+    The ACPI PM timer, the PIT and the RTC are port I/O on CLOCK_MONOTONIC and the
+    host time, -ILinux maps conio.h to the port functions below. There is no local APIC
+    and no X_PM_TMR_BLK in SystemMemory, both rows are skipped. The ACPI wait rows run
+    the real loops of ../AcpiClkWait.c and ../ClkWaitKernel.cpp on the simulated timer.
+    Build on Linux with ../Bench.c ../RtcSnapshot.c ../AcpiClkWait.c ../ClkWaitKernel.cpp,
+    -ILinux. Table to stdout, CSV to SIM_FILENAME, returns 0 on success.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <conio.h>
+#include <intrin.h>
+#include "../Bench.h"
+#include "../ClkWait.h"
+#include "../ApicTimer.h"
+#include "../RtcSnapshot.h"
+
+#define SIM_PMTMR           0x1808                      // PM_TMR_BLK
+#define SIM_ACPI_FREQ       3579545ULL
+#define SIM_PIT_FREQ        1193182ULL
+#define SIM_FILENAME        "benchsim.csv"
+#define SIM_IODELAY         0xED                        // IODELAY of ../main.cpp
+
+int gnTimestampPolicy;                                  // TSPOL_RDTSC, TscPolicy.c isn't linked
+int gnApicAccess = APIC_ACCESS_NONE;                    // ApicTimer.c isn't linked
+volatile uint32_t* gpApicMmio;
+uint64_t gqwApicTimerFreq;
+
+static uint8_t gbCmosIndex;
+static uint16_t gwPitLatch;
+static int gfPitHiByte;
+
+static uint64_t SimNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t Bcd(int n) { return (uint8_t)(((n / 10) << 4) + n % 10); }
+
+static uint8_t SimCmos(uint8_t bIndex)
+{
+    time_t t = time(NULL);
+    struct tm* ptm = localtime(&t);
+
+    switch (bIndex)
+    {
+    case RTC_REG_SEC:   return Bcd(ptm->tm_sec);
+    case RTC_REG_MIN:   return Bcd(ptm->tm_min);
+    case RTC_REG_HOUR:  return Bcd(ptm->tm_hour);
+    case RTC_REG_DAY:   return Bcd(ptm->tm_mday);
+    case RTC_REG_MONTH: return Bcd(ptm->tm_mon + 1);
+    case RTC_REG_YEAR:  return Bcd(ptm->tm_year % 100);
+    case RTC_REG_B:     return 0x02;                    // BCD, 24h
+    }
+
+    return 0;                                           // RTC_REG_A, UIP never set
+}
+
+int _inp(unsigned short wPort)
+{
+    if (RTC_DATA == wPort)
+        return SimCmos(gbCmosIndex);
+
+    if (0x42 == wPort)                                  // PIT timer 2, low byte first
+    {
+        int b = gfPitHiByte ? gwPitLatch >> 8 : gwPitLatch & 0xFF;
+
+        gfPitHiByte = !gfPitHiByte;
+        return b;
+    }
+
+    return 0xFF;
+}
+
+unsigned short _inpw(unsigned short wPort)
+{
+    return 0;                                           // PM1_STS, TMR_STS never set
+}
+
+unsigned long _inpd(unsigned short wPort)
+{
+    return SIM_PMTMR == wPort ? (unsigned long)(SimNs() * SIM_ACPI_FREQ / 1000000000ULL & 0xFFFFFF) : 0xFFFFFFFF;
+}
+
+int _outp(unsigned short wPort, int nData)
+{
+    if (RTC_INDEX == wPort)
+        gbCmosIndex = nData & 0x7F;
+    else if (0x43 == wPort && (2 << 6) == nData)        // counter latch timer 2
+        gwPitLatch = (uint16_t)(0x10000 - SimNs() * SIM_PIT_FREQ / 1000000000ULL % 0x10000), gfPitHiByte = 0;
+
+    return nData;
+}
+
+unsigned short _outpw(unsigned short wPort, unsigned short wData)
+{
+    return wData;
+}
+
+unsigned long _outpd(unsigned short wPort, unsigned long dwData)
+{
+    return dwData;
+}
+
+/**
+  rtcrd() of ../main.cpp, UIP polled on each read and an IODELAY port 0xED write
+  after each access, so the rtcrd() rows compare against the snapshot as on hardware
+
+**/
+int rtcrd(int idx)
+{
+    int nRet = 0;
+    int UIP = 0;
+
+    do {
+        _outp(RTC_INDEX, RTC_REG_A);
+        _outp(SIM_IODELAY, 0x55);
+
+        UIP = RTC_UIP == (RTC_UIP & _inp(RTC_DATA));
+        _outp(SIM_IODELAY, 0x55);
+
+        _outp(RTC_INDEX, idx);
+        _outp(SIM_IODELAY, 0x55);
+
+        nRet = _inp(RTC_DATA); _outp(SIM_IODELAY, 0x55);
+
+    } while (1 == UIP);
+
+    return nRet;
+}
+
+uint32_t ApicTimerRead(void)
+{
+    return 0;
+}
+
+/**
+  TSC frequency against CLOCK_MONOTONIC over 100ms
+
+**/
+static double SimTSCPerSec(void)
+{
+    uint64_t qwNs = SimNs(), qwTSC = __rdtsc();
+
+    while (SimNs() - qwNs < 100000000ULL)
+        ;
+
+    return (double)(__rdtsc() - qwTSC) * 1e9 / (double)(SimNs() - qwNs);
+}
+
+int main(int argc, char** argv)
+{
+    static BENCH_RESULT Result;
+    FILE* fp;
+    char strLine[256];
+    int cntLines = 0, nErrors = 0;
+
+    gPmTmrBlkAddr = SIM_PMTMR;
+
+    if (0 != BenchRun(&Result, SimTSCPerSec()))
+    {
+        printf("FAIL: BenchRun()\n");
+        return 1;
+    }
+
+    BenchPrintTable(stdout, &Result);
+
+    fp = fopen(SIM_FILENAME, "w");
+    if (NULL == fp)
+    {
+        printf("FAIL: can't create %s\n", SIM_FILENAME);
+        return 1;
+    }
+    BenchPrintCsv(fp, &Result);
+    fclose(fp);
+
+    //
+    // all primitives but the local APIC timer and PM timer MMIO
+    //
+    if (BENCH_NUMPRIM - 2 != Result.cntStat)
+        printf("FAIL: %d primitives measured, %d expected\n", Result.cntStat, BENCH_NUMPRIM - 2), nErrors++;
+
+    for (int n = 0; n < Result.cntStat; n++)
+    {
+        BENCH_STAT* p = &Result.rgStat[n];
+
+        if (BENCH_SAMPLES != p->cntSamples || p->qwMin > p->qwP50 || p->qwP50 > p->qwP99 || p->qwP99 > p->qwMax)
+            printf("FAIL: %s, distribution out of order\n", p->pstrName), nErrors++;
+        if (0 == strncmp(p->pstrName, "ACPI wait", strlen("ACPI wait")) && 0 == p->qwP50)
+            printf("FAIL: %s, no loop iteration\n", p->pstrName), nErrors++;
+    }
+
+    fp = fopen(SIM_FILENAME, "r");
+    while (NULL != fp && NULL != fgets(strLine, sizeof(strLine), fp))
+        cntLines++;
+    if (NULL != fp)
+        fclose(fp);
+
+    if (1 + Result.cntStat != cntLines)
+        printf("FAIL: %s, %d lines, %d expected\n", SIM_FILENAME, cntLines, 1 + Result.cntStat), nErrors++;
+
+    printf("%s\n", 0 == nErrors ? "PASS" : "FAIL");
+
+    return 0 == nErrors ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    CampaignSim.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    simulated RTC/PM1 backend for the cold boot campaign sequence of ../Campaign.c
+
+    Runs a campaign on the host: each simulated boot calls CampaignStep(), an S5 entry
+    checks alarm, AIE and RTC_EN, then the simulated time advances to the alarm and the
+    next boot starts. The RTC is read through RtcSnapshotReadIo() of ../RtcSnapshot.c,
+    -ILinux maps conio.h to the port functions below. Build with ../Campaign.c
+    ../RtcSnapshot.c, -ILinux, returns 0 on success.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <conio.h>
+#include "../Campaign.h"
+#include "../RtcSnapshot.h"
+
+#define SIM_ITERATIONS      5
+#define SIM_WAKE            90
+#define SIM_PM1A_EVT        0x1800
+#define SIM_PM1A_EN         0x1802
+#define SIM_PM1A_CNT        0x1804
+#define SIM_S5VAL           7
+#define SIM_FILENAME        "campaignsim.csv"
+
+int gnTimestampPolicy;                                  // TSPOL_RDTSC, TscPolicy.c isn't linked
+
+static uint8_t grgbCmos[128];
+static uint8_t gbCmosIndex;
+static uint16_t gwPm1Sts, gwPm1En;
+static uint32_t gdwSimSecOfDay = 23 * 3600 + 59 * 60 + 30;  // wraps past midnight on the 1st alarm
+static int gfS5, gnErrors;
+
+static uint8_t Bcd(uint32_t n) { return (uint8_t)(((n / 10) << 4) + n % 10); }
+
+static void SimRtcUpdate(void)
+{
+    grgbCmos[RTC_REG_SEC] = Bcd(gdwSimSecOfDay % 60);
+    grgbCmos[RTC_REG_MIN] = Bcd(gdwSimSecOfDay / 60 % 60);
+    grgbCmos[RTC_REG_HOUR] = Bcd(gdwSimSecOfDay / 3600);
+}
+
+static uint8_t SimInp(uint16_t wPort)
+{
+    if (RTC_DATA == wPort)
+    {
+        uint8_t b = grgbCmos[gbCmosIndex];
+
+        if (RTC_REG_C == gbCmosIndex)
+            grgbCmos[RTC_REG_C] = 0;                    // cleared by read
+        return b;
+    }
+    return 0xFF;
+}
+
+static void SimOutp(uint16_t wPort, uint8_t bData)
+{
+    if (RTC_INDEX == wPort)
+        gbCmosIndex = bData & 0x7F;
+    else if (RTC_DATA == wPort)
+        grgbCmos[gbCmosIndex] = bData;
+    else if (SIM_PM1A_CNT + 1 == wPort && (PM1_SLP_EN << 2) == (bData & (PM1_SLP_EN << 2)))
+        gfS5 = SIM_S5VAL == (bData >> 2 & 7);
+}
+
+static uint16_t SimInpw(uint16_t wPort)
+{
+    return SIM_PM1A_EVT == wPort ? gwPm1Sts : (SIM_PM1A_EN == wPort ? gwPm1En : 0xFFFF);
+}
+
+static void SimOutpw(uint16_t wPort, uint16_t wData)
+{
+    if (SIM_PM1A_EVT == wPort)
+        gwPm1Sts &= ~wData;                             // write 1 to clear
+    else if (SIM_PM1A_EN == wPort)
+        gwPm1En = wData;
+}
+
+int _inp(unsigned short wPort)                          // RtcSnapshotRead() backend, linked but not used
+{
+    return SimInp(wPort);
+}
+
+int _outp(unsigned short wPort, int nData)
+{
+    SimOutp(wPort, (uint8_t)nData);
+    return nData;
+}
+
+static const CAMPAIGN_IO gSimIo = { SimInp, SimOutp, SimInpw, SimOutpw };
+
+static void SimCheck(int f, const char* pstrMsg, int nBoot)
+{
+    if (!f)
+        printf("boot %d: FAIL %s\n", nBoot, pstrMsg), gnErrors++;
+}
+
+int main(void)
+{
+    CAMPAIGN Campaign = { SIM_ITERATIONS, SIM_WAKE, SIM_PM1A_EVT, SIM_PM1A_EN, SIM_PM1A_CNT, SIM_S5VAL, 0, 0 };
+    int nBoot, nRet = CAMPAIGN_CONTINUE;
+
+    remove(SIM_FILENAME);
+
+    grgbCmos[RTC_REG_B] = RTC_B_24H;                    // BCD, 24h
+    grgbCmos[RTC_REG_DAY] = Bcd(31);
+    grgbCmos[RTC_REG_MONTH] = Bcd(12);
+    grgbCmos[RTC_REG_YEAR] = Bcd(25);
+
+    for (nBoot = 1; CAMPAIGN_CONTINUE == nRet && nBoot <= 2 * SIM_ITERATIONS; nBoot++)
+    {
+        CAMPAIGN_RECORD Record = { (uint64_t)nBoot * 1000000, 2400000000LL + nBoot, 2400000000LL, 2400000000LL, 0, "simulation" };
+        uint32_t dwExpected = (gdwSimSecOfDay + SIM_WAKE) % 86400;
+
+        SimRtcUpdate();
+        gfS5 = 0;
+
+        nRet = CampaignStep(&Campaign, &gSimIo, SIM_FILENAME, &Record);
+
+        SimCheck(CAMPAIGN_ERROR != nRet, "CampaignStep() error", nBoot);
+        SimCheck((uint32_t)nBoot == Campaign.nDone, "record count", nBoot);
+
+        if (CAMPAIGN_CONTINUE == nRet)
+        {
+            SimCheck(gfS5, "no S5 entry", nBoot);
+            SimCheck(0 != (RTC_B_AIE & grgbCmos[RTC_REG_B]), "AIE not set", nBoot);
+            SimCheck(0 != (PM1_RTC_EN & gwPm1En), "RTC_EN not set", nBoot);
+            SimCheck(grgbCmos[RTC_REG_ALARM_SEC] == Bcd(dwExpected % 60)
+                && grgbCmos[RTC_REG_ALARM_MIN] == Bcd(dwExpected / 60 % 60)
+                && grgbCmos[RTC_REG_ALARM_HOUR] == Bcd(dwExpected / 3600), "alarm time", nBoot);
+
+            gdwSimSecOfDay = dwExpected;                // S5 until the alarm, then wake
+            gwPm1Sts |= PM1_RTC_STS;
+        }
+    }
+
+    SimCheck(CAMPAIGN_DONE == nRet, "campaign not finished", nBoot);
+    SimCheck(SIM_ITERATIONS == CampaignCount(SIM_FILENAME), "dataset records", nBoot);
+    SimCheck(0 == (RTC_B_AIE & grgbCmos[RTC_REG_B]) && 0 == (PM1_RTC_EN & gwPm1En), "not disarmed", nBoot);
+
+    printf("%s: %d boots, %u records in %s\n", 0 == gnErrors ? "PASS" : "FAIL", nBoot - 1, CampaignCount(SIM_FILENAME), SIM_FILENAME);
+
+    return 0 == gnErrors ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    ChunkSim.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    simulated ACPI PM timer and PIT for the chunked waits of ../ClkWaitKernel.cpp
+
+    The ACPI PM timer and the PIT are port I/O on CLOCK_MONOTONIC, -ILinux maps conio.h
+    to the port functions below. SimInterrupt() is the interrupt handler run in each window
+    of a chunked wait, SIM_HANDLER_US long in every SIM_HANDLER_EVERY window, beyond the
+    PIT counter range. Each timer is waited SIM_DELAY ACPI ticks in one segment and chunked,
+    the TSC per interval of both has to agree within SIM_MAXPPM, the lost PIT wraps have to
+    be reported. Build on Linux with ../AcpiClkWait.c ../ClkWaitKernel.cpp, -ILinux.
+    Returns 0 on success.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <conio.h>
+#include <intrin.h>
+#include "../ClkWait.h"
+#include "../ApicTimer.h"
+
+#define SIM_PMTMR           0x1808                      // PM_TMR_BLK
+#define SIM_ACPI_FREQ       3579545ULL
+#define SIM_PIT_FREQ        1193182ULL
+#define SIM_DELAY           (3579545 / 2)               // 500ms
+#define SIM_HANDLER_US      70000                       // longer than the PIT range of 55ms
+#define SIM_HANDLER_EVERY   128                         // windows
+#define SIM_MAXPPM          200
+
+int gnTimestampPolicy;                                  // TSPOL_RDTSC, TscPolicy.c isn't linked
+int gnApicAccess = APIC_ACCESS_NONE;                    // ApicTimer.c isn't linked
+volatile uint32_t* gpApicMmio;
+uint64_t gqwApicTimerFreq;
+
+static uint16_t gwPitLatch;
+static int gfPitHiByte;
+static uint32_t gcntWindows;
+static int gfLongHandler;
+
+static uint64_t SimNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int _inp(unsigned short wPort)
+{
+    if (0x42 == wPort)                                  // PIT timer 2, low byte first
+    {
+        int b = gfPitHiByte ? gwPitLatch >> 8 : gwPitLatch & 0xFF;
+
+        gfPitHiByte = !gfPitHiByte;
+        return b;
+    }
+
+    return 0xFF;
+}
+
+unsigned short _inpw(unsigned short wPort)
+{
+    return 0;
+}
+
+unsigned long _inpd(unsigned short wPort)
+{
+    return SIM_PMTMR == wPort ? (unsigned long)(SimNs() * SIM_ACPI_FREQ / 1000000000ULL & 0xFFFFFF) : 0xFFFFFFFF;
+}
+
+int _outp(unsigned short wPort, int nData)
+{
+    if (0x43 == wPort && (2 << 6) == nData)             // counter latch timer 2
+        gwPitLatch = (uint16_t)(0x10000 - SimNs() * SIM_PIT_FREQ / 1000000000ULL % 0x10000), gfPitHiByte = 0;
+
+    return nData;
+}
+
+unsigned short _outpw(unsigned short wPort, unsigned short wData)
+{
+    return wData;
+}
+
+unsigned long _outpd(unsigned short wPort, unsigned long dwData)
+{
+    return dwData;
+}
+
+/**
+  Interrupt handler of the chunked wait windows, every SIM_HANDLER_EVERY one runs SIM_HANDLER_US
+
+**/
+void SimInterrupt(void)
+{
+    uint64_t qwNs;
+
+    if (!gfLongHandler || 0 != ++gcntWindows % SIM_HANDLER_EVERY)
+        return;
+
+    for (qwNs = SimNs(); SimNs() - qwNs < SIM_HANDLER_US * 1000ULL; )
+        ;
+}
+
+/**
+  Wait in one segment, chunked and chunked with long handlers, compare the TSC per interval
+
+  @retval number of errors
+
+**/
+static int SimCompare(const char* pstrName, int64_t (*pfnDelay)(uint32_t, CLKWAIT_DIAG*), int fWrapExpected)
+{
+    CLKWAIT_DIAG Diag, DiagLong;
+    int64_t llSingle, llChunked, llLong;
+    double dblPpm, dblPpmLong;
+    int nErrors = 0;
+
+    gfChunkedWait = 0, gfLongHandler = 0;
+    llSingle = pfnDelay(SIM_DELAY, NULL);
+
+    gfChunkedWait = 1;
+    llChunked = pfnDelay(SIM_DELAY, &Diag);
+
+    gfLongHandler = 1, gcntWindows = 0;
+    llLong = pfnDelay(SIM_DELAY, &DiagLong);
+
+    dblPpm = ((double)llChunked / (double)llSingle - 1.0) * 1e6;
+    dblPpmLong = ((double)llLong / (double)llSingle - 1.0) * 1e6;
+
+    printf("%-5s single %12lld TSC\n", pstrName, (long long)llSingle);
+    printf("%-5s chunked %11lld TSC %+9.1fppm, %5u segments, %u wraps lost\n", pstrName, (long long)llChunked, dblPpm, Diag.cntSegments, Diag.cntWrapLost);
+    printf("%-5s %3dms handlers %5lld TSC %+9.1fppm, %5u segments, %u wraps lost, max. window %.1fms, %u of %u anchors\n", pstrName, SIM_HANDLER_US / 1000, (long long)llLong, dblPpmLong,
+        DiagLong.cntSegments, DiagLong.cntWrapLost, (double)DiagLong.qwTSCWindowMax * SIM_DELAY / SIM_ACPI_FREQ / (double)llSingle * 1e3,
+        gClkWaitSegRec.cntSeg < CLKWAIT_MAXANCHOR ? gClkWaitSegRec.cntSeg : CLKWAIT_MAXANCHOR, gClkWaitSegRec.cntSeg);
+
+    if (fabs(dblPpm) > SIM_MAXPPM || fabs(dblPpmLong) > SIM_MAXPPM)
+        printf("FAIL: %s, chunked beyond %dppm\n", pstrName, SIM_MAXPPM), nErrors++;
+    if (Diag.cntSegments < 2 || DiagLong.cntSegments < 2)
+        printf("FAIL: %s, not chunked\n", pstrName), nErrors++;
+    if (fWrapExpected != (0 != DiagLong.cntWrapLost) || 0 != Diag.cntWrapLost)
+        printf("FAIL: %s, %u wraps lost reported\n", pstrName, DiagLong.cntWrapLost), nErrors++;
+
+    return nErrors;
+}
+
+int main(int argc, char** argv)
+{
+    int nErrors = 0;
+
+    gPmTmrBlkAddr = SIM_PMTMR;
+
+    nErrors += SimCompare("ACPI", AcpiClkWait, 0);      // 4.7s counter range
+    nErrors += SimCompare("PIT", PITClkWait, 1);        // 55ms counter range
+
+    printf("%s\n", 0 == nErrors ? "PASS" : "FAIL");
+
+    return 0 == nErrors ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    conio.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    MSVC port I/O on Linux, provided by the simulated port backend of the sample
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCSYNC_LINUX_CONIO_H_
+#define _TSCSYNC_LINUX_CONIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int _inp(unsigned short wPort);
+unsigned short _inpw(unsigned short wPort);
+unsigned long _inpd(unsigned short wPort);
+int _outp(unsigned short wPort, int nData);
+unsigned short _outpw(unsigned short wPort, unsigned short wData);
+unsigned long _outpd(unsigned short wPort, unsigned long dwData);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define outp                        _outp
+
+#endif//_TSCSYNC_LINUX_CONIO_H_
@@ -0,0 +1,64 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    intrin.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    MSVC intrinsics on GCC, to build the simulated backends of Samples on Linux
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCSYNC_LINUX_INTRIN_H_
+#define _TSCSYNC_LINUX_INTRIN_H_
+
+#include <stdint.h>
+#include <x86intrin.h>
+#include <cpuid.h>
+
+#define _InterlockedIncrement(p)    __sync_add_and_fetch((p), 1)
+#define _InterlockedDecrement(p)    __sync_sub_and_fetch((p), 1)
+
+#undef __cpuid                                          // <cpuid.h> macro, MSVC signature below
+static __inline void __cpuid(int rgInfo[4], int nLeaf)
+{
+    __cpuid_count(nLeaf, 0, rgInfo[0], rgInfo[1], rgInfo[2], rgInfo[3]);
+}
+
+#ifndef __forceinline
+#define __forceinline               inline __attribute__((always_inline))
+#endif
+
+//
+// user mode, the interrupt flag can't be changed. _enable() runs the simulated interrupt
+// handler SimInterrupt() of a sample, if it defines one, e.g. to stretch a chunked wait window
+//
+#ifdef __cplusplus
+extern "C"
+#endif
+void SimInterrupt(void) __attribute__((weak));
+
+static __inline void _disable(void) {}
+static __inline void _enable(void)
+{
+    if (SimInterrupt)
+        SimInterrupt();
+}
+
+static __inline uint64_t __readmsr(unsigned long dwMsr)
+{
+    return 0x10 == dwMsr ? __rdtsc() : 0;               // IA32_TIME_STAMP_COUNTER only
+}
+
+#endif//_TSCSYNC_LINUX_INTRIN_H_
@@ -0,0 +1,207 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    MpContentionSim.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    pthreads backend with simulated ACPI PM timer and PIT for ../MpContention.c
+
+    Each AP is a thread. A port access holds the simulated bus for SIM_PORT_NS, the
+    ACPI timer and the PIT count on CLOCK_MONOTONIC. The PIT latch sequence is done in
+    3 separate port accesses like on hardware, so concurrent readers tear reads.
+    Build on Linux with ../MpContention.c and -pthread, -ILinux for intrin.h,
+    the number of APs is argv[1], default SIM_APS. Returns 0 on success, the AP 0
+    calibration under contention has to be within SIM_MAXPPM of the single core one.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <intrin.h>
+#include "../MpContention.h"
+
+#define SIM_APS             4
+#define SIM_PORT_NS         1000                        // duration of one port access
+#define SIM_ACPI_FREQ       3579545ULL
+#define SIM_PIT_FREQ        1193182ULL
+#define SIM_MAXPPM          100                         // AP 0 calibration, cal. [ppm] column
+
+int gnTimestampPolicy;                                  // TSPOL_RDTSC, TscPolicy.c isn't linked
+
+static pthread_mutex_t gSimBus = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t gqwSimNsStart;
+static uint16_t gwPitLatch;
+static int gfPitLatched, gfPitHiByte;
+
+static uint64_t SimNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec - gqwSimNsStart;
+}
+
+/**
+  Hold the bus for one port access and get the time of the access
+
+**/
+static uint64_t SimPortCycle(void)
+{
+    uint64_t qwNs = SimNs();
+
+    while (SimNs() - qwNs < SIM_PORT_NS)
+        ;
+
+    return qwNs;
+}
+
+static uint32_t SimReadAcpi(void)
+{
+    uint32_t dw;
+
+    pthread_mutex_lock(&gSimBus);
+    dw = (uint32_t)(SimPortCycle() * SIM_ACPI_FREQ / 1000000000ULL);
+    pthread_mutex_unlock(&gSimBus);
+
+    return dw;
+}
+
+/**
+  PIT timer 2 in MODE 2, 65536: latch command, low byte, high byte
+
+**/
+static uint32_t SimReadPit(void)
+{
+    uint32_t lo, hi;
+
+    pthread_mutex_lock(&gSimBus);
+    if (!gfPitLatched)                                  // a pending latch ignores further latch commands
+    {
+        gwPitLatch = (uint16_t)(0x10000 - SimPortCycle() * SIM_PIT_FREQ / 1000000000ULL % 0x10000);
+        gfPitLatched = 1, gfPitHiByte = 0;
+    }
+    else
+        SimPortCycle();
+    pthread_mutex_unlock(&gSimBus);
+
+    pthread_mutex_lock(&gSimBus);
+    SimPortCycle();
+    lo = gfPitHiByte ? gwPitLatch >> 8 : gwPitLatch & 0xFF;
+    gfPitLatched = !gfPitHiByte, gfPitHiByte = !gfPitHiByte;
+    pthread_mutex_unlock(&gSimBus);
+
+    pthread_mutex_lock(&gSimBus);
+    SimPortCycle();
+    hi = gfPitHiByte ? gwPitLatch >> 8 : gwPitLatch & 0xFF;
+    gfPitLatched = !gfPitHiByte, gfPitHiByte = !gfPitHiByte;
+    pthread_mutex_unlock(&gSimBus);
+
+    return (hi << 8) | lo;
+}
+
+static uint32_t gnSimAPs = SIM_APS;
+
+typedef struct _SIM_AP {
+    MPCONT_PROC pfnProc;
+    void* pArg;
+}SIM_AP;
+
+//
+// pthread start routine, calls the AP procedure through its own type
+//
+static void* SimApThread(void* pArg)
+{
+    SIM_AP* pAp = (SIM_AP*)pArg;
+
+    pAp->pfnProc(pAp->pArg);
+
+    return NULL;
+}
+
+static int SimStartupAllAPs(MPCONT_PROC pfnProc, void* pArg)
+{
+    pthread_t rgThread[MPCONT_MAXCPU];
+    SIM_AP Ap = { pfnProc, pArg };                      // outlives the threads, joined below
+    uint32_t i, nRet = 0;
+
+    for (i = 0; i < gnSimAPs; i++)
+        if (0 != pthread_create(&rgThread[i], NULL, SimApThread, &Ap))
+            break;
+
+    nRet = i == gnSimAPs ? 0 : -1;
+
+    while (i-- > 0)
+        pthread_join(rgThread[i], NULL);
+
+    return nRet;
+}
+
+/**
+  TSC frequency against CLOCK_MONOTONIC over 100ms
+
+**/
+static double SimTSCPerSec(void)
+{
+    uint64_t qwNs = SimNs(), qwTSC = __rdtsc();
+
+    while (SimNs() - qwNs < 100000000ULL)
+        ;
+
+    return (double)(__rdtsc() - qwTSC) * 1e9 / (double)(SimNs() - qwNs);
+}
+
+int main(int argc, char** argv)
+{
+    static MPCONT_RESULT Result;
+    MPCONT_PLATFORM Plat = { SIM_APS, SimStartupAllAPs, SimReadAcpi, SimReadPit };
+    int nErrors = 0;
+
+    if (argc > 1)
+        gnSimAPs = (uint32_t)atoi(argv[1]);
+    if (0 == gnSimAPs || gnSimAPs > MPCONT_MAXCPU)
+        gnSimAPs = SIM_APS;
+    Plat.nAPs = gnSimAPs;
+
+    gqwSimNsStart = SimNs();
+
+    if (0 != MpContentionRun(&Result, &Plat, SimTSCPerSec()))
+    {
+        printf("FAIL: MpContentionRun()\n");
+        return 1;
+    }
+
+    printf("simulated %u APs, %uns per port access, TSC %.0fHz\n", gnSimAPs, SIM_PORT_NS, Result.dblTSCPerSec);
+    MpContentionPrintTable(stdout, &Result);
+
+    for (int n = 0; n < MPCONT_NUMSRC; n++)
+        for (uint32_t i = 0; i < Result.nAPs; i++)
+        {
+            MPCONT_POINT* p = &Result.rgPoint[n][i];
+
+            if (0 == p->cntReads || 0 == p->dblCalTSCPerSec)
+                printf("FAIL: %s, %u cores, no reads or no calibration\n", grgstrMpContName[n], i + 1), nErrors++;
+            else if (fabs(p->dblCalPpm) > SIM_MAXPPM)
+                printf("FAIL: %s, %u cores, calibration beyond %dppm\n", grgstrMpContName[n], i + 1, SIM_MAXPPM), nErrors++;
+        }
+
+    printf("%s\n", 0 == nErrors ? "PASS" : "FAIL");
+
+    return 0 == nErrors ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscOffsetSim.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    pthreads backend for the per AP TSC offset of ../TscOffset.c
+
+    Each AP is a thread, CPU 0 is the BSP. The host TSC is synchronized across cores,
+    the offsets have to be within +/- half the round trip of the ping-pong, on a single
+    core host that round trip is a scheduler time slice. Build on Linux with
+    ../TscOffset.c and -pthread, -ILinux for intrin.h, the number of CPUs is argv[1],
+    default SIM_CPUS. Returns 0 on success.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <intrin.h>
+#include "../TscOffset.h"
+
+#define SIM_CPUS            4
+#define SIM_MAXCPU          64
+
+typedef struct _SIM_AP {
+    TSCOFS_PROC pfnProc;
+    void* pArg;
+}SIM_AP;
+
+static SIM_AP gSimAp;
+static pthread_t gSimThread;
+
+static int SimIsAP(uint32_t nCpu)
+{
+    return 0 != nCpu;
+}
+
+//
+// pthread start routine, calls the AP procedure through its own type
+//
+static void* SimApThread(void* pArg)
+{
+    SIM_AP* pAp = (SIM_AP*)pArg;
+
+    pAp->pfnProc(pAp->pArg);
+
+    return NULL;
+}
+
+static int SimStartAP(uint32_t nCpu, TSCOFS_PROC pfnProc, void* pArg)
+{
+    gSimAp.pfnProc = pfnProc;
+    gSimAp.pArg = pArg;
+
+    return 0 == pthread_create(&gSimThread, NULL, SimApThread, &gSimAp) ? 0 : -1;
+}
+
+static void SimWaitAP(void)
+{
+    pthread_join(gSimThread, NULL);
+}
+
+/**
+  TSC frequency against CLOCK_MONOTONIC over 100ms
+
+**/
+static double SimTSCPerSec(void)
+{
+    struct timespec ts0, ts1;
+    uint64_t qwTSC = __rdtsc();
+
+    clock_gettime(CLOCK_MONOTONIC, &ts0);
+    do
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+    while ((ts1.tv_sec - ts0.tv_sec) * 1000000000LL + ts1.tv_nsec - ts0.tv_nsec < 100000000LL);
+
+    return (double)(__rdtsc() - qwTSC) * 1e9 / (double)((ts1.tv_sec - ts0.tv_sec) * 1000000000LL + ts1.tv_nsec - ts0.tv_nsec);
+}
+
+int main(int argc, char** argv)
+{
+    static int64_t rgllOffset[SIM_MAXCPU];
+    static uint64_t rgqwRtt[SIM_MAXCPU];
+    TSCOFS_PLATFORM Plat = { SIM_CPUS, SimIsAP, SimStartAP, SimWaitAP };
+    int nCpus, nErrors = 0;
+
+    if (argc > 1)
+        Plat.nCpus = (uint32_t)atoi(argv[1]);
+    if (0 == Plat.nCpus || Plat.nCpus > SIM_MAXCPU)
+        Plat.nCpus = SIM_CPUS;
+
+    nCpus = TscOffsetRun(&Plat, SimTSCPerSec(), rgllOffset, rgqwRtt, SIM_MAXCPU);
+    if (nCpus < 0)
+    {
+        printf("FAIL: TscOffsetRun()\n");
+        return 1;
+    }
+
+    for (int n = 0; n < nCpus; n++)
+    {
+        printf("CPU %3d: %+lld TSC, round trip %llu TSC\n", n, (long long)rgllOffset[n], (unsigned long long)rgqwRtt[n]);
+        if ((uint64_t)llabs(rgllOffset[n]) > rgqwRtt[n] / 2 + 1)
+            printf("FAIL: CPU %d, offset beyond half the round trip\n", n), nErrors++;
+    }
+
+    if ((int)Plat.nCpus != nCpus || 0 != rgllOffset[0])
+        printf("FAIL: %d CPUs, BSP offset %lld\n", nCpus, (long long)rgllOffset[0]), nErrors++;
+
+    printf("%s\n", 0 == nErrors ? "PASS" : "FAIL");
+
+    return 0 == nErrors ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscSyncConsumer.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    sample UEFI Shell application, takes the TSC frequency from TSCSYNC_PROTOCOL
+    published by "TSCSync /PUBLISH" instead of calibrating on its own
+
+    Build with ../TscSyncProtocol.c. Define TSCSYNC_MOCK and add TscSyncMock.c
+    to run it on the host, the mock publishes a protocol instance first.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <intrin.h>
+#include "../TscSyncProtocol.h"
+
+#ifdef TSCSYNC_MOCK
+extern EFI_BOOT_SERVICES* TscSyncMockBootServices(void);
+#endif//TSCSYNC_MOCK
+
+/**
+  Calibrate the TSC the way each tool does on its own, one second between two RTC edges
+
+  @param  pqwTSCSpent   TSC spent, including the wait for the first edge
+
+  @retval TSC per second
+
+**/
+static uint64_t OwnCalibration(uint64_t* pqwTSCSpent)
+{
+    uint64_t qwTSCEntry = __rdtsc(), qwTSCStart;
+    time_t t = time(NULL);
+
+    while (t == time(NULL))
+        ;
+    qwTSCStart = __rdtsc();
+    t = time(NULL);
+    while (t == time(NULL))
+        ;
+
+    *pqwTSCSpent = __rdtsc() - qwTSCEntry;
+
+    return *pqwTSCSpent - (qwTSCStart - qwTSCEntry);
+}
+
+int main(int argc, char** argv)
+{
+    EFI_BOOT_SERVICES* pBS;
+    TSCSYNC_PROTOCOL* pTscSync = NULL;
+    EFI_STATUS Status;
+    uint64_t qwTSCStart, qwTSCLocate, qwTSCCalib, qwFreqOwn;
+
+#ifdef TSCSYNC_MOCK
+    if (1)
+    {
+        static TSCSYNC_PROTOCOL TscSync = { 0 };
+
+        pBS = TscSyncMockBootServices();
+        TscSync.TscFrequency = OwnCalibration(&qwTSCCalib);
+        TscSync.TscFrequencyUncertainty = TscSync.TscFrequency / 1000000;
+        TscSync.CalibrationTsc = __rdtsc();
+        TscSync.NumberOfCpus = 1;
+        sprintf(TscSync.Method, "host mock");
+        TscSyncProtocolPublish(pBS, &TscSync, NULL);
+    }
+#else
+    pBS = ((EFI_SYSTEM_TABLE*)argv[-1])->BootServices;  // SystemTable is passed in argv[-1]
+#endif//TSCSYNC_MOCK
+
+    qwTSCStart = __rdtsc();
+    Status = TscSyncProtocolLocate(pBS, &pTscSync);
+    qwTSCLocate = __rdtsc() - qwTSCStart;
+
+    qwFreqOwn = OwnCalibration(&qwTSCCalib);
+
+    if (EFI_ERROR(Status))
+    {
+        printf("TSCSYNC_PROTOCOL not found, run \"TSCSync /PUBLISH\" first\n");
+        printf("own calibration: %lluHz, %.0fms\n", qwFreqOwn, qwTSCCalib * 1000.0 / qwFreqOwn);
+        return 1;
+    }
+
+    printf("TSCSYNC_PROTOCOL rev. %08X, method \"%s\"\n", pTscSync->Revision, pTscSync->Method);
+    printf("TSC frequency  : %lluHz +/- %lluHz, published %.0fs ago\n", pTscSync->TscFrequency, pTscSync->TscFrequencyUncertainty, (double)(__rdtsc() - pTscSync->CalibrationTsc) / pTscSync->TscFrequency);
+    printf("CPUs, offsets  : %u\n", pTscSync->NumberOfCpus);
+    for (UINT32 i = 0; i < pTscSync->NumberOfCpus && i < TSCSYNC_MAXCPU; i++)
+        printf("    CPU %3u    : %+lld TSC\n", i, pTscSync->TscOffset[i]);
+    printf("own calibration: %lluHz, %+.3fppm vs. published\n", qwFreqOwn, ((double)qwFreqOwn / pTscSync->TscFrequency - 1.0) * 1e6);
+    printf("time saved     : %.3fms own calibration vs. %.3fus LocateProtocol()\n", qwTSCCalib * 1000.0 / pTscSync->TscFrequency, qwTSCLocate * 1e6 / pTscSync->TscFrequency);
+
+    return 0;
+}
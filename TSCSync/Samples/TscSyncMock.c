@@ -0,0 +1,94 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscSyncMock.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    host mock of the boot services used by TscSyncProtocol.c, to run the consumer sample
+    and the publication on a host without UEFI firmware
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdlib.h>
+#include <string.h>
+#include "../TscSyncProtocol.h"
+
+#define MOCK_MAXPROTOCOL    8
+
+static struct {
+    EFI_GUID Guid;
+    void* pInterface;
+}gMockDb[MOCK_MAXPROTOCOL];                             // protocol database, one interface per handle
+
+static UINTN gcntMockDb;
+
+static EFI_STATUS EFIAPI MockAllocatePool(EFI_MEMORY_TYPE PoolType, UINTN Size, void** Buffer)
+{
+    *Buffer = malloc(Size);
+
+    return NULL == *Buffer ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI MockFreePool(void* Buffer)
+{
+    free(Buffer);
+
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI MockInstallProtocolInterface(EFI_HANDLE* Handle, EFI_GUID* Protocol, EFI_INTERFACE_TYPE InterfaceType, void* Interface)
+{
+    if (MOCK_MAXPROTOCOL == gcntMockDb)
+        return EFI_OUT_OF_RESOURCES;
+
+    gMockDb[gcntMockDb].Guid = *Protocol;
+    gMockDb[gcntMockDb].pInterface = Interface;
+    *Handle = (EFI_HANDLE)&gMockDb[gcntMockDb++];
+
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI MockLocateProtocol(EFI_GUID* Protocol, void* Registration, void** Interface)
+{
+    for (UINTN i = 0; i < gcntMockDb; i++)
+    {
+        if (0 == memcmp(&gMockDb[i].Guid, Protocol, sizeof(EFI_GUID)))
+        {
+            *Interface = gMockDb[i].pInterface;
+            return EFI_SUCCESS;
+        }
+    }
+
+    return EFI_NOT_FOUND;
+}
+
+/**
+  Get a boot services table that provides AllocatePool(), FreePool(),
+  InstallProtocolInterface() and LocateProtocol() only
+
+**/
+EFI_BOOT_SERVICES* TscSyncMockBootServices(void)
+{
+    static EFI_BOOT_SERVICES BootServices;
+
+    memset(&BootServices, 0, sizeof(BootServices));
+
+    BootServices.AllocatePool = MockAllocatePool;
+    BootServices.FreePool = MockFreePool;
+    BootServices.InstallProtocolInterface = MockInstallProtocolInterface;
+    BootServices.LocateProtocol = MockLocateProtocol;
+
+    return &BootServices;
+}
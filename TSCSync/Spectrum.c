@@ -0,0 +1,517 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Spectrum.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    spectral analysis of TSC vs. reference phase, spread spectrum clocking and periodic SMI detection
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Spectrum.h"
+
+#define SPEC_PI 3.14159265358979323846
+
+/**
+  Twiddle factors for SpectrumFft()
+
+  The butterflies of the stage with half length h use wr/wi[h - 1 + j], j = 0..h-1,
+  so each stage reads its twiddle factors with unit stride. n - 1 entries in total.
+
+  @param  wr        cosine table, n - 1 entries
+  @param  wi        sine table, n - 1 entries
+  @param  n         FFT length, power of 2
+
+**/
+static void SpectrumTwiddle(double* wr, double* wi, uint32_t n)
+{
+    for (uint32_t h = 1; h < n; h <<= 1)
+        for (uint32_t j = 0; j < h; j++)
+        {
+            double a = -SPEC_PI * j / h;
+
+            wr[h - 1 + j] = cos(a);
+            wi[h - 1 + j] = sin(a);
+        }
+}
+
+/**
+  Iterative radix-2 decimation-in-time FFT, in place
+
+  Real and imaginary parts are kept in separate arrays, the inner butterfly
+  loop runs with unit stride on all operands and is vectorized by the compiler.
+
+  @param  re        real part
+  @param  im        imaginary part
+  @param  wr        cosine table from SpectrumTwiddle()
+  @param  wi        sine table from SpectrumTwiddle()
+  @param  n         FFT length, power of 2
+
+**/
+static void SpectrumFft(double* re, double* im, const double* wr, const double* wi, uint32_t n)
+{
+    //
+    // bit reversal permutation
+    //
+    for (uint32_t i = 1, j = 0; i < n; i++)
+    {
+        uint32_t bit = n >> 1;
+
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+
+        if (i < j)
+        {
+            double t;
+
+            t = re[i], re[i] = re[j], re[j] = t;
+            t = im[i], im[i] = im[j], im[j] = t;
+        }
+    }
+
+    //
+    // butterflies
+    //
+    for (uint32_t h = 1; h < n; h <<= 1)
+    {
+        const double* pwr = &wr[h - 1], * pwi = &wi[h - 1];
+
+        for (uint32_t i = 0; i < n; i += 2 * h)
+        {
+            double* ar = &re[i], * ai = &im[i], * br = &re[i + h], * bi = &im[i + h];
+
+            for (uint32_t j = 0; j < h; j++)
+            {
+                double tr = br[j] * pwr[j] - bi[j] * pwi[j];
+                double ti = br[j] * pwi[j] + bi[j] * pwr[j];
+
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+static int SpectrumCmp(const void* a, const void* b)
+{
+    double d = *(const double*)a - *(const double*)b;
+
+    return d < 0.0 ? -1 : (d > 0.0 ? 1 : 0);
+}
+
+/**
+  Noise floor, median of each block of SPEC_FLOORBINS bins
+
+  @param  A         amplitude spectrum
+  @param  nBins     number of bins
+  @param  pFloor    noise floor, one entry per block
+
+**/
+static void SpectrumFloor(const double* A, uint32_t nBins, double* pFloor)
+{
+    double rgdbl[SPEC_FLOORBINS];
+
+    for (uint32_t b = 0; b * SPEC_FLOORBINS < nBins; b++)
+    {
+        uint32_t cnt = nBins - b * SPEC_FLOORBINS;
+
+        cnt = cnt > SPEC_FLOORBINS ? SPEC_FLOORBINS : cnt;
+        memcpy(rgdbl, &A[b * SPEC_FLOORBINS], cnt * sizeof(double));
+        qsort(rgdbl, cnt, sizeof(double), SpectrumCmp);
+
+        pFloor[b] = rgdbl[cnt / 2];
+    }
+}
+
+/**
+  Signal to noise ratio of bin i
+
+**/
+static double SpectrumSNR(const double* A, const double* pFloor, uint32_t i)
+{
+    double dblFloor = pFloor[i / SPEC_FLOORBINS];
+
+    return dblFloor > 0.0 ? A[i] / dblFloor : 0.0;
+}
+
+/**
+  Index of the maximum in A[lo..hi]
+
+**/
+static uint32_t SpectrumMaxBin(const double* A, uint32_t lo, uint32_t hi)
+{
+    uint32_t iMax = lo;
+
+    for (uint32_t i = lo + 1; i <= hi; i++)
+        if (A[i] > A[iMax])
+            iMax = i;
+
+    return iMax;
+}
+
+/**
+  Fractional bin offset of a spectral line, parabolic interpolation
+
+**/
+static double SpectrumInterpolate(const double* A, uint32_t i, uint32_t nBins)
+{
+    double a, b, c, d;
+
+    if (0 == i || i + 1 >= nBins)
+        return 0.0;
+
+    a = A[i - 1], b = A[i], c = A[i + 1];
+    d = a - 2.0 * b + c;
+
+    return 0.0 == d ? 0.0 : 0.5 * (a - c) / d;
+}
+
+/**
+  Hann window amplitude correction for a spectral line d bins off the bin center
+
+**/
+static double SpectrumScallop(double d)
+{
+    if (fabs(d) < 1e-6)
+        return 1.0;
+
+    return (1.0 - d * d) * SPEC_PI * d / sin(SPEC_PI * d);
+}
+
+/**
+  Amplitude spectra of the fractional frequency deviation and of the phase
+
+  y[k] is taken from consecutive phase samples, the mean (frequency offset) is
+  removed, samples beyond +/-dblClip are replaced by the mean, a Hann window is
+  applied and the single sided amplitude spectrum is calculated by FFT.
+  The phase spectrum is derived from it:
+
+    |X(f)| = |Y(f)| * tau0 / (2 * sin(PI * f / fs))
+
+  @param  pRec          phase record, n + 1 samples used
+  @param  n             FFT length
+  @param  dblTau0       sample interval in seconds
+  @param  dblTSCPerSec  nominal TSC frequency
+  @param  dblClip       outlier limit of y, 0.0 for none
+  @param  re            out: frequency deviation spectrum, n / 2 bins
+  @param  im            out: phase spectrum in seconds, n / 2 bins
+  @param  wr            twiddle factors
+  @param  wi            twiddle factors
+  @param  pcntClip      out: number of outliers replaced, may be NULL
+
+  @retval mean fractional frequency offset
+
+**/
+static double SpectrumCompute(PHASE_RECORD* pRec, uint32_t n, double dblTau0, double dblTSCPerSec, double dblClip, double* re, double* im, const double* wr, const double* wi, uint32_t* pcntClip)
+{
+    double dblMean = 0.0;
+    uint32_t cntClip = 0;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        re[k] = ((double)(int64_t)(pRec->rgqwTSC[k + 1] - pRec->rgqwTSC[k]) / dblTSCPerSec - dblTau0) / dblTau0;
+        dblMean += re[k];
+    }
+    dblMean /= n;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        double y = re[k] - dblMean;
+
+        if (0.0 != dblClip && fabs(y) > dblClip)
+            y = 0.0, cntClip++;
+
+        re[k] = y * (0.5 - 0.5 * cos(2.0 * SPEC_PI * k / n));
+        im[k] = 0.0;
+    }
+
+    SpectrumFft(re, im, wr, wi, n);
+
+    //
+    // single sided amplitude spectra, Hann coherent gain 0.5
+    //
+    for (uint32_t k = 0; k < n / 2; k++)
+    {
+        double dblY = 4.0 * sqrt(re[k] * re[k] + im[k] * im[k]) / n;
+
+        re[k] = dblY;
+        im[k] = 0 == k ? 0.0 : dblY * dblTau0 / (2.0 * sin(SPEC_PI * k / n));
+    }
+
+    if (NULL != pcntClip)
+        *pcntClip = cntClip;
+
+    return dblMean;
+}
+
+/**
+  Outlier limit of the fractional frequency deviation
+
+  SPEC_CLIP times the robust standard deviation (median absolute deviation / 0.6745),
+  estimated on every SPEC_CLIPDECIM'th sample.
+
+  @param  pRec          phase record, n + 1 samples used
+  @param  n             FFT length
+  @param  dblTau0       sample interval in seconds
+  @param  dblTSCPerSec  nominal TSC frequency
+  @param  dblMean       mean fractional frequency offset
+  @param  pScratch      n / SPEC_CLIPDECIM entries
+
+**/
+static double SpectrumClip(PHASE_RECORD* pRec, uint32_t n, double dblTau0, double dblTSCPerSec, double dblMean, double* pScratch)
+{
+    uint32_t cnt = 0;
+
+    for (uint32_t k = 0; k < n; k += SPEC_CLIPDECIM)
+        pScratch[cnt++] = fabs(((double)(int64_t)(pRec->rgqwTSC[k + 1] - pRec->rgqwTSC[k]) / dblTSCPerSec - dblTau0) / dblTau0 - dblMean);
+
+    qsort(pScratch, cnt, sizeof(double), SpectrumCmp);
+
+    return SPEC_CLIP * pScratch[cnt / 2] / 0.6745;
+}
+
+/**
+  Spectral analysis of a TSC vs. reference phase record
+
+  Spread spectrum clocking shows up as the fundamental of the triangular frequency
+  modulation in the frequency deviation spectrum. The peak-to-peak deviation of a
+  triangle is PI^2 / 4 times its fundamental amplitude.
+
+  A periodic SMI that hits between reading the reference counter and the TSC delays
+  the TSC timestamp by the SMI duration. The resulting phase spikes form a comb of
+  harmonics of the SMI rate in the phase spectrum. The lowest line that is confirmed
+  by at least two of its harmonics is taken as the fundamental.
+
+  The comb reaches far into the SSC range. If phase spikes are present, the
+  spectrum is calculated a second time with the spikes removed to search for SSC.
+
+  @param  pRec          phase record with 2^n + 1 samples, surplus samples are ignored
+  @param  dblRefFreq    reference counter frequency in Hz
+  @param  dblTSCPerSec  nominal TSC frequency
+  @param  pResult       result
+
+  @retval 0 on success, -1 on failure (record too short, out of memory)
+
+**/
+int SpectrumAnalyze(PHASE_RECORD* pRec, double dblRefFreq, double dblTSCPerSec, SPECTRUM_RESULT* pResult)
+{
+    double dblTau0 = pRec->dwTicksPerSample / dblRefFreq;
+    double* re = NULL, * im = NULL, * wr = NULL, * wi = NULL, * floorY = NULL, * floorX = NULL;
+    uint32_t n = 1, nBins;
+    int nRet = -1;
+
+    memset(pResult, 0, sizeof(SPECTRUM_RESULT));
+
+    while (pRec->cnt > 0 && 2 * n <= pRec->cnt - 1 && 2 * n <= (1U << SPEC_MAXLOG2N))
+        n *= 2;
+
+    nBins = n / 2;
+
+    pResult->cntSamples = n;
+    pResult->dblFs = 1.0 / dblTau0;
+    pResult->dblDf = pResult->dblFs / n;
+    pResult->dblTSCPerSec = dblTSCPerSec;
+
+    do {
+        double dblDf = pResult->dblDf, dblClip;
+
+        if (n < 4 * SPEC_FLOORBINS)
+            break;
+
+        re = malloc(n * sizeof(double));
+        im = malloc(n * sizeof(double));
+        wr = malloc(n * sizeof(double));
+        wi = malloc(n * sizeof(double));
+        floorY = malloc((nBins / SPEC_FLOORBINS + 1) * sizeof(double));
+        floorX = malloc((nBins / SPEC_FLOORBINS + 1) * sizeof(double));
+
+        if (NULL == re || NULL == im || NULL == wr || NULL == wi || NULL == floorY || NULL == floorX)
+            break;
+
+        SpectrumTwiddle(wr, wi, n);
+
+        pResult->dblFreqOffset = SpectrumCompute(pRec, n, dblTau0, dblTSCPerSec, 0.0, re, im, wr, wi, NULL);
+
+        SpectrumFloor(re, nBins, floorY);
+        SpectrumFloor(im, nBins, floorX);
+
+        //
+        // periodic SMI
+        //
+        if (1)
+        {
+            uint32_t lo = (uint32_t)ceil(SPEC_SMI_FMIN / dblDf), hi = (uint32_t)(SPEC_SMI_FMAX / dblDf);
+
+            lo = lo < 4 ? 4 : lo;
+            hi = hi > nBins - 2 ? nBins - 2 : hi;
+
+            for (uint32_t i = lo; i <= hi && 0 == pResult->fSMI; i++)
+            {
+                double dblBin;
+                uint32_t cntHarm = 1;
+
+                if (!(im[i] > im[i - 1] && im[i] >= im[i + 1]) || SpectrumSNR(im, floorX, i) <= SPEC_SNR)
+                    continue;
+
+                dblBin = i + SpectrumInterpolate(im, i, nBins);
+
+                for (uint32_t k = 2; k <= SPEC_SMI_MAXHARM && k * dblBin + 3 < nBins; k++)
+                {
+                    uint32_t c = (uint32_t)(k * dblBin + 0.5);
+                    uint32_t h = SpectrumMaxBin(im, c - 2, c + 2);
+
+                    if (SpectrumSNR(im, floorX, h) > SPEC_SNR)
+                        cntHarm++;
+                }
+
+                if (cntHarm >= 3)
+                {
+                    //
+                    // refine the fundamental on higher harmonics, the error is divided by k
+                    //
+                    for (uint32_t k = 2; k * dblBin + 3 < nBins; k *= 2)
+                    {
+                        uint32_t c = (uint32_t)(k * dblBin + 0.5);
+                        uint32_t h = SpectrumMaxBin(im, c - 2, c + 2);
+
+                        if (SpectrumSNR(im, floorX, h) <= SPEC_SNR)
+                            break;
+
+                        dblBin = (h + SpectrumInterpolate(im, h, nBins)) / k;
+                    }
+
+                    pResult->fSMI = 1;
+                    pResult->dblSMIPeriod = 1.0 / (dblBin * dblDf);
+                    pResult->dblSMIAmpl = im[i];
+                    pResult->cntSMIHarm = cntHarm;
+                }
+            }
+        }
+
+        //
+        // strongest spectral lines, local maxima with highest SNR
+        //
+        for (uint32_t i = 4; i + 1 < nBins; i++)
+        {
+            double dblSNR;
+            uint32_t j;
+
+            if (!(re[i] > re[i - 1] && re[i] >= re[i + 1]))
+                continue;
+
+            dblSNR = SpectrumSNR(re, floorY, i);
+
+            if (dblSNR <= SPEC_SNR)
+                continue;
+
+            for (j = pResult->cntPeak; j > 0 && pResult->rgPeak[j - 1].dblSNR < dblSNR; j--)
+                if (j < SPEC_MAXPEAK)
+                    pResult->rgPeak[j] = pResult->rgPeak[j - 1];
+
+            if (j < SPEC_MAXPEAK)
+            {
+                pResult->rgPeak[j].dblFreq = (i + SpectrumInterpolate(re, i, nBins)) * dblDf;
+                pResult->rgPeak[j].dblFreqDev = re[i];
+                pResult->rgPeak[j].dblPhase = im[i];
+                pResult->rgPeak[j].dblSNR = dblSNR;
+
+                if (pResult->cntPeak < SPEC_MAXPEAK)
+                    pResult->cntPeak++;
+            }
+        }
+
+        //
+        // log spaced, max hold spectrum for display/export
+        //
+        for (uint32_t j = 1, bPrev = 1; j <= SPEC_MAXPLOT && bPrev < nBins; j++)
+        {
+            uint32_t b1 = (uint32_t)pow((double)nBins, (double)j / SPEC_MAXPLOT), bMax = bPrev;
+            double dblY = 0.0, dblX = 0.0;
+
+            if (b1 <= bPrev)
+                continue;
+
+            b1 = b1 > nBins ? nBins : b1;
+
+            for (uint32_t b = bPrev; b < b1; b++)
+            {
+                if (re[b] > dblY)
+                    dblY = re[b], bMax = b;
+                if (im[b] > dblX)
+                    dblX = im[b];
+            }
+
+            pResult->rgdblPlotFreq[pResult->cntPlot] = bMax * dblDf;
+            pResult->rgdblPlotFreqDev[pResult->cntPlot] = dblY;
+            pResult->rgdblPlotPhase[pResult->cntPlot] = dblX;
+            pResult->cntPlot++;
+
+            bPrev = b1;
+        }
+
+        //
+        // remove phase spikes for SSC detection
+        //
+        dblClip = SpectrumClip(pRec, n, dblTau0, dblTSCPerSec, pResult->dblFreqOffset, im);
+
+        SpectrumCompute(pRec, n, dblTau0, dblTSCPerSec, dblClip, re, im, wr, wi, &pResult->cntSpikes);
+        SpectrumFloor(re, nBins, floorY);
+
+        //
+        // spread spectrum clocking
+        //
+        if (1)
+        {
+            uint32_t lo = (uint32_t)ceil(SPEC_SSC_FMIN / dblDf), hi = (uint32_t)(SPEC_SSC_FMAX / dblDf);
+
+            hi = hi > nBins - 2 ? nBins - 2 : hi;
+
+            if (lo < hi)
+            {
+                uint32_t i = SpectrumMaxBin(re, lo, hi);
+
+                if (SpectrumSNR(re, floorY, i) > SPEC_SNR)
+                {
+                    double d = SpectrumInterpolate(re, i, nBins);
+
+                    pResult->fSSC = 1;
+                    pResult->dblSSCRate = (i + d) * dblDf;
+                    pResult->dblSSCAmpl = re[i] * SpectrumScallop(d);
+                    pResult->dblSSCDepth = pResult->dblSSCAmpl * SPEC_PI * SPEC_PI / 4.0;
+                }
+            }
+        }
+
+        nRet = 0;
+
+    } while (0);
+
+    free(re);
+    free(im);
+    free(wr);
+    free(wi);
+    free(floorY);
+    free(floorX);
+
+    return nRet;
+}
@@ -0,0 +1,97 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Spectrum.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    spectral analysis of TSC vs. reference phase, spread spectrum clocking and periodic SMI detection
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _SPECTRUM_H_
+#define _SPECTRUM_H_
+
+#include <stdint.h>
+#include "PhaseRecord.h"
+
+#define SPEC_TICKS_PER_SAMPLE   8                       // ACPI ticks per sample, 447kHz, about the ACPI timer read rate
+#define SPEC_MINLOG2N           16                      // min. FFT length 2^16
+#define SPEC_MAXLOG2N           22                      // max. FFT length 2^22, 9.4s at 447kHz
+#define SPEC_DFLT_SECONDS       4                       // default capture time in seconds, rounded up to 2^n samples
+#define SPEC_MAXPLOT            1024                    // number of log spaced spectrum points kept for display/export
+#define SPEC_MAXPEAK            8                       // number of spectral lines reported
+#define SPEC_FLOORBINS          128                     // noise floor is the median of SPEC_FLOORBINS adjacent bins
+#define SPEC_SNR                10.0                    // spectral line must exceed noise floor by this factor
+#define SPEC_CLIP               8.0                     // phase spike limit for SSC detection, in robust standard deviations
+#define SPEC_CLIPDECIM          16                      // decimation of the samples the spike limit is estimated on
+#define SPEC_SSC_FMIN           20000.0                 // spread spectrum modulation search range, typ. 30..33kHz
+#define SPEC_SSC_FMAX           70000.0
+#define SPEC_SMI_FMIN           0.5                     // periodic SMI fundamental search range
+#define SPEC_SMI_FMAX           2000.0
+#define SPEC_SMI_MAXHARM        8                       // harmonics checked to confirm a periodic SMI comb
+
+typedef struct _SPECTRUM_PEAK {
+    double dblFreq;                                     // frequency in Hz
+    double dblFreqDev;                                  // amplitude of fractional frequency deviation
+    double dblPhase;                                    // amplitude of phase/time error in seconds
+    double dblSNR;                                      // amplitude above noise floor
+}SPECTRUM_PEAK;
+
+typedef struct _SPECTRUM_RESULT {
+    uint32_t cntSamples;                                // FFT length
+    double dblFs;                                       // sample rate in Hz
+    double dblDf;                                       // frequency resolution in Hz
+    double dblTSCPerSec;                                // nominal TSC frequency
+    double dblFreqOffset;                               // mean fractional frequency offset, removed before FFT
+    uint32_t cntSpikes;                                 // number of phase spike samples removed for SSC detection
+    //
+    // spread spectrum clocking, fundamental of triangular frequency modulation
+    //
+    int fSSC;                                           // SSC detected
+    double dblSSCRate;                                  // modulation rate in Hz
+    double dblSSCDepth;                                 // peak-to-peak fractional frequency deviation, triangular profile assumed
+    double dblSSCAmpl;                                  // fundamental amplitude, fractional frequency deviation
+    //
+    // periodic SMI, comb of harmonics in the phase spectrum
+    //
+    int fSMI;                                           // periodic SMI detected
+    double dblSMIPeriod;                                // period in seconds
+    double dblSMIAmpl;                                  // fundamental amplitude, phase in seconds
+    uint32_t cntSMIHarm;                                // number of harmonics found, including fundamental
+    //
+    // strongest spectral lines, highest SNR first
+    //
+    uint32_t cntPeak;
+    SPECTRUM_PEAK rgPeak[SPEC_MAXPEAK];
+    //
+    // log spaced, max hold spectrum
+    //
+    uint32_t cntPlot;
+    double rgdblPlotFreq[SPEC_MAXPLOT];                 // frequency in Hz
+    double rgdblPlotFreqDev[SPEC_MAXPLOT];              // fractional frequency deviation
+    double rgdblPlotPhase[SPEC_MAXPLOT];                // phase/time error in seconds
+}SPECTRUM_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int SpectrumAnalyze(PHASE_RECORD* pRec, double dblRefFreq, double dblTSCPerSec, SPECTRUM_RESULT* pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_SPECTRUM_H_
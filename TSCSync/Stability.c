@@ -0,0 +1,216 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Stability.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    oscillator stability analysis, overlapping Allan deviation, MTIE and TIE
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Stability.h"
+
+/**
+  Maximum time interval error for observation interval m * tau0
+
+  The peak-to-peak phase within each window of m + 1 consecutive samples is
+  tracked with two monotonic deques of sample indices, one for the minimum and
+  one for the maximum. Each index is pushed and popped once, O(N) per tau
+  instead of O(N * m) for the naive window scan.
+
+  @param  x         phase/TIE samples in seconds
+  @param  n         number of samples
+  @param  m         window length in samples
+  @param  dqMin     scratch buffer of n entries
+  @param  dqMax     scratch buffer of n entries
+
+  @retval MTIE in seconds
+
+**/
+static double StabilityMtie(const double* x, uint32_t n, uint32_t m, uint32_t* dqMin, uint32_t* dqMax)
+{
+    uint32_t hMin = 0, tMin = 0, hMax = 0, tMax = 0;
+    double dblMtie = 0.0;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        while (tMax > hMax && x[dqMax[tMax - 1]] <= x[i])
+            tMax--;
+        dqMax[tMax++] = i;
+
+        while (tMin > hMin && x[dqMin[tMin - 1]] >= x[i])
+            tMin--;
+        dqMin[tMin++] = i;
+
+        if (i >= m)                                     // window [i - m, i] complete
+        {
+            double d;
+
+            while (dqMax[hMax] < i - m)
+                hMax++;
+            while (dqMin[hMin] < i - m)
+                hMin++;
+
+            d = x[dqMax[hMax]] - x[dqMin[hMin]];
+
+            if (d > dblMtie)
+                dblMtie = d;
+        }
+    }
+    return dblMtie;
+}
+
+/**
+  Overlapping Allan deviation for averaging time m * tau0, from phase data
+
+                   1            N-2m-1
+    AVAR = ------------------     SUM   (x[i+2m] - 2x[i+m] + x[i])^2
+           2 (m tau0)^2 (N-2m)    i=0
+
+  @param  x         phase samples in seconds
+  @param  n         number of samples
+  @param  m         averaging factor
+  @param  dblTau0   sample interval in seconds
+
+  @retval ADEV
+
+**/
+static double StabilityAdev(const double* x, uint32_t n, uint32_t m, double dblTau0)
+{
+    double dblSum = 0.0, dblTau = m * dblTau0;
+
+    for (uint32_t i = 0; i + 2 * m < n; i++)
+    {
+        double d = x[i + 2 * m] - 2 * x[i + m] + x[i];
+        dblSum += d * d;
+    }
+
+    return sqrt(dblSum / (2.0 * dblTau * dblTau * (double)(n - 2 * m)));
+}
+
+/**
+  Analyze a TSC vs. reference phase record
+
+  Phase x[k] = TSC[k] / dblTSCPerSec - k * tau0 is the time error of the
+  TSC based clock against the reference counter. The fractional frequency
+  offset is removed by a least squares fit, the residue is the TIE.
+  ADEV is independent of that, MTIE and TIE are given with offset removed.
+
+  Tau values are 1-2-5 log spaced from tau0 up to a quarter of the record length.
+
+  @param  pRec          phase record
+  @param  dblRefFreq    reference counter frequency in Hz
+  @param  dblTSCPerSec  nominal TSC frequency
+  @param  pResult       result
+
+  @retval 0 on success, -1 on failure (record too short, out of memory)
+
+**/
+int StabilityAnalyze(PHASE_RECORD* pRec, double dblRefFreq, double dblTSCPerSec, STABILITY_RESULT* pResult)
+{
+    uint32_t n = pRec->cnt;
+    double dblTau0 = pRec->dwTicksPerSample / dblRefFreq;
+    double* x = NULL;
+    uint32_t* dqMin = NULL, * dqMax = NULL;
+    int nRet = -1;
+
+    memset(pResult, 0, sizeof(STABILITY_RESULT));
+
+    pResult->cntSamples = n;
+    pResult->dblTau0 = dblTau0;
+    pResult->dblTSCPerSec = dblTSCPerSec;
+
+    do {
+        double dblMeanK = (n - 1) / 2.0, dblMeanX = 0.0, dblSxy = 0.0, dblSxx = 0.0, dblSlope;
+
+        if (n < 8)
+            break;
+
+        x = malloc(n * sizeof(double));
+        dqMin = malloc(n * sizeof(uint32_t));
+        dqMax = malloc(n * sizeof(uint32_t));
+
+        if (NULL == x || NULL == dqMin || NULL == dqMax)
+            break;
+
+        //
+        // phase in seconds
+        //
+        for (uint32_t k = 0; k < n; k++)
+        {
+            x[k] = (double)pRec->rgqwTSC[k] / dblTSCPerSec - k * dblTau0;
+            dblMeanX += x[k];
+        }
+        dblMeanX /= n;
+
+        //
+        // remove frequency offset, least squares fit
+        //
+        for (uint32_t k = 0; k < n; k++)
+        {
+            dblSxy += (k - dblMeanK) * (x[k] - dblMeanX);
+            dblSxx += (k - dblMeanK) * (k - dblMeanK);
+        }
+        dblSlope = dblSxy / dblSxx;
+
+        for (uint32_t k = 0; k < n; k++)
+            x[k] -= dblMeanX + dblSlope * (k - dblMeanK);
+
+        pResult->dblFreqOffset = dblSlope / dblTau0;
+
+        //
+        // ADEV, MTIE for 1-2-5 log spaced tau
+        //
+        for (uint32_t decade = 1; pResult->cntTau < STAB_MAXTAU && decade <= n / 4; decade *= 10)
+        {
+            static const uint32_t rgMul[] = { 1,2,5 };
+
+            for (int i = 0; i < 3 && pResult->cntTau < STAB_MAXTAU; i++)
+            {
+                uint32_t m = decade * rgMul[i];
+
+                if (m > n / 4)
+                    break;
+
+                pResult->rgdblTau[pResult->cntTau] = m * dblTau0;
+                pResult->rgdblAdev[pResult->cntTau] = StabilityAdev(x, n, m, dblTau0);
+                pResult->rgdblMtie[pResult->cntTau] = StabilityMtie(x, n, m, dqMin, dqMax);
+                pResult->cntTau++;
+            }
+        }
+
+        //
+        // decimated TIE for display/export
+        //
+        pResult->dwTieStep = (n + STAB_MAXTIE - 1) / STAB_MAXTIE;
+
+        for (uint32_t k = 0; k < n && pResult->cntTie < STAB_MAXTIE; k += pResult->dwTieStep)
+            pResult->rgdblTie[pResult->cntTie++] = x[k];
+
+        nRet = 0;
+
+    } while (0);
+
+    free(x);
+    free(dqMin);
+    free(dqMax);
+
+    return nRet;
+}
@@ -0,0 +1,57 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Stability.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    oscillator stability analysis, overlapping Allan deviation, MTIE and TIE
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _STABILITY_H_
+#define _STABILITY_H_
+
+#include <stdint.h>
+#include "PhaseRecord.h"
+
+#define STAB_MAXTAU         64                          // max. number of tau values, 1-2-5 log spaced
+#define STAB_MAXTIE         4096                        // max. number of TIE samples kept for display/export
+#define STAB_DFLT_SECONDS   60                          // default phase record length in seconds
+
+typedef struct _STABILITY_RESULT {
+    uint32_t cntSamples;                                // number of phase samples analyzed
+    double dblTau0;                                     // sample interval in seconds
+    double dblTSCPerSec;                                // nominal TSC frequency the phase is calculated with
+    double dblFreqOffset;                               // fractional frequency offset removed from TIE
+    uint32_t cntTau;                                    // number of tau values
+    double rgdblTau[STAB_MAXTAU];                       // averaging/observation time in seconds
+    double rgdblAdev[STAB_MAXTAU];                      // overlapping Allan deviation
+    double rgdblMtie[STAB_MAXTAU];                      // maximum time interval error in seconds
+    uint32_t cntTie;                                    // number of TIE samples in rgdblTie
+    uint32_t dwTieStep;                                 // decimation of rgdblTie
+    double rgdblTie[STAB_MAXTIE];                       // time interval error in seconds, frequency offset removed
+}STABILITY_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int StabilityAnalyze(PHASE_RECORD* pRec, double dblRefFreq, double dblTSCPerSec, STABILITY_RESULT* pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_STABILITY_H_
@@ -0,0 +1,401 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TimerLibBench.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    side-by-side benchmark of TianoCore TimerLib MicroSecondDelay()/NanoSecondDelay() implementations
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <conio.h>
+#include <intrin.h>
+#include "TimerLibBench.h"
+#include "ClkWait.h"
+#include "ApicTimer.h"
+#include "TscPolicy.h"
+
+volatile uint8_t* gpHpetMmio;
+
+const uint32_t grgdwTlbDelayUs[TLB_NUMDELAY] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+static const char* grgstrTlbName[TLB_NUMLIB] = {
+    "AcpiTimerLib",
+    "8254 one-shot",
+    "HPET",
+    "X86TimerLib APIC",
+    "TscTimerLib",
+    "CpuTimerLib CPUID",
+};
+
+static uint64_t gqwTlbFreq[TLB_NUMLIB];                // counter frequency as determined by the library itself
+
+//
+// NOTE:    The implementations below follow the TianoCore sources, TianoCore types and
+//          library calls are replaced by their TSCSync equivalents. Each library determines
+//          its counter frequency the way it does in firmware, right or wrong.
+//
+
+//
+// PcAtChipsetPkg AcpiTimerLib
+//
+static void TlbAcpiMicroSecondDelay(uint64_t MicroSeconds)
+{
+    InternalAcpiDelay((uint32_t)(MicroSeconds * 3579545 / 1000000u), NULL);
+}
+
+static void TlbAcpiNanoSecondDelay(uint64_t NanoSeconds)
+{
+    InternalAcpiDelay((uint32_t)(NanoSeconds * 3579545 / 1000000000u), NULL);
+}
+
+//
+// PC/AT 8254 channel 2 one-shot, MODE 0 in 65535 tick slices, OUT2 goes high on terminal count
+//
+static void TlbPitDelay(uint32_t Ticks)
+{
+    uint8_t b61 = (uint8_t)inp(0x61);
+
+    while (0 != Ticks)
+    {
+        uint32_t n = Ticks > 0xFFFF ? 0xFFFF : Ticks;
+
+        Ticks -= n;
+
+        outp(0x61, b61 & ~0x03);                        // gate off, speaker off
+        outp(0x43, (2/*TIMER*/ << 6) + 0x30);           // program timer 2 for MODE 0
+        outp(0x42, 0xFF & n);                           // write counter value low
+        outp(0x42, 0xFF & (n >> 8));                    // write counter value high
+        outp(0x61, (b61 & ~0x02) | 0x01);               // gate on, count down starts
+
+        while (0 == (0x20 & inp(0x61)))                 // wait for OUT2
+            _mm_pause();
+    }
+
+    outp(0x61, 0);                                      // stop counter
+    outp(0x43, (2/*TIMER*/ << 6) + 0x34);               // program timer 2 for MODE 2
+    outp(0x42, 0x0);                                    // write counter value low 65536
+    outp(0x42, 0x0);                                    // write counter value high 65536
+    outp(0x61, 1);                                      // start counter, as expected by PITClkWait()
+}
+
+static void TlbPitMicroSecondDelay(uint64_t MicroSeconds)
+{
+    TlbPitDelay((uint32_t)(MicroSeconds * gqwTlbFreq[TLB_PIT] / 1000000u));
+}
+
+static void TlbPitNanoSecondDelay(uint64_t NanoSeconds)
+{
+    TlbPitDelay((uint32_t)(NanoSeconds * gqwTlbFreq[TLB_PIT] / 1000000000u));
+}
+
+//
+// HPET main counter, low 32 bit, start + delay compare
+//
+static void TlbHpetDelay(uint32_t Ticks)
+{
+    uint32_t StartTick = *(volatile uint32_t*)(gpHpetMmio + HPET_MAIN_COUNTER);
+
+    while ((uint32_t)(*(volatile uint32_t*)(gpHpetMmio + HPET_MAIN_COUNTER) - StartTick) < Ticks)
+        _mm_pause();
+}
+
+static void TlbHpetMicroSecondDelay(uint64_t MicroSeconds)
+{
+    TlbHpetDelay((uint32_t)(MicroSeconds * gqwTlbFreq[TLB_HPET] / 1000000u));
+}
+
+static void TlbHpetNanoSecondDelay(uint64_t NanoSeconds)
+{
+    TlbHpetDelay((uint32_t)(NanoSeconds * gqwTlbFreq[TLB_HPET] / 1000000000u));
+}
+
+//
+// UefiCpuPkg SecPeiDxeTimerLibUefiCpu InternalX86Delay(), timer programmed by ApicTimerInit()
+//
+static void TlbApicDelay(uint32_t Delay)
+{
+    int32_t Ticks;
+    uint32_t Times;
+    uint32_t InitCount = 0xFFFFFFFF;
+    uint32_t StartTick;
+
+    //
+    // separate a large Delay into slots of half the init count, not to miss the timeout
+    //
+    Times = Delay / (InitCount / 2);
+    Delay = Delay % (InitCount / 2);
+
+    StartTick = ApicTimerRead();
+    do {
+        do {
+            _mm_pause();
+            Ticks = (int32_t)(StartTick - ApicTimerRead());
+            if (Ticks < 0)                              // timer wrap-around
+                Ticks += InitCount;
+        } while ((uint32_t)Ticks < Delay);
+
+        StartTick -= (StartTick > Delay) ? Delay : (Delay - InitCount);
+        Delay = InitCount / 2;
+    } while (Times-- > 0);
+}
+
+static void TlbApicMicroSecondDelay(uint64_t MicroSeconds)
+{
+    TlbApicDelay((uint32_t)(gqwTlbFreq[TLB_APIC] * MicroSeconds / 1000000u));
+}
+
+static void TlbApicNanoSecondDelay(uint64_t NanoSeconds)
+{
+    TlbApicDelay((uint32_t)(gqwTlbFreq[TLB_APIC] * NanoSeconds / 1000000000u));
+}
+
+//
+// PcAtChipsetPkg TscTimerLib and UefiCpuPkg CpuTimerLib InternalX86Delay(), TSC target compare
+//
+static void TlbTscDelay(uint64_t Delay)
+{
+    uint64_t Ticks = __rdtsc() + Delay;
+
+    while (__rdtsc() <= Ticks)
+        _mm_pause();
+}
+
+static void TlbTscAcpiMicroSecondDelay(uint64_t MicroSeconds)
+{
+    TlbTscDelay(MicroSeconds * gqwTlbFreq[TLB_TSC_ACPI] / 1000000u);
+}
+
+static void TlbTscAcpiNanoSecondDelay(uint64_t NanoSeconds)
+{
+    TlbTscDelay(NanoSeconds * gqwTlbFreq[TLB_TSC_ACPI] / 1000000000u);
+}
+
+static void TlbTscCpuidMicroSecondDelay(uint64_t MicroSeconds)
+{
+    TlbTscDelay(MicroSeconds * gqwTlbFreq[TLB_TSC_CPUID] / 1000000u);
+}
+
+static void TlbTscCpuidNanoSecondDelay(uint64_t NanoSeconds)
+{
+    TlbTscDelay(NanoSeconds * gqwTlbFreq[TLB_TSC_CPUID] / 1000000000u);
+}
+
+static void (* const grgpfnTlbMicro[TLB_NUMLIB])(uint64_t) = {
+    TlbAcpiMicroSecondDelay, TlbPitMicroSecondDelay, TlbHpetMicroSecondDelay,
+    TlbApicMicroSecondDelay, TlbTscAcpiMicroSecondDelay, TlbTscCpuidMicroSecondDelay,
+};
+
+static void (* const grgpfnTlbNano[TLB_NUMLIB])(uint64_t) = {
+    TlbAcpiNanoSecondDelay, TlbPitNanoSecondDelay, TlbHpetNanoSecondDelay,
+    TlbApicNanoSecondDelay, TlbTscAcpiNanoSecondDelay, TlbTscCpuidNanoSecondDelay,
+};
+
+/**
+  PcAtChipsetPkg TscTimerLib InternalCalculateTscFrequency(), TSC across 3579 ACPI ticks times 1000
+
+**/
+static uint64_t TlbTscAcpiFrequency(void)
+{
+    uint32_t BIT23 = 1 << 23;
+    uint32_t Ticks;
+    uint64_t StartTSC, EndTSC;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    Ticks = GetACPICount(gPmTmrBlkAddr) + TLB_TSCACPI_TICKS;
+    StartTSC = __rdtsc();
+    while (((Ticks - GetACPICount(gPmTmrBlkAddr)) & BIT23) == 0)
+        _mm_pause();
+    EndTSC = __rdtsc();
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return (EndTSC - StartTSC) * 1000;
+}
+
+/**
+  UefiCpuPkg CpuTimerLib CpuidCoreClockCalculateTscFrequency(), 0 if CPUID.15h is not supported
+
+**/
+static uint64_t TlbTscCpuidFrequency(void)
+{
+    int cpuInfo[4] = { 0,0,0,0 };
+    uint64_t CoreXtalFrequency;
+
+    __cpuid(cpuInfo, 0);
+    if ((uint32_t)cpuInfo[0] < 0x15)
+        return 0;
+
+    __cpuid(cpuInfo, 0x15);
+    if (0 == cpuInfo[0] || 0 == cpuInfo[1])             // EAX denominator, EBX numerator
+        return 0;
+
+    CoreXtalFrequency = 0 != cpuInfo[2] ? (uint32_t)cpuInfo[2] : TLB_CRYSTALCLOCK;
+
+    return (CoreXtalFrequency * (uint32_t)cpuInfo[1] + ((uint32_t)cpuInfo[0] >> 1)) / (uint32_t)cpuInfo[0];
+}
+
+/**
+  Measure one delay point, each call with interrupts disabled
+
+**/
+static void TlbMeasure(TLB_POINT* pPoint, void (*pfnDelay)(uint64_t), uint64_t qwRequested, uint32_t dwRequestedUs, double dblTSCPerUs)
+{
+    uint32_t cntReps = TLB_POINT_US / dwRequestedUs;
+    double dblSum = 0.0;
+
+    cntReps = cntReps < 1 ? 1 : (cntReps > TLB_MAXREPS ? TLB_MAXREPS : cntReps);
+
+    pPoint->qwRequested = qwRequested;
+    pPoint->cntReps = cntReps;
+    pPoint->dblMinUs = 1e30;
+    pPoint->dblMaxUs = 0.0;
+
+    for (uint32_t r = 0; r < cntReps; r++)
+    {
+        uint64_t qwTSCStart, qwTSCEnd;
+        double dblUs;
+        size_t eflags = __readeflags();                 // save flaags
+
+        _disable();
+
+        qwTSCStart = ReadTSC();
+        (*pfnDelay)(qwRequested);
+        qwTSCEnd = ReadTSC();
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        dblUs = (double)(qwTSCEnd - qwTSCStart) / dblTSCPerUs;
+        dblSum += dblUs;
+        pPoint->dblMinUs = dblUs < pPoint->dblMinUs ? dblUs : pPoint->dblMinUs;
+        pPoint->dblMaxUs = dblUs > pPoint->dblMaxUs ? dblUs : pPoint->dblMaxUs;
+    }
+
+    pPoint->dblAvgUs = dblSum / cntReps;
+    pPoint->dblErrPct = (pPoint->dblAvgUs - dwRequestedUs) * 100.0 / dwRequestedUs;
+}
+
+/**
+  Measure MicroSecondDelay() and NanoSecondDelay() of each TimerLib across 1us..1s
+
+  The actual delay is measured by the TSC, calibrated by TSCSync. Libraries depending
+  on hardware that is not available or not owned by TSCSync are skipped. An HPET
+  disabled by firmware is enabled for the run and disabled afterwards.
+
+  @param  pResult       result
+  @param  dblTSCPerSec  reference TSC frequency
+
+  @retval number of libraries measured
+
+**/
+int TimerLibBenchRun(TLB_RESULT* pResult, double dblTSCPerSec)
+{
+    double dblTSCPerUs = dblTSCPerSec / 1e6;
+    uint32_t dwHpetConf = 0;
+
+    memset(pResult, 0, sizeof(TLB_RESULT));
+    pResult->dblTSCPerSec = dblTSCPerSec;
+
+    if (NULL != gpHpetMmio)
+    {
+        dwHpetConf = *(volatile uint32_t*)(gpHpetMmio + HPET_GEN_CONF);
+        if (0 == (1 & dwHpetConf))
+            *(volatile uint32_t*)(gpHpetMmio + HPET_GEN_CONF) = dwHpetConf | 1;
+    }
+
+    gqwTlbFreq[TLB_ACPI] = 3579545;
+    gqwTlbFreq[TLB_PIT] = 1193182;
+    gqwTlbFreq[TLB_HPET] = 0;
+    if (NULL != gpHpetMmio)
+    {
+        uint32_t dwPeriod = *(volatile uint32_t*)(gpHpetMmio + HPET_GCAP_ID + 4);     // COUNTER_CLK_PERIOD in fs
+
+        if (0 != dwPeriod && dwPeriod <= HPET_MAXPERIOD)
+            gqwTlbFreq[TLB_HPET] = 1000000000000000ULL / dwPeriod;
+    }
+    gqwTlbFreq[TLB_APIC] = gApicTimerResult.fOwned ? TLB_FSBCLOCK / 1 : 0;     // divide by 1, ApicTimerInit()
+    gqwTlbFreq[TLB_TSC_ACPI] = 0 != gPmTmrBlkAddr || 0 != gfPmTmrMmio ? TlbTscAcpiFrequency() : 0;
+    gqwTlbFreq[TLB_TSC_CPUID] = TlbTscCpuidFrequency();
+
+    for (int n = 0; n < TLB_NUMLIB; n++)
+    {
+        TLB_LIB* pLib = &pResult->rgLib[n];
+
+        pLib->pstrName = grgstrTlbName[n];
+        pLib->qwFreq = gqwTlbFreq[n];
+        pLib->fAvailable = 0 != gqwTlbFreq[n] && (TLB_ACPI != n || 0 != gPmTmrBlkAddr || 0 != gfPmTmrMmio);
+
+        if (!pLib->fAvailable)
+            continue;
+
+        for (int i = 0; i < TLB_NUMDELAY; i++)
+        {
+            TlbMeasure(&pLib->rgMicro[i], grgpfnTlbMicro[n], grgdwTlbDelayUs[i], grgdwTlbDelayUs[i], dblTSCPerUs);
+            TlbMeasure(&pLib->rgNano[i], grgpfnTlbNano[n], grgdwTlbDelayUs[i] * 1000ULL, grgdwTlbDelayUs[i], dblTSCPerUs);
+
+            pLib->dblExcessUs += pLib->rgMicro[i].dblAvgUs - grgdwTlbDelayUs[i];
+        }
+
+        if (pLib->dblExcessUs > pResult->rgLib[pResult->nWorst].dblExcessUs || !pResult->rgLib[pResult->nWorst].fAvailable)
+            pResult->nWorst = n;
+
+        pResult->cntLib++;
+    }
+
+    if (NULL != gpHpetMmio && 0 == (1 & dwHpetConf))
+        *(volatile uint32_t*)(gpHpetMmio + HPET_GEN_CONF) = dwHpetConf;
+
+    return pResult->cntLib;
+}
+
+/**
+  Print the MicroSecondDelay() error in percent per library and delay as table
+
+  @param  fp            output stream
+  @param  pResult       result
+
+**/
+void TimerLibBenchPrintTable(FILE* fp, TLB_RESULT* pResult)
+{
+    fprintf(fp, "%-18s %10s", "TimerLib", "freq [Hz]");
+    for (int i = 0; i < TLB_NUMDELAY; i++)
+        fprintf(fp, " %7uus", grgdwTlbDelayUs[i]);
+    fprintf(fp, " %11s\n", "excess [us]");
+
+    for (int n = 0; n < TLB_NUMLIB; n++)
+    {
+        TLB_LIB* p = &pResult->rgLib[n];
+
+        if (!p->fAvailable)
+        {
+            fprintf(fp, "%-18s %10s\n", p->pstrName, "N/A");
+            continue;
+        }
+
+        fprintf(fp, "%-18s %10lld", p->pstrName, p->qwFreq);
+        for (int i = 0; i < TLB_NUMDELAY; i++)
+            fprintf(fp, " %+8.1f%%", p->rgMicro[i].dblErrPct);
+        fprintf(fp, " %11.1f\n", p->dblExcessUs);
+    }
+    fprintf(fp, "MicroSecondDelay() error vs. TSC %.0fHz, most POST time lost: %s\n", pResult->dblTSCPerSec, pResult->rgLib[pResult->nWorst].pstrName);
+}
@@ -0,0 +1,89 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TimerLibBench.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    side-by-side benchmark of TianoCore TimerLib MicroSecondDelay()/NanoSecondDelay() implementations
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TIMERLIBBENCH_H_
+#define _TIMERLIBBENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define TLB_ACPI            0                           // PcAtChipsetPkg AcpiTimerLib, InternalAcpiDelay()
+#define TLB_PIT             1                           // PC/AT 8254 channel 2 one-shot, OUT2 polled in port 0x61
+#define TLB_HPET            2                           // HPET main counter, period from GCAP_ID
+#define TLB_APIC            3                           // UefiCpuPkg SecPeiDxeTimerLibUefiCpu, local APIC timer, PcdFSBClock
+#define TLB_TSC_ACPI        4                           // PcAtChipsetPkg TscTimerLib, TSC calibrated against ACPI timer for 1ms
+#define TLB_TSC_CPUID       5                           // UefiCpuPkg CpuTimerLib, TSC frequency from CPUID.15h
+#define TLB_NUMLIB          6
+
+#define TLB_NUMDELAY        7                           // 1us .. 1s, one per decade
+#define TLB_POINT_US        200000                      // repetitions per delay point fill ~200ms
+#define TLB_MAXREPS         64
+
+#define TLB_FSBCLOCK        200000000                   // UefiCpuPkg PcdFSBClock default
+#define TLB_CRYSTALCLOCK    24000000                    // UefiCpuPkg PcdCpuCoreCrystalClockFrequency default
+#define TLB_TSCACPI_TICKS   3579                        // TscTimerLib calibration interval, "1ms" in ACPI ticks
+
+#define HPET_GCAP_ID        0x000                       // general capabilities, period in fs in bits 63:32
+#define HPET_GEN_CONF       0x010                       // general configuration, bit 0 ENABLE_CNF
+#define HPET_MAIN_COUNTER   0x0F0
+#define HPET_MAXPERIOD      100000000                   // 100ns in fs, max. COUNTER_CLK_PERIOD by specification
+
+typedef struct _TLB_POINT {
+    uint64_t qwRequested;                               // requested delay, us for MicroSecondDelay(), ns for NanoSecondDelay()
+    uint32_t cntReps;
+    double dblAvgUs;                                    // actual delay against the calibrated TSC
+    double dblMinUs;
+    double dblMaxUs;
+    double dblErrPct;                                   // average vs. requested in percent
+}TLB_POINT;
+
+typedef struct _TLB_LIB {
+    const char* pstrName;
+    int fAvailable;
+    uint64_t qwFreq;                                    // counter frequency as determined by the library itself
+    double dblExcessUs;                                 // POST time lost by one MicroSecondDelay() per delay point
+    TLB_POINT rgMicro[TLB_NUMDELAY];
+    TLB_POINT rgNano[TLB_NUMDELAY];
+}TLB_LIB;
+
+typedef struct _TLB_RESULT {
+    double dblTSCPerSec;                                // reference, TSC frequency from TSCSync calibration
+    int cntLib;                                         // 0 if not yet run
+    int nWorst;                                         // TLB_..., largest dblExcessUs
+    TLB_LIB rgLib[TLB_NUMLIB];
+}TLB_RESULT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const uint32_t grgdwTlbDelayUs[TLB_NUMDELAY];
+extern volatile uint8_t* gpHpetMmio;                    // HPET register block from ACPI HPET table, NULL if not available
+
+int TimerLibBenchRun(TLB_RESULT* pResult, double dblTSCPerSec);
+void TimerLibBenchPrintTable(FILE* fp, TLB_RESULT* pResult);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_TIMERLIBBENCH_H_
@@ -0,0 +1,210 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TimestampClkWait.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    EFI_TIMESTAMP_PROTOCOL GetTimestamp() wait, reference of hardware-reduced ACPI platforms
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <conio.h>
+#include <intrin.h>
+#include "ClkWait.h"
+#include "TscPolicy.h"
+
+extern int gfErrorCorrection;
+
+uint64_t(*gpfnGetTimestamp)(void);                     // EFI_TIMESTAMP_PROTOCOL.GetTimestamp(), NULL if not available
+uint64_t gqwTimestampFreq;                              // GetTimestamp() ticks per second, measured against RTC
+uint64_t gqwTimestampEnd;                               // GetTimestamp() wraps from EndValue to 0
+
+//
+// ticks between two GetTimestamp() values, EndValue is not necessarily 2^n - 1
+//
+static __inline uint64_t TimestampDiff(uint64_t previous, uint64_t current)
+{
+    return current >= previous ? current - previous : gqwTimestampEnd - previous + current + 1;
+}
+
+/**
+  Wait "Delay" ACPI ticks on the GetTimestamp() counter and return the number of TSC gone through
+
+  "Delay" is converted to GetTimestamp() ticks by the frequency measured against RTC.
+  If gfChunkedWait, pending interrupts are let in every CLKWAIT_CHUNK_US, each segment end is
+  anchored in gClkWaitSegRec, wraps of a counter with EndValue below 2^64 lost in a window
+  are restored.
+
+  @param  Delay         ACPI ticks to wait
+  @param  pDiag         diagnostics, overshoot in GetTimestamp() ticks, number of reads, may be NULL
+
+  @retval number of TSC per "Delay", overshoot subtracted if gfErrorCorrection
+
+**/
+int64_t TimestampClkWait(uint32_t Delay, CLKWAIT_DIAG* pDiag)
+{
+    int64_t Ticks = (int64_t)(((uint64_t)Delay * gqwTimestampFreq + TIMESTAMP_ACPI_HZ / 2) / TIMESTAMP_ACPI_HZ);
+    int64_t count = Ticks, segment;
+    int64_t Chunk = gfChunkedWait ? (int64_t)(gqwTimestampFreq * CLKWAIT_CHUNK_US / 1000000) : 0;
+    uint64_t qwTSCStart, qwTSCEnd, qwTSCPerIntervall;
+    uint64_t previous, current, diff, maxdiff = 0;
+    uint64_t qwTSCAnchor, qwTSCWindow, qwTSCWindowMax = 0;
+    uint32_t cntReads = 0, cntSeg = 0, cntWrapLost = 0, wraps;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+    (*gpfnGetTimestamp)();                              // warm up
+
+    previous = (*gpfnGetTimestamp)();
+    qwTSCStart = ReadTSC();                             // get TSC start
+
+    while (count > 0)
+    {
+        segment = 0 != Chunk && count > 2 * Chunk ? count - Chunk : 0;
+
+        while (count > segment)
+        {
+            current = (*gpfnGetTimestamp)();
+            diff = TimestampDiff(previous, current);
+            previous = current;
+            count -= diff;
+            cntReads++;
+            maxdiff = diff > maxdiff ? diff : maxdiff;
+        }
+
+        if (count > 0)
+        {
+            //
+            // anchor the segment end, let interrupts in, stitch the next segment to the phase
+            //
+            qwTSCAnchor = ReadTSC();
+            ClkWaitSegAnchor(cntSeg++, qwTSCAnchor - qwTSCStart, (uint64_t)(Ticks - count));
+
+            ClkWaitChunkWindow(eflags);
+
+            current = (*gpfnGetTimestamp)();
+            qwTSCWindow = ReadTSC() - qwTSCAnchor;
+
+            diff = TimestampDiff(previous, current);
+            wraps = UINT64_MAX == gqwTimestampEnd ? 0 : ClkWaitLostWraps(qwTSCAnchor - qwTSCStart, (uint64_t)(Ticks - count), qwTSCWindow, diff, gqwTimestampEnd + 1);
+            previous = current;
+            count -= (int64_t)(diff + wraps * (gqwTimestampEnd + 1));
+            cntReads++;
+            cntWrapLost += wraps;
+            qwTSCWindowMax = qwTSCWindow > qwTSCWindowMax ? qwTSCWindow : qwTSCWindowMax;
+        }
+    }
+
+    qwTSCEnd = ReadTSC();                               // get TSC end
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    //
+    // subtract the additional number of TSC gone through, "count" is negative
+    //
+    if (1 == gfErrorCorrection && 0 != Ticks)
+        qwTSCPerIntervall = ClkWaitErrorCorrect(qwTSCEnd - qwTSCStart, Ticks, count);
+    else
+        qwTSCPerIntervall = qwTSCEnd - qwTSCStart;
+
+    if (NULL != pDiag)
+    {
+        pDiag->qwOvershoot = -count;                    // Additional ticks gone through
+        pDiag->qwTSCRaw = qwTSCEnd - qwTSCStart;
+        pDiag->cntReads = cntReads;
+        pDiag->dwMaxStep = (uint32_t)(maxdiff > 0xFFFFFFFF ? 0xFFFFFFFF : maxdiff);
+        pDiag->cntGlitch = 0;
+        pDiag->cntSegments = cntSeg + 1;
+        pDiag->cntWrapLost = cntWrapLost;
+        pDiag->qwTSCWindowMax = qwTSCWindowMax;
+    }
+
+    return (int64_t)qwTSCPerIntervall;
+}
+
+/**
+  Get the latency of a single GetTimestamp() call
+
+  The minimum of TIMESTAMP_COST_ROUNDS rounds of TIMESTAMP_COST_CALLS back-to-back calls is taken,
+  interrupts are disabled during each round.
+
+  @retval TSC per call
+
+**/
+uint64_t TimestampLatency(void)
+{
+    uint64_t qwMin = (uint64_t)~0, qwTSC;
+    size_t eflags = __readeflags();                     // save flaags
+
+    for (int r = 0; r < TIMESTAMP_COST_ROUNDS; r++)
+    {
+        _disable();
+
+        qwTSC = ReadTSC();
+        for (int i = 0; i < TIMESTAMP_COST_CALLS; i++)
+            (*gpfnGetTimestamp)();
+        qwTSC = ReadTSC() - qwTSC;
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        qwMin = qwTSC < qwMin ? qwTSC : qwMin;
+    }
+
+    return qwMin / TIMESTAMP_COST_CALLS;
+}
+
+/**
+  Measure the real GetTimestamp() frequency against RTC second edges
+
+  GetTimestamp() is sampled at the falling edge of RTC UIP, "seconds" + 1 edges are taken.
+  Interrupts are disabled for max. one second at once.
+
+  @param  seconds       number of RTC seconds to measure
+
+  @retval GetTimestamp() ticks per second
+
+**/
+uint64_t TimestampFreqRtc(int seconds)
+{
+    uint64_t qwTicks = 0, previous = 0, current;
+    size_t eflags = __readeflags();                     // save flaags
+
+    for (int i = 0; i <= seconds; i++)
+    {
+        _disable();
+
+        _outp(0x70, 0x0A);                              // RTC Register A
+
+        while (0 == (0x80 & _inp(0x71)))
+            ;
+        while (0 != (0x80 & _inp(0x71)))
+            ;
+        current = (*gpfnGetTimestamp)();                // get GetTimestamp() at falling edge
+
+        if (0x200 & eflags)                             // restore IF interrupt flag
+            _enable();
+
+        if (0 != i)
+            qwTicks += TimestampDiff(previous, current);
+        previous = current;
+    }
+
+    return qwTicks / seconds;
+}
@@ -0,0 +1,148 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscOffset.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    TSC offset of each AP vs. the BSP, TSCSYNC_PROTOCOL TscOffset[]
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdint.h>
+#include <string.h>
+#include <intrin.h>
+#include "TscOffset.h"
+
+//
+// state of one AP measurement, shared by the BSP and the AP
+//
+typedef struct _TSCOFS_RUN {
+    volatile long nPhase;                               // odd: ping of the BSP, even: answer of the AP
+    volatile long fAbort;                               // BSP timed out
+    volatile uint64_t qwTSCAP;                          // AP TSC at the last ping
+}TSCOFS_RUN;
+
+static TSCOFS_RUN gTscOfsRun;
+
+//
+// TSC read serialized against the preceding phase counter access
+//
+static __inline uint64_t TscOffsetReadTSC(void)
+{
+    _mm_lfence();
+    return __rdtsc();
+}
+
+/**
+  AP procedure, answer each ping of the BSP with the own TSC
+
+  Runs on the AP, no console output, no boot services.
+
+**/
+static void TscOffsetProc(void* pArg)
+{
+    TSCOFS_RUN* pRun = (TSCOFS_RUN*)pArg;
+
+    for (long nRound = 0; nRound < TSCOFS_ROUNDS; nRound++)
+    {
+        while (2 * nRound + 1 != pRun->nPhase)
+        {
+            if (pRun->fAbort)
+                return;
+            _mm_pause();
+        }
+
+        pRun->qwTSCAP = TscOffsetReadTSC();
+        pRun->nPhase = 2 * nRound + 2;
+    }
+}
+
+/**
+  Measure the TSC offset of one AP
+
+  @retval 0 on success, -1 if the AP startup failed or the AP doesn't answer
+
+**/
+static int TscOffsetMeasure(const TSCOFS_PLATFORM* pPlat, uint32_t nCpu, uint64_t qwTimeout, int64_t* pllOffset, uint64_t* pqwRtt)
+{
+    uint64_t qwTSCStart, qwTSCEnd, qwMinRtt = (uint64_t)~0;
+
+    memset(&gTscOfsRun, 0, sizeof(gTscOfsRun));
+
+    if (0 != pPlat->pfnStartAP(nCpu, TscOffsetProc, &gTscOfsRun))
+        return -1;
+
+    for (long nRound = 0; nRound < TSCOFS_ROUNDS; nRound++)
+    {
+        qwTSCStart = TscOffsetReadTSC();
+        gTscOfsRun.nPhase = 2 * nRound + 1;
+
+        while (2 * nRound + 2 != gTscOfsRun.nPhase)
+        {
+            if (TscOffsetReadTSC() - qwTSCStart > qwTimeout)
+            {
+                gTscOfsRun.fAbort = 1;
+                pPlat->pfnWaitAP();
+                return -1;
+            }
+            _mm_pause();
+        }
+
+        qwTSCEnd = TscOffsetReadTSC();
+
+        if (qwTSCEnd - qwTSCStart < qwMinRtt)
+        {
+            qwMinRtt = qwTSCEnd - qwTSCStart;
+            *pllOffset = (int64_t)(gTscOfsRun.qwTSCAP - (qwTSCStart + qwMinRtt / 2));
+        }
+    }
+
+    pPlat->pfnWaitAP();
+    *pqwRtt = qwMinRtt;
+
+    return 0;
+}
+
+/**
+  Measure the TSC offset of all APs vs. the BSP
+
+  @param  pPlat         AP startup backend, hardware or a simulation
+  @param  dblTSCPerSec  calibrated TSC frequency, time base of the timeout
+  @param  rgllOffset    TSC of CPU n minus TSC of the BSP
+  @param  rgqwRtt       shortest round trip of CPU n, 0 for the BSP, may be NULL
+  @param  cntMax        number of entries in rgllOffset and rgqwRtt
+
+  @retval number of CPUs in rgllOffset, -1 if an AP startup failed or an AP doesn't answer
+
+**/
+int TscOffsetRun(const TSCOFS_PLATFORM* pPlat, double dblTSCPerSec, int64_t* rgllOffset, uint64_t* rgqwRtt, uint32_t cntMax)
+{
+    uint32_t nCpus = pPlat->nCpus < cntMax ? pPlat->nCpus : cntMax;
+    uint64_t qwTimeout = (uint64_t)(dblTSCPerSec * TSCOFS_TIMEOUT_MS / 1000);
+    uint64_t qwRtt;
+
+    for (uint32_t n = 0; n < nCpus; n++)
+    {
+        rgllOffset[n] = 0, qwRtt = 0;
+
+        if (pPlat->pfnIsAP(n) && 0 != TscOffsetMeasure(pPlat, n, qwTimeout, &rgllOffset[n], &qwRtt))
+            return -1;
+
+        if (NULL != rgqwRtt)
+            rgqwRtt[n] = qwRtt;
+    }
+
+    return (int)nCpus;
+}
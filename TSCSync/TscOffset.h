@@ -0,0 +1,61 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscOffset.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    TSC offset of each AP vs. the BSP, TSCSYNC_PROTOCOL TscOffset[]
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCOFFSET_H_
+#define _TSCOFFSET_H_
+
+#include <stdint.h>
+
+//
+// NOTE:    The APs are measured one after the other. The BSP and the AP exchange
+//          TSCOFS_ROUNDS ping-pongs on a shared phase counter, the AP takes its TSC
+//          when it sees the ping. The offset is the AP TSC minus the middle of the BSP
+//          round trip, the round with the shortest round trip is taken, the offset is
+//          accurate to +/- half of that round trip.
+//          The APs are started through TSCOFS_PLATFORM, EFI_MP_SERVICES_PROTOCOL
+//          StartupThisAP() on hardware, pthreads in Samples/TscOffsetSim.c.
+//          The BSP, disabled CPUs and CPUs beyond the table get offset 0.
+//
+#define TSCOFS_ROUNDS       64                          // ping-pongs per AP
+#define TSCOFS_TIMEOUT_MS   100                         // AP doesn't answer
+#define TSCOFS_AP_TIMEOUT_US 1000000                    // StartupThisAP() timeout
+
+typedef void (*TSCOFS_PROC)(void* pArg);
+
+typedef struct _TSCOFS_PLATFORM {
+    uint32_t nCpus;                                     // processors incl. BSP, numbered 0..nCpus-1
+    int (*pfnIsAP)(uint32_t nCpu);                      // enabled, not the BSP
+    int (*pfnStartAP)(uint32_t nCpu, TSCOFS_PROC pfnProc, void* pArg);  // start on that AP, don't wait, 0 on success
+    void (*pfnWaitAP)(void);                            // wait until the AP returned
+}TSCOFS_PLATFORM;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int TscOffsetRun(const TSCOFS_PLATFORM* pPlat, double dblTSCPerSec, int64_t* rgllOffset, uint64_t* rgqwRtt, uint32_t cntMax);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_TSCOFFSET_H_
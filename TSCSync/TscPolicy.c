@@ -0,0 +1,80 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscPolicy.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    timestamp policy, serialized TSC read variants
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <intrin.h>
+#include "TscPolicy.h"
+
+#define TSPOL_SAMPLES   1024                            // number of back-to-back reads for overhead measurement
+
+int gnTimestampPolicy = TSPOL_RDTSC;
+
+const char* grgstrTimestampPolicy[TSPOL_NUM] = {
+    "RDTSC",
+    "LFENCE+RDTSC",
+    "RDTSCP",
+    "MFENCE+LFENCE+RDTSC",
+};
+
+static int TimestampCompare(const void* p1, const void* p2)
+{
+    uint64_t q1 = *(const uint64_t*)p1, q2 = *(const uint64_t*)p2;
+
+    return q1 < q2 ? -1 : (q1 > q2 ? 1 : 0);
+}
+
+/**
+  Overhead of one ReadTSC() with the given timestamp policy
+
+  @param  nPolicy       TSPOL_...
+
+  @retval median TSC distance of two back-to-back ReadTSC() calls
+
+**/
+uint64_t TimestampOverhead(int nPolicy)
+{
+    static uint64_t rgqw[TSPOL_SAMPLES];
+    int nPolicySave = gnTimestampPolicy;
+    size_t eflags = __readeflags();                     // save flaags
+
+    gnTimestampPolicy = nPolicy;
+
+    _disable();
+
+    for (int i = 0; i < TSPOL_SAMPLES; i++)
+    {
+        uint64_t qwTSCStart = ReadTSC();
+
+        rgqw[i] = ReadTSC() - qwTSCStart;
+    }
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    gnTimestampPolicy = nPolicySave;
+
+    qsort(rgqw, TSPOL_SAMPLES, sizeof(uint64_t), TimestampCompare);
+
+    return rgqw[TSPOL_SAMPLES / 2];
+}
@@ -0,0 +1,87 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscPolicy.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    timestamp policy, serialized TSC read variants
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCPOLICY_H_
+#define _TSCPOLICY_H_
+
+#include <stdint.h>
+#include <intrin.h>
+
+#define TSPOL_RDTSC                 0                   // bare RDTSC, may be reordered around port I/O
+#define TSPOL_LFENCE_RDTSC          1                   // LFENCE; RDTSC; LFENCE
+#define TSPOL_RDTSCP                2                   // RDTSCP; LFENCE
+#define TSPOL_MFENCE_LFENCE_RDTSC   3                   // MFENCE; LFENCE; RDTSC; LFENCE
+#define TSPOL_NUM                   4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int gnTimestampPolicy;                           // TSPOL_..., selected by CONF menu or /TSPOLICY
+extern const char* grgstrTimestampPolicy[TSPOL_NUM];
+
+uint64_t TimestampOverhead(int nPolicy);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+  Read TSC according to the selected timestamp policy
+
+  The fences keep the out-of-order core from moving the TSC read across the
+  surrounding port I/O. The policy is the same for all measurement kernels.
+
+  @retval TSC
+
+**/
+static __inline uint64_t ReadTSC(void)
+{
+    uint64_t qwTSC;
+    unsigned aux;
+
+    switch (gnTimestampPolicy)
+    {
+    case TSPOL_LFENCE_RDTSC:
+        _mm_lfence();
+        qwTSC = __rdtsc();
+        _mm_lfence();
+        break;
+    case TSPOL_RDTSCP:
+        qwTSC = __rdtscp(&aux);
+        _mm_lfence();
+        break;
+    case TSPOL_MFENCE_LFENCE_RDTSC:
+        _mm_mfence();
+        _mm_lfence();
+        qwTSC = __rdtsc();
+        _mm_lfence();
+        break;
+    default:
+        qwTSC = __rdtsc();
+        break;
+    }
+
+    return qwTSC;
+}
+
+#endif//_TSCPOLICY_H_
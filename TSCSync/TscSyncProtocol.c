@@ -0,0 +1,104 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscSyncProtocol.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    TSCSYNC_PROTOCOL, calibrated TSC frequency published for subsequent UEFI Shell applications
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <string.h>
+#include "TscSyncProtocol.h"
+
+EFI_GUID gTscSyncProtocolGuid = TSCSYNC_PROTOCOL_GUID;
+
+/**
+  Locate an installed TSCSYNC_PROTOCOL and check signature, revision and size
+
+  Only boot services are used, a mock EFI_BOOT_SERVICES table allows to run it on the host.
+
+  @param  pBS           boot services
+  @param  ppTscSync     installed instance
+
+  @retval EFI_SUCCESS, EFI_NOT_FOUND, EFI_UNSUPPORTED for an incompatible instance
+
+**/
+EFI_STATUS TscSyncProtocolLocate(EFI_BOOT_SERVICES* pBS, TSCSYNC_PROTOCOL** ppTscSync)
+{
+    TSCSYNC_PROTOCOL* p = NULL;
+    EFI_STATUS Status = pBS->LocateProtocol(&gTscSyncProtocolGuid, NULL, (void**)&p);
+
+    if (EFI_ERROR(Status))
+        return Status;
+
+    if (TSCSYNC_PROTOCOL_SIGNATURE != p->Signature
+        || (TSCSYNC_PROTOCOL_REVISION >> 16) != (p->Revision >> 16)
+        || p->Size < sizeof(TSCSYNC_PROTOCOL))
+        return EFI_UNSUPPORTED;
+
+    *ppTscSync = p;
+
+    return EFI_SUCCESS;
+}
+
+/**
+  Install TSCSYNC_PROTOCOL or update an installed instance in place
+
+  @param  pBS           boot services
+  @param  pTemplate     content to publish, Signature, Revision and Size are set here
+  @param  ppInstalled   installed instance, may be NULL
+
+  @retval EFI_SUCCESS, EFI_UNSUPPORTED if an incompatible instance is installed,
+          or the status of AllocatePool()/InstallProtocolInterface()
+
+**/
+EFI_STATUS TscSyncProtocolPublish(EFI_BOOT_SERVICES* pBS, TSCSYNC_PROTOCOL* pTemplate, TSCSYNC_PROTOCOL** ppInstalled)
+{
+    TSCSYNC_PROTOCOL* p = NULL;
+    EFI_HANDLE Handle = NULL;
+    EFI_STATUS Status;
+
+    pTemplate->Signature = TSCSYNC_PROTOCOL_SIGNATURE;
+    pTemplate->Revision = TSCSYNC_PROTOCOL_REVISION;
+    pTemplate->Size = sizeof(TSCSYNC_PROTOCOL);
+
+    Status = TscSyncProtocolLocate(pBS, &p);
+    if (EFI_UNSUPPORTED == Status)                      // someone else's instance, don't overwrite, don't add a second
+        return Status;
+
+    if (EFI_SUCCESS != Status)
+    {
+        Status = pBS->AllocatePool(EfiBootServicesData, sizeof(TSCSYNC_PROTOCOL), (void**)&p);
+        if (EFI_ERROR(Status))
+            return Status;
+
+        memcpy(p, pTemplate, sizeof(TSCSYNC_PROTOCOL));
+
+        Status = pBS->InstallProtocolInterface(&Handle, &gTscSyncProtocolGuid, EFI_NATIVE_INTERFACE, p);
+        if (EFI_ERROR(Status))
+        {
+            pBS->FreePool(p);
+            return Status;
+        }
+    }
+    else
+        memcpy(p, pTemplate, sizeof(TSCSYNC_PROTOCOL));
+
+    if (NULL != ppInstalled)
+        *ppInstalled = p;
+
+    return EFI_SUCCESS;
+}
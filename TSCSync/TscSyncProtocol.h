@@ -0,0 +1,71 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscSyncProtocol.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    TSCSYNC_PROTOCOL, calibrated TSC frequency published for subsequent UEFI Shell applications
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCSYNCPROTOCOL_H_
+#define _TSCSYNCPROTOCOL_H_
+
+#include <uefi.h>
+
+//
+// NOTE:    The protocol is data only, no function pointers. It is allocated from
+//          EfiBootServicesData pool and installed on a new handle, so it survives
+//          the termination of TSCSync until ExitBootServices(). A later run of TSCSync
+//          updates the installed instance in place. An incompatible instance, e.g. of a
+//          later major revision, is left alone, TSCSync doesn't publish then, a second
+//          instance would be hidden behind it for LocateProtocol().
+//
+#define TSCSYNC_PROTOCOL_GUID \
+    { 0x6c1d4f2e, 0x83a7, 0x4b59, { 0x9e, 0x12, 0x5a, 0xc8, 0x3f, 0x71, 0xd0, 0x4b } }
+
+#define TSCSYNC_PROTOCOL_SIGNATURE  0x434E595343535454ULL   // "TTSCSYNC"
+#define TSCSYNC_PROTOCOL_REVISION   0x00010000
+#define TSCSYNC_MAXCPU              256
+
+typedef struct _TSCSYNC_PROTOCOL {
+    UINT64 Signature;                                   // TSCSYNC_PROTOCOL_SIGNATURE
+    UINT32 Revision;                                    // TSCSYNC_PROTOCOL_REVISION
+    UINT32 Size;                                        // sizeof(TSCSYNC_PROTOCOL)
+    UINT64 TscFrequency;                                // TSC per second, best estimate
+    UINT64 TscFrequencyUncertainty;                     // +/- Hz
+    UINT64 CalibrationTsc;                              // TSC at publication, age of the estimate
+    UINT32 TscNsMult;                                   // ns = TSC * TscNsMult >> TscNsShift
+    UINT32 TscNsShift;
+    UINT32 MultShiftRange;                              // seconds, TSC range without 64 bit overflow
+    UINT32 NumberOfCpus;                                // valid entries in TscOffset[]
+    INT64 TscOffset[TSCSYNC_MAXCPU];                    // TSC of CPU n minus TSC of the BSP, BSP is 0
+    CHAR8 Method[64];                                   // calibration method, ASCII
+}TSCSYNC_PROTOCOL;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern EFI_GUID gTscSyncProtocolGuid;
+
+EFI_STATUS TscSyncProtocolPublish(EFI_BOOT_SERVICES* pBS, TSCSYNC_PROTOCOL* pTemplate, TSCSYNC_PROTOCOL** ppInstalled);
+EFI_STATUS TscSyncProtocolLocate(EFI_BOOT_SERVICES* pBS, TSCSYNC_PROTOCOL** ppTscSync);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//_TSCSYNCPROTOCOL_H_
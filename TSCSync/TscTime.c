@@ -0,0 +1,359 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscTime.c
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    calibrated TSC time and delay service, benchmark against InternalAcpiDelay(),
+    mult/shift conversion constants
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <intrin.h>
+#include "TscTime.h"
+#include "ClkWait.h"
+#include "TscPolicy.h"
+
+uint64_t gqwTscTimeFreq;
+static uint64_t gqwTscTimeBase;                         // TSC at TscTimeInit(), TscTimeNowNs() origin
+
+const uint32_t grgdwTscTimeDelayUs[TSCTIME_NUMDELAY] = { 1, 10, 100, 1000, 10000, 100000 };
+
+const char* grgstrTscTimeName[TSCTIME_NUMIMPL] = { "TscTimeDelayUs", "InternalAcpiDelay" };
+
+uint32_t gdwTscTimeRangeSec = TSCTIME_MS_DFLT_SECONDS;
+TSCTIME_MULTSHIFT gTscTimeToNs;
+TSCTIME_MULTSHIFT gTscTimeFromNs;
+
+/**
+  Initialize the service with the calibrated TSC frequency
+
+  @param  qwTSCPerSec   TSC per second, e.g. gTSCPerSecACPIRnd
+
+**/
+void TscTimeInit(uint64_t qwTSCPerSec)
+{
+    gqwTscTimeFreq = qwTSCPerSec;
+    gqwTscTimeBase = ReadTSC();
+
+    TscTimeCalcMultShift(&gTscTimeToNs, qwTSCPerSec, 1000000000ULL, gdwTscTimeRangeSec);
+    TscTimeCalcMultShift(&gTscTimeFromNs, 1000000000ULL, qwTSCPerSec, gdwTscTimeRangeSec);
+}
+
+/**
+  Get mult/shift to convert frequency qwFrom to frequency qwTo, clocks_calc_mult_shift() of Linux
+
+  The input range dwMaxSec * qwFrom limits the bits available for mult, the shift is
+  decremented until mult fits. mult is rounded to nearest, 53 bit double precision is
+  sufficient for a 32 bit mult.
+
+  @param  pMS           result
+  @param  qwFrom        input frequency, e.g. TSC per second
+  @param  qwTo          output frequency, e.g. 1000000000 for ns
+  @param  dwMaxSec      input range in seconds without 64 bit overflow
+
+**/
+void TscTimeCalcMultShift(TSCTIME_MULTSHIFT* pMS, uint64_t qwFrom, uint64_t qwTo, uint32_t dwMaxSec)
+{
+    uint64_t tmp = ((uint64_t)dwMaxSec * qwFrom) >> 32;
+    uint32_t sft, sftacc = 32;
+
+    //
+    // bits left for mult, if the input range exceeds 32 bits
+    //
+    while (tmp)
+    {
+        tmp >>= 1;
+        sftacc--;
+    }
+
+    for (sft = 32; sft > 0; sft--)
+    {
+        tmp = (uint64_t)floor(ldexp((double)qwTo, sft) / (double)qwFrom + 0.5);
+        if ((tmp >> sftacc) == 0)
+            break;
+    }
+
+    pMS->dwMult = (uint32_t)tmp;
+    pMS->dwShift = sft;
+    pMS->dwMaxSec = dwMaxSec;
+    pMS->dblErrPpb = (ldexp((double)pMS->dwMult, -(int)sft) * (double)qwFrom / (double)qwTo - 1.0) * 1e9;
+}
+
+/**
+  Write a C header with the mult/shift constants of the calibrated platform
+
+  Includes an INF [BuildOptions] snippet to pass the constants to a firmware module
+  without the header.
+
+  @param  fp            output stream
+
+**/
+void TscTimeEmitHeader(FILE* fp)
+{
+    fprintf(fp, "/*++\n\n");
+    fprintf(fp, "    %s - TSC conversion constants, generated by TSCSync\n\n", TSCTIME_MS_FILENAME);
+    fprintf(fp, "    TSC frequency %lluHz, conversion range %u seconds\n", gqwTscTimeFreq, gdwTscTimeRangeSec);
+    fprintf(fp, "    ns  = (TSC * TSC_NS_MULT) >> TSC_NS_SHIFT, error %+.3f ppb\n", gTscTimeToNs.dblErrPpb);
+    fprintf(fp, "    TSC = (ns * NS_TSC_MULT) >> NS_TSC_SHIFT, error %+.3f ppb\n\n", gTscTimeFromNs.dblErrPpb);
+    fprintf(fp, "    INF snippet:\n\n");
+    fprintf(fp, "    [BuildOptions]\n");
+    fprintf(fp, "      MSFT:*_*_*_CC_FLAGS = /D TSC_FREQUENCY=%lluULL /D TSC_NS_MULT=%uU /D TSC_NS_SHIFT=%u /D NS_TSC_MULT=%uU /D NS_TSC_SHIFT=%u\n", gqwTscTimeFreq, gTscTimeToNs.dwMult, gTscTimeToNs.dwShift, gTscTimeFromNs.dwMult, gTscTimeFromNs.dwShift);
+    fprintf(fp, "      GCC:*_*_*_CC_FLAGS = -DTSC_FREQUENCY=%lluULL -DTSC_NS_MULT=%uU -DTSC_NS_SHIFT=%u -DNS_TSC_MULT=%uU -DNS_TSC_SHIFT=%u\n\n", gqwTscTimeFreq, gTscTimeToNs.dwMult, gTscTimeToNs.dwShift, gTscTimeFromNs.dwMult, gTscTimeFromNs.dwShift);
+    fprintf(fp, "--*/\n");
+    fprintf(fp, "#ifndef _TSCMULTSHIFT_H_\n");
+    fprintf(fp, "#define _TSCMULTSHIFT_H_\n\n");
+    fprintf(fp, "#define TSC_FREQUENCY       %lluULL\n", gqwTscTimeFreq);
+    fprintf(fp, "#define TSC_MULTSHIFT_RANGE %u                       // seconds, input range without 64 bit overflow\n", gdwTscTimeRangeSec);
+    fprintf(fp, "#define TSC_NS_MULT         %uU\n", gTscTimeToNs.dwMult);
+    fprintf(fp, "#define TSC_NS_SHIFT        %u\n", gTscTimeToNs.dwShift);
+    fprintf(fp, "#define NS_TSC_MULT         %uU\n", gTscTimeFromNs.dwMult);
+    fprintf(fp, "#define NS_TSC_SHIFT        %u\n\n", gTscTimeFromNs.dwShift);
+    fprintf(fp, "#define TSC_TO_NS(t)        (((UINT64)(t) * TSC_NS_MULT) >> TSC_NS_SHIFT)\n");
+    fprintf(fp, "#define NS_TO_TSC(n)        (((UINT64)(n) * NS_TSC_MULT) >> NS_TSC_SHIFT)\n\n");
+    fprintf(fp, "#endif//_TSCMULTSHIFT_H_\n");
+}
+
+/**
+  Convert TSC ticks to nanoseconds
+
+  Quotient and remainder are scaled separately, no 64 bit overflow up to a TSC
+  frequency of 18GHz.
+
+**/
+uint64_t TscTimeTicksToNs(uint64_t qwTicks)
+{
+    return qwTicks / gqwTscTimeFreq * 1000000000ULL + qwTicks % gqwTscTimeFreq * 1000000000ULL / gqwTscTimeFreq;
+}
+
+/**
+  Convert nanoseconds to TSC ticks, rounded up
+
+**/
+uint64_t TscTimeNsToTicks(uint64_t qwNs)
+{
+    return qwNs / 1000000000ULL * gqwTscTimeFreq + (qwNs % 1000000000ULL * gqwTscTimeFreq + 999999999ULL) / 1000000000ULL;
+}
+
+/**
+  Convert microseconds to TSC ticks, rounded up
+
+**/
+uint64_t TscTimeUsToTicks(uint64_t qwUs)
+{
+    return qwUs / 1000000ULL * gqwTscTimeFreq + (qwUs % 1000000ULL * gqwTscTimeFreq + 999999ULL) / 1000000ULL;
+}
+
+/**
+  Get nanoseconds since TscTimeInit()
+
+**/
+uint64_t TscTimeNowNs(void)
+{
+    return TscTimeTicksToNs(ReadTSC() - gqwTscTimeBase);
+}
+
+/**
+  Spin until the TSC deadline is reached
+
+  @param  qwTicks       delay in TSC ticks
+
+**/
+void TscTimeDelayTicks(uint64_t qwTicks)
+{
+    uint64_t qwDeadline = ReadTSC() + qwTicks;
+
+    while ((int64_t)(ReadTSC() - qwDeadline) < 0)
+        _mm_pause();
+}
+
+void TscTimeDelayNs(uint64_t qwNs)
+{
+    TscTimeDelayTicks(TscTimeNsToTicks(qwNs));
+}
+
+void TscTimeDelayUs(uint64_t qwUs)
+{
+    TscTimeDelayTicks(TscTimeUsToTicks(qwUs));
+}
+
+/**
+  Delay under test, microseconds, MicroSecondDelay() conversion of AcpiTimerLib for TSCTIME_ACPI
+
+**/
+static void TscTimeBenchDelay(int nImpl, uint64_t qwUs)
+{
+    if (TSCTIME_TSC == nImpl)
+        TscTimeDelayUs(qwUs);
+    else
+        InternalAcpiDelay((uint32_t)(qwUs * 3579545 / 1000000u), NULL);
+}
+
+/**
+  Measure one call of the delay under test with interrupts disabled
+
+  @retval TSC ticks gone through
+
+**/
+static uint64_t TscTimeBenchCall(int nImpl, uint64_t qwUs)
+{
+    uint64_t qwTSCStart, qwTSCEnd;
+    size_t eflags = __readeflags();                     // save flaags
+
+    _disable();
+
+    qwTSCStart = ReadTSC();
+    TscTimeBenchDelay(nImpl, qwUs);
+    qwTSCEnd = ReadTSC();
+
+    if (0x200 & eflags)                                 // restore IF interrupt flag
+        _enable();
+
+    return qwTSCEnd - qwTSCStart;
+}
+
+/**
+  Measure one delay point
+
+**/
+static void TscTimeBenchPoint(TSCTIME_POINT* pPoint, int nImpl, uint32_t dwRequestedUs, double dblTSCPerNs)
+{
+    uint32_t cntReps = TSCTIME_POINT_US / dwRequestedUs;
+    double dblSum = 0.0, dblSumSq = 0.0, dblVar;
+
+    cntReps = cntReps < TSCTIME_MINREPS ? TSCTIME_MINREPS : (cntReps > TSCTIME_MAXREPS ? TSCTIME_MAXREPS : cntReps);
+
+    pPoint->dwRequestedUs = dwRequestedUs;
+    pPoint->cntReps = cntReps;
+    pPoint->dblMaxOvershootNs = -1e30;
+
+    for (uint32_t r = 0; r < cntReps; r++)
+    {
+        double dblNs = (double)TscTimeBenchCall(nImpl, dwRequestedUs) / dblTSCPerNs;
+        double dblOvershootNs = dblNs - dwRequestedUs * 1000.0;
+
+        dblSum += dblNs;
+        dblSumSq += dblNs * dblNs;
+        pPoint->dblMaxOvershootNs = dblOvershootNs > pPoint->dblMaxOvershootNs ? dblOvershootNs : pPoint->dblMaxOvershootNs;
+    }
+
+    pPoint->dblAvgNs = dblSum / cntReps;
+    pPoint->dblOvershootNs = pPoint->dblAvgNs - dwRequestedUs * 1000.0;
+
+    dblVar = dblSumSq / cntReps - pPoint->dblAvgNs * pPoint->dblAvgNs;
+    pPoint->dblStdDevNs = dblVar > 0.0 ? sqrt(dblVar) : 0.0;
+}
+
+/**
+  Compare TscTimeDelayUs() against InternalAcpiDelay() across 1us..100ms
+
+  The call latency is the shortest duration of a zero delay, the precision ratio is
+  the standard deviation of the ACPI delay over the one of the TSC delay, the latter
+  bounded below by one TSC tick.
+
+  @param  pBench        result
+  @param  dblTSCPerSec  reference TSC frequency
+
+  @retval number of implementations measured
+
+**/
+int TscTimeBenchRun(TSCTIME_BENCH* pBench, double dblTSCPerSec)
+{
+    double dblTSCPerNs = dblTSCPerSec / 1e9;
+    int cntImpl = 0;
+
+    memset(pBench, 0, sizeof(TSCTIME_BENCH));
+
+    if (0 == gqwTscTimeFreq)
+        return 0;
+
+    pBench->fAcpi = 0 != gPmTmrBlkAddr || 0 != gfPmTmrMmio;
+
+    for (int n = 0; n < TSCTIME_NUMIMPL; n++)
+    {
+        uint64_t qwMin = (uint64_t)-1;
+
+        if (TSCTIME_ACPI == n && !pBench->fAcpi)
+            continue;
+
+        for (int r = 0; r < TSCTIME_LATREPS; r++)
+        {
+            uint64_t qw = TscTimeBenchCall(n, 0);
+
+            qwMin = qw < qwMin ? qw : qwMin;
+        }
+        pBench->rgdblLatencyNs[n] = (double)qwMin / dblTSCPerNs;
+
+        for (int i = 0; i < TSCTIME_NUMDELAY; i++)
+            TscTimeBenchPoint(&pBench->rgPoint[n][i], n, grgdwTscTimeDelayUs[i], dblTSCPerNs);
+
+        cntImpl++;
+    }
+
+    if (pBench->fAcpi)
+    {
+        for (int i = 0; i < TSCTIME_NUMDELAY; i++)
+        {
+            double dblTsc = pBench->rgPoint[TSCTIME_TSC][i].dblStdDevNs;
+
+            dblTsc = dblTsc < 1.0 / dblTSCPerNs ? 1.0 / dblTSCPerNs : dblTsc;
+            pBench->rgdblPrecision[i] = pBench->rgPoint[TSCTIME_ACPI][i].dblStdDevNs / dblTsc;
+        }
+    }
+
+    pBench->dblTSCPerSec = dblTSCPerSec;
+
+    return cntImpl;
+}
+
+/**
+  Print overshoot and standard deviation per implementation and delay as table
+
+  @param  fp            output stream
+  @param  pBench        result
+
+**/
+void TscTimeBenchPrintTable(FILE* fp, TSCTIME_BENCH* pBench)
+{
+    fprintf(fp, "%-18s %12s %10s %14s %14s %12s\n", "delay", "latency [ns]", "requested", "overshoot [ns]", "max. ovs. [ns]", "stddev [ns]");
+
+    for (int n = 0; n < TSCTIME_NUMIMPL; n++)
+    {
+        if (TSCTIME_ACPI == n && !pBench->fAcpi)
+        {
+            fprintf(fp, "%-18s %12s\n", grgstrTscTimeName[n], "N/A");
+            continue;
+        }
+
+        for (int i = 0; i < TSCTIME_NUMDELAY; i++)
+        {
+            TSCTIME_POINT* p = &pBench->rgPoint[n][i];
+
+            fprintf(fp, "%-18s %12.1f %8uus %14.1f %14.1f %12.1f\n", 0 == i ? grgstrTscTimeName[n] : "", pBench->rgdblLatencyNs[n], p->dwRequestedUs, p->dblOvershootNs, p->dblMaxOvershootNs, p->dblStdDevNs);
+        }
+    }
+
+    if (pBench->fAcpi)
+    {
+        fprintf(fp, "precision TSC vs. ACPI:");
+        for (int i = 0; i < TSCTIME_NUMDELAY; i++)
+            fprintf(fp, " %uus %.0fx", grgdwTscTimeDelayUs[i], pBench->rgdblPrecision[i]);
+        fprintf(fp, "\n");
+    }
+}
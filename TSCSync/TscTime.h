@@ -0,0 +1,126 @@
+/*++
+
+    TSCSync
+    https://github.com/KilianKegel/Visual-TSCSync-for-UEFI-Shell
+
+    Copyright (c) 2017-2025, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    TscTime.h
+
+Abstract:
+
+    TSCSync - TimeStampCounter (TSC) synchronizer,  analysing System Timer characteristics
+    calibrated TSC time and delay service, benchmark against InternalAcpiDelay(),
+    mult/shift conversion constants
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _TSCTIME_H_
+#define _TSCTIME_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+//
+// NOTE:    The service runs on the TSC frequency from TSCSync calibration, TscTimeInit().
+//          Delays spin on a TSC deadline, the resolution is one TSC cycle instead of one
+//          ACPI tick of 279ns plus the port read of ~1us when polling the PM timer.
+//
+#define TSCTIME_TSC         0                           // TscTimeDelayUs()
+#define TSCTIME_ACPI        1                           // InternalAcpiDelay(), PcAtChipsetPkg AcpiTimerLib
+#define TSCTIME_NUMIMPL     2
+
+#define TSCTIME_NUMDELAY    6                           // 1us .. 100ms, one per decade
+#define TSCTIME_POINT_US    100000                      // repetitions per delay point fill ~100ms
+#define TSCTIME_MINREPS     16
+#define TSCTIME_MAXREPS     1024
+#define TSCTIME_LATREPS     1024                        // calls of a zero delay to get the call latency
+
+//
+// NOTE:    Divide free conversion x * mult >> shift as done by Linux clocksource code,
+//          the shift is the largest one, that keeps mult in 32 bit and x * mult in 64 bit
+//          for x up to TSCTIME_MS_... seconds worth of input.
+//
+#define TSCTIME_MS_DFLT_SECONDS 600                     // conversion range in seconds
+#define TSCTIME_MS_MAXSECONDS   86400
+#define TSCTIME_MS_FILENAME     "TscMultShift.h"        // emitted by /MULTSHIFT
+
+typedef struct _TSCTIME_MULTSHIFT {
+    uint32_t dwMult;
+    uint32_t dwShift;
+    uint32_t dwMaxSec;                                  // input range in seconds without 64 bit overflow
+    double dblErrPpb;                                   // mult / 2^shift vs. exact ratio
+}TSCTIME_MULTSHIFT;
+
+typedef struct _TSCTIME_POINT {
+    uint32_t dwRequestedUs;
+    uint32_t cntReps;
+    double dblAvgNs;                                    // actual delay against the calibrated TSC
+    double dblOvershootNs;                              // average vs. requested
+    double dblMaxOvershootNs;
+    double dblStdDevNs;                                 // precision, standard deviation of the actual delay
+}TSCTIME_POINT;
+
+typedef struct _TSCTIME_BENCH {
+    double dblTSCPerSec;                                // 0 if not yet run
+    int fAcpi;                                          // InternalAcpiDelay() measured
+    double rgdblLatencyNs[TSCTIME_NUMIMPL];             // min. duration of a zero delay call
+    TSCTIME_POINT rgPoint[TSCTIME_NUMIMPL][TSCTIME_NUMDELAY];
+    double rgdblPrecision[TSCTIME_NUMDELAY];            // ACPI vs. TSC standard deviation
+}TSCTIME_BENCH;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uint64_t gqwTscTimeFreq;                         // TSC per second, 0 until TscTimeInit()
+extern const uint32_t grgdwTscTimeDelayUs[TSCTIME_NUMDELAY];
+extern const char* grgstrTscTimeName[TSCTIME_NUMIMPL];
+extern uint32_t gdwTscTimeRangeSec;                     // mult/shift conversion range, /MULTSHIFT
+extern TSCTIME_MULTSHIFT gTscTimeToNs;                  // TSC to ns, valid after TscTimeInit()
+extern TSCTIME_MULTSHIFT gTscTimeFromNs;                // ns to TSC, valid after TscTimeInit()
+
+void TscTimeInit(uint64_t qwTSCPerSec);
+uint64_t TscTimeTicksToNs(uint64_t qwTicks);
+uint64_t TscTimeNsToTicks(uint64_t qwNs);
+uint64_t TscTimeUsToTicks(uint64_t qwUs);
+uint64_t TscTimeNowNs(void);
+void TscTimeDelayTicks(uint64_t qwTicks);
+void TscTimeDelayNs(uint64_t qwNs);
+void TscTimeDelayUs(uint64_t qwUs);
+
+void TscTimeCalcMultShift(TSCTIME_MULTSHIFT* pMS, uint64_t qwFrom, uint64_t qwTo, uint32_t dwMaxSec);
+void TscTimeEmitHeader(FILE* fp);
+
+int TscTimeBenchRun(TSCTIME_BENCH* pBench, double dblTSCPerSec);
+void TscTimeBenchPrintTable(FILE* fp, TSCTIME_BENCH* pBench);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+  Convert TSC ticks to nanoseconds by mult/shift, ticks within gTscTimeToNs.dwMaxSec
+
+**/
+static __inline uint64_t TscTimeTicksToNsFast(uint64_t qwTicks)
+{
+    return (qwTicks * gTscTimeToNs.dwMult) >> gTscTimeToNs.dwShift;
+}
+
+/**
+  Convert nanoseconds to TSC ticks by mult/shift, nanoseconds within gTscTimeFromNs.dwMaxSec
+
+**/
+static __inline uint64_t TscTimeNsToTicksFast(uint64_t qwNs)
+{
+    return (qwNs * gTscTimeFromNs.dwMult) >> gTscTimeFromNs.dwShift;
+}
+
+#endif//_TSCTIME_H_
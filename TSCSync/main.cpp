@@ -34,7 +34,10 @@ Author:
 //	Cfg	- config
 
 #include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <math.h>
 #include <string.h>
 #include <time.h>
 #include <wchar.h>
@@ -46,12 +49,32 @@ Author:
 #include "DPRINTF.H"
 #include "base_t.h"
 #include "LibWin324UEFI.h"
+#include "HwLatDetect.h"
+#include "Stability.h"
+#include "Spectrum.h"
+#include "KalmanFusion.h"
+#include "CrossRef.h"
+#include "TimerLibBench.h"
+#include "TscTime.h"
+#include "TscSyncProtocol.h"
+#include "ClockServo.h"
+#include "ClkWait.h"
+#include "Bench.h"
+#include "TscPolicy.h"
+#include "ApicTimer.h"
+#include "RtcSnapshot.h"
+#include "Campaign.h"
+#include "MpContention.h"
+#include "ApLoad.h"
+#include "TscOffset.h"
 
 #include <Protocol\AcpiTable.h>
 #include <Protocol\Timestamp.h>
+#include <Protocol\MpService.h>
 #include <Guid\Acpi.h>
 #include <IndustryStandard/Acpi62.h>
 #include <IndustryStandard/MemoryMappedConfigurationSpaceAccessTable.h>
+#include <IndustryStandard/HighPrecisionEventTimerTable.h>
 
 #include <Protocol\AcpiSystemDescriptionTable.h>
 
@@ -76,10 +99,6 @@ extern "C" void _disable(void);
 
 extern bool gfKbdDbg;
 extern "C" uint16_t gPmTmrBlkAddr;
-extern "C" int64_t PITClkWait(uint32_t delay);
-extern "C" int64_t AcpiClkWait(uint32_t delay);
-extern "C" int64_t InternalAcpiDelay(uint32_t delay);
-extern "C" int64_t PITClkWait(uint32_t delay);
 extern "C" unsigned long long _osifIbmAtGetTscPer62799(uint32_t delay);
 
 extern "C" WINBASEAPI UINT WINAPI EnumSystemFirmwareTables(
@@ -175,6 +194,9 @@ bool gfCfgMngMnuItm_Config_ACPIDelaySelect5 = false;// L"  ACPI: 9861 *     363
 bool gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = true;
 bool gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
 bool gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+bool gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+bool gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+bool gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 
 extern "C" unsigned char  gfErrorCorrection;
 
@@ -185,6 +207,8 @@ char gstrACPISignature[128];
 char gstrACPIOemId[128];
 char gstrACPIOemTableId[128];
 char gstrACPIPmTmrBlkAddr[128];
+int gnPmTmrAccess = PMTMR_ACCESS_AUTO;		// /PMTMR:IO or /PMTMR:MMIO
+uint64_t gqwPmTmrCostIO, gqwPmTmrCostMMIO;	// TSC per PM timer read, 0 if not benchmarked
 char gACPIPmTmrBlkSize[128];
 char gACPIPCIEBase[128];
 
@@ -203,9 +227,10 @@ int64_t gTIMESTAMP_PROTOCOLPerSec;
 int64_t gTIMESTAMP_PROTOCOLSecDriftPerDay;
 char gstrTIMESTAMP_PROTOCOL[128];
 int64_t gTIMESTAMP_PROTOCOLDriftPerDay;
+uint64_t gqwTimestampLatency;				// TSC per GetTimestamp() call
 extern "C" uint32_t gCOUNTER_WIDTH;
 
-int64_t(*pfnDelay)(uint32_t  Delay) = &InternalAcpiDelay;
+int64_t(*pfnDelay)(uint32_t  Delay, CLKWAIT_DIAG* pDiag) = &InternalAcpiDelay;
 
 #define MAXNUM 1250
 static uint16_t PITB2BStat[MAXNUM];
@@ -220,7 +245,7 @@ static struct {
 	char szMultiplier[64];
 	uint32_t delay;
 	int64_t qwMultiplierToOneSecond;
-	//int64_t(*pfnDelay)(uint32_t  Delay);
+	//int64_t(*pfnDelay)(uint32_t  Delay, CLKWAIT_DIAG* pDiag);
 	bool* pEna;
 	int64_t* rgDiffTSC;	    // equivalence of arrays and pointers
 	double* rgDriftSecPerDay;	// equivalence of arrays and pointers
@@ -278,7 +303,7 @@ typedef struct {
 //	return;
 //}
 
-int rtcrd(int idx)
+extern "C" int rtcrd(int idx)
 {
 	int nRet = 0;
 	int UIP = 0;
@@ -303,10 +328,47 @@ int rtcrd(int idx)
 
 	return nRet;
 }
+
+uint64_t gcntClkWaitGlitch;		// counter glitches of entire RUN CONFIG
+uint64_t gcntClkWaitSamples;	// number of delays of entire RUN CONFIG
+uint64_t gcntClkWaitWrapLost;	// /CHUNKED counter wraps lost in interrupt windows, restored
+uint64_t gqwClkWaitWindowMax;	// /CHUNKED longest interrupt window, TSC
+
+//
+// does the platform need verified counter reads
+//
+const char* ClkWaitGlitchVerdict(void)
+{
+	if (0 == gcntClkWaitGlitch)
+		return gfVerifiedRead ? "verified read mode not needed" : "no glitches, unverified reads are fine";
+	return gfVerifiedRead ? "glitches rejected, keep verified read mode" : "verified read mode RECOMMENDED (/VERIFY)";
+}
+
+//
+// standard deviation of the drift samples of one calibration time, shows the effect of the timestamp policy
+//
+double DriftStdDev(double* rgdblDriftSecPerDay, int cnt)
+{
+	double dblSum = 0.0, dblSum2 = 0.0, dblMean;
+
+	if (cnt < 2)
+		return 0.0;
+
+	for (int j = 0; j < cnt; j++)
+		dblSum += rgdblDriftSecPerDay[j];
+	dblMean = dblSum / cnt;
+
+	for (int j = 0; j < cnt; j++)
+		dblSum2 += (rgdblDriftSecPerDay[j] - dblMean) * (rgdblDriftSecPerDay[j] - dblMean);
+
+	return sqrt(dblSum2 / (cnt - 1));
+}
+
 //
 // globally shared data
 //
 uint16_t gPm1aCntBlkAddr;
+uint16_t gPm1aEnAddr;									// PM1_EN, PM1a_EVT_BLK + PM1_EVT_LEN / 2
 time_t	gTimeAtSystemStart;
 int64_t	gTSCAtSystemStart;
 int64_t gTSClocksPerSecDRIFTED;
@@ -317,6 +379,22 @@ bool gfSaveExit = false;
 bool gfHexView = false;
 bool gfRunConfig = false;
 bool gfRunDriftTest = false;
+bool gfRunDriftServo = false;
+bool gfRunHwLat = false;
+bool gfRunAdev = false;
+bool gfRunSpectrum = false;
+bool gfRunKalman = false;
+bool gfRunXRef = false;
+bool gfRunTimerLib = false;
+bool gfRunTscTime = false;
+bool gfRunMpCont = false;
+bool gfRunBench = false;
+static CAMPAIGN gCampaign;								// cold boot campaign, valid if 0 != gCampaign.nTotal
+bool gfPublish = false;								// /PUBLISH: install TSCSYNC_PROTOCOL
+bool gfMultShiftEmit = false;						// /MULTSHIFT: write TSCTIME_MS_FILENAME
+bool gfBenchExit = false;							// /BENCH: print table and CSV, no UI
+bool gfTimerLibExit = false;						// /TIMERLIB: print table, no UI
+bool gfTscTimeExit = false;							// /TSCDELAY: print table, no UI
 bool gfAutoRun = false;
 
 bool gfStatusLineVisible;
@@ -341,6 +419,186 @@ char gCfgStr_File_SaveAs[256] = "default.xlsx";
 char gCfgStr_CalibrMethod[64] = "original TIANOCORE";
 int gfCfgSyncRef012 = 1;		//0 -> ACPI, 1 -> RTC, 2 -> i8254
 int  gnCfgRefSyncTime = 1;		//sync time/delay
+uint32_t gnCfgHwLatWindowMs = HWLAT_DFLT_WINDOW;		// HW latency detector window in ms
+uint32_t gnCfgHwLatThresholdUs = HWLAT_DFLT_THRSHLD;	// HW latency detector threshold in us
+static HWLAT_RESULT gHwLatResult;						// HW latency detector result, valid if 0 != gHwLatResult.qwTSCSampled
+uint32_t gnCfgAdevSeconds = STAB_DFLT_SECONDS;			// ADEV/MTIE phase record length in seconds
+static STABILITY_RESULT gStabilityResult;				// ADEV/MTIE result, valid if 0 != gStabilityResult.cntTau
+uint32_t gnCfgSpectrumSeconds = SPEC_DFLT_SECONDS;		// spectrum capture time in seconds
+static SPECTRUM_RESULT gSpectrumResult;					// spectrum result, valid if 0 != gSpectrumResult.cntPlot
+uint32_t gnCfgKalmanSeconds = KF_DFLT_SECONDS;			// Kalman fusion run time in seconds
+static KALMAN_STATE gKalmanState;						// Kalman fusion state, valid if 0 != gKalmanState.cntHist
+uint32_t gnCfgXRefSeconds = XREF_DFLT_SECONDS;			// ACPI vs. PIT cross-reference run time in seconds
+static XREF_RESULT gXRefResult;							// ACPI vs. PIT cross-reference, valid if 0 != gXRefResult.dblSeconds
+static TLB_RESULT gTimerLibResult;						// TimerLib benchmark, valid if 0 != gTimerLibResult.cntLib
+static TSCTIME_BENCH gTscTimeBench;						// TSC delay service benchmark, valid if 0 != gTscTimeBench.dblTSCPerSec
+static MPCONT_RESULT gMpContResult;						// multi-core contention benchmark, valid if 0 != gMpContResult.dblTSCPerSec
+static APLOAD gApLoad;									// background load on APs during RUN CONFIG, /APLOAD
+char gstrApLoad[128] = "none";							// load active during the last calibration
+uint64_t grgqwTimestampOverhead[TSPOL_NUM];				// ReadTSC() overhead per timestamp policy in TSC cycles
+static BENCH_RESULT gBenchResult;						// timer primitives benchmark, valid if 0 != gBenchResult.cntStat
+static CLOCK_SERVO gClockServo;							// drift servo state, valid if 0 != gClockServo.cntHist
+
+//
+// port I/O backend of the cold boot campaign
+//
+static uint8_t CampaignHwInp(uint16_t wPort) { return (uint8_t)_inp(wPort); }
+static void CampaignHwOutp(uint16_t wPort, uint8_t bData) { _outp(wPort, bData); }
+static uint16_t CampaignHwInpw(uint16_t wPort) { return (uint16_t)_inpw(wPort); }
+static void CampaignHwOutpw(uint16_t wPort, uint16_t wData) { _outpw(wPort, wData); }
+
+static const CAMPAIGN_IO gCampaignIoHw = { CampaignHwInp, CampaignHwOutp, CampaignHwInpw, CampaignHwOutpw };
+
+//
+// EFI_MP_SERVICES_PROTOCOL backend of the multi-core contention benchmark
+//
+static EFI_MP_SERVICES_PROTOCOL* gpMpServices;
+
+static int MpContHwStartupAllAPs(MPCONT_PROC pfnProc, void* pArg)
+{
+	EFI_STATUS Status = gpMpServices->StartupAllAPs(gpMpServices, (EFI_AP_PROCEDURE)pfnProc, false/*SingleThread*/, nullptr, MPCONT_AP_TIMEOUT_US, pArg, nullptr);
+
+	return EFI_ERROR(Status) ? -1 : 0;
+}
+
+static uint32_t MpContHwReadAcpi(void) { return GetACPICount(gPmTmrBlkAddr); }
+
+static uint32_t MpContHwReadPit(void)
+{
+	uint32_t lo, hi;
+
+	_outp(0x43, (2/*TIMER*/ << 6) + 0x0);				// counter latch timer 2
+	lo = (uint8_t)_inp(0x40 + 2/*TIMER*/);				// get low byte
+	hi = (uint8_t)_inp(0x40 + 2/*TIMER*/);				// get high byte
+
+	return (hi << 8) | lo;
+}
+
+static MPCONT_PLATFORM gMpContHw = { 0, MpContHwStartupAllAPs, MpContHwReadAcpi, MpContHwReadPit };
+
+/**
+  Locate EFI_MP_SERVICES_PROTOCOL and get the number of enabled APs
+
+  @retval number of enabled APs, 0 if N/A
+
+**/
+static uint32_t MpContHwInit(void)
+{
+	EFI_GUID MpServicesGuid = EFI_MP_SERVICES_PROTOCOL_GUID;
+	UINTN nCpus = 0, nEnabled = 0;
+
+	if (nullptr == gpMpServices
+		&& EFI_SUCCESS != gSystemTable->BootServices->LocateProtocol(&MpServicesGuid, nullptr, (void**)&gpMpServices))
+		gpMpServices = nullptr;
+
+	gMpContHw.pfnReadAcpi = 0 != gPmTmrBlkAddr || gfPmTmrMmio ? MpContHwReadAcpi : nullptr;	// no PM timer in the FADT
+
+	if (nullptr == gpMpServices || EFI_SUCCESS != gpMpServices->GetNumberOfProcessors(gpMpServices, &nCpus, &nEnabled) || 0 == nEnabled)
+		return gMpContHw.nAPs = 0;
+
+	return gMpContHw.nAPs = (uint32_t)(nEnabled - 1);	// BSP excluded
+}
+
+//
+// EFI_MP_SERVICES_PROTOCOL backend of the AP background load, the APs run while the BSP calibrates
+//
+static EFI_EVENT gApLoadEvent;
+
+static int ApLoadHwStartAPs(APLOAD_PROC pfnProc, void* pArg)
+{
+	EFI_STATUS Status = gSystemTable->BootServices->CreateEvent(0, TPL_APPLICATION, nullptr, nullptr, &gApLoadEvent);
+
+	if (EFI_ERROR(Status))
+		return -1;
+
+	Status = gpMpServices->StartupAllAPs(gpMpServices, (EFI_AP_PROCEDURE)pfnProc, false/*SingleThread*/, gApLoadEvent, 0, pArg, nullptr);
+	if (EFI_ERROR(Status))
+	{
+		gSystemTable->BootServices->CloseEvent(gApLoadEvent);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void ApLoadHwWaitAPs(void)
+{
+	while (EFI_NOT_READY == gSystemTable->BootServices->CheckEvent(gApLoadEvent))
+		_mm_pause();
+
+	gSystemTable->BootServices->CloseEvent(gApLoadEvent);
+}
+
+static APLOAD_PLATFORM gApLoadHw = { 0, ApLoadHwStartAPs, ApLoadHwWaitAPs, MpContHwReadAcpi };
+
+//
+// EFI_MP_SERVICES_PROTOCOL backend of the per AP TSC offset, one AP at a time
+//
+static EFI_EVENT gTscOfsEvent;
+
+static int TscOfsHwIsAP(uint32_t nCpu)
+{
+	EFI_PROCESSOR_INFORMATION Info;
+
+	if (EFI_SUCCESS != gpMpServices->GetProcessorInfo(gpMpServices, nCpu, &Info))
+		return 0;
+
+	return PROCESSOR_ENABLED_BIT == (Info.StatusFlag & (PROCESSOR_ENABLED_BIT | PROCESSOR_AS_BSP_BIT));
+}
+
+static int TscOfsHwStartAP(uint32_t nCpu, TSCOFS_PROC pfnProc, void* pArg)
+{
+	EFI_STATUS Status = gSystemTable->BootServices->CreateEvent(0, TPL_APPLICATION, nullptr, nullptr, &gTscOfsEvent);
+
+	if (EFI_ERROR(Status))
+		return -1;
+
+	Status = gpMpServices->StartupThisAP(gpMpServices, (EFI_AP_PROCEDURE)pfnProc, nCpu, gTscOfsEvent, TSCOFS_AP_TIMEOUT_US, pArg, nullptr);
+	if (EFI_ERROR(Status))
+	{
+		gSystemTable->BootServices->CloseEvent(gTscOfsEvent);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void TscOfsHwWaitAP(void)
+{
+	while (EFI_NOT_READY == gSystemTable->BootServices->CheckEvent(gTscOfsEvent))
+		_mm_pause();
+
+	gSystemTable->BootServices->CloseEvent(gTscOfsEvent);
+}
+
+static TSCOFS_PLATFORM gTscOfsHw = { 0, TscOfsHwIsAP, TscOfsHwStartAP, TscOfsHwWaitAP };
+
+/**
+  Measure the TSC offset of all APs vs. the BSP for TSCSYNC_PROTOCOL
+
+  @retval number of CPUs in rgllOffset, 1 with the BSP only if EFI_MP_SERVICES_PROTOCOL is N/A or an AP failed
+
+**/
+static uint32_t TscOfsHwRun(int64_t* rgllOffset, uint32_t cntMax)
+{
+	UINTN nCpus = 0, nEnabled = 0;
+	int nRet;
+
+	MpContHwInit();													// locate EFI_MP_SERVICES_PROTOCOL
+
+	if (nullptr != gpMpServices && EFI_SUCCESS == gpMpServices->GetNumberOfProcessors(gpMpServices, &nCpus, &nEnabled))
+	{
+		gTscOfsHw.nCpus = (uint32_t)nCpus;
+
+		nRet = TscOffsetRun(&gTscOfsHw, (double)gTSCPerSecACPIRnd, rgllOffset, nullptr, cntMax);
+		if (nRet > 0)
+			return (uint32_t)nRet;
+	}
+
+	rgllOffset[0] = 0;
+
+	return 1;
+}
 
 /////////////////////////////////////////////////////////////////////////////
 // FILE menu functions and strings
@@ -604,7 +862,7 @@ int fnMnuItm_File_SaveAs(CTextWindow* pThis, void* pContext, void* pParm)
 				sprintf(strtmp, "TSCSync generated Excel Table\n\nAnalyzing platform timer characteristics\n\n"), worksheet_write_string(worksheet, CELL("B1"), strtmp, bold);
 				sprintf(strtmp, "ACPI OemId: %s", gstrACPIOemId), worksheet_write_string(worksheet, CELL("B2"), strtmp, bold);
 				sprintf(strtmp, "ACPI OemTableId: %s", gstrACPIOemTableId), worksheet_write_string(worksheet, CELL("B3"), strtmp, bold);
-				sprintf(strtmp, "ACPI Timer I/O Address: %s", gstrACPIPmTmrBlkAddr), worksheet_write_string(worksheet, CELL("B4"), strtmp, bold);
+				sprintf(strtmp, "ACPI Timer Address: %s", gstrACPIPmTmrBlkAddr), worksheet_write_string(worksheet, CELL("B4"), strtmp, bold);
 				sprintf(strtmp, "ACPI Timer Size: %s", gACPIPmTmrBlkSize), worksheet_write_string(worksheet, CELL("B5"), strtmp, bold);
 				sprintf(strtmp, "ACPI PCIEBase: %s", gACPIPCIEBase), worksheet_write_string(worksheet, CELL("B6"), strtmp, bold);
 				sprintf(strtmp, "Vendor CPUID: %s", gstrCPUID0), worksheet_write_string(worksheet, CELL("B7"), strtmp, bold);
@@ -622,9 +880,50 @@ int fnMnuItm_File_SaveAs(CTextWindow* pThis, void* pContext, void* pParm)
 
 				sprintf(strtmp, "target .XLSX: %s", gCfgStr_File_SaveAs), worksheet_write_string(worksheet, CELL("B19"), strtmp, bold);
 				//sprintf(strtmp, "RefTimerDev: %s", 2 == gfCfgSyncRef012 ? "i8254" : (1 == gfCfgSyncRef012 ? "RTC" : "ACPI")), worksheet_write_string(worksheet, CELL("B18"), strtmp, bold);//0 -> ACPI, 1 -> RTC, 2 -> PIT
+				if (0 != cntSamples)
+					sprintf(strtmp, "AP load during calibration: %s", gstrApLoad), worksheet_write_string(worksheet, CELL("B18"), strtmp, bold);
 				//sprintf(strtmp, "RefSyncTime: %ds", gnCfgRefSyncTime), worksheet_write_string(worksheet, CELL("B17"), strtmp, bold);
-				sprintf(strtmp, "Calibration Method: %s", gCfgStr_CalibrMethod), worksheet_write_string(worksheet, CELL("B20"), strtmp, bold);
+				if (1)
+				{
+					char strChunk[128] = { "" };
+
+					if (gfChunkedWait && pfnDelay != &PITOut2ClkWait)
+						sprintf(strChunk, ", interrupts enabled every 1ms, max. window %lldus, %lld counter wraps lost in windows restored", gqwClkWaitWindowMax * 1000000 / gTSCPerSecRTC, gcntClkWaitWrapLost);
+					sprintf(strtmp, "Calibration Method: %s%s%s", gCfgStr_CalibrMethod, pfnDelay == &AcpiClkWait && gfAcpiTmrSts ? ", long intervals coarse on TMR_STS" : "", strChunk), worksheet_write_string(worksheet, CELL("B20"), strtmp, bold);
+				}
 				sprintf(strtmp, "Error correction: %s", 0 == gfErrorCorrection ? "disabled" : (pfnDelay == &InternalAcpiDelay ? "N/A on TIANOCORE" : "enabled")), worksheet_write_string(worksheet, CELL("B21"), strtmp, bold);
+				if (0 != gHwLatResult.qwTSCSampled)
+					sprintf(strtmp, "HW latency worst case: %lldus, %lld gaps above %dus", gHwLatResult.qwTSCWorst / gHwLatResult.qwTSCPerUs, gHwLatResult.cntGaps, gnCfgHwLatThresholdUs), worksheet_write_string(worksheet, CELL("B22"), strtmp, bold);
+				if (0 != gStabilityResult.cntTau)
+					sprintf(strtmp, "TSC vs. ACPI timer: ADEV(%.3fs) %.2e, %+.3f ppm", gStabilityResult.rgdblTau[0], gStabilityResult.rgdblAdev[0], gStabilityResult.dblFreqOffset * 1e6), worksheet_write_string(worksheet, CELL("B23"), strtmp, bold);
+				if (0 != gSpectrumResult.cntPlot)
+				{
+					char strSSC[48] = { "no SSC" }, strSMI[48] = { "no periodic SMI" };
+
+					if (gSpectrumResult.fSSC)
+						sprintf(strSSC, "SSC %.1fkHz %.2f%%", gSpectrumResult.dblSSCRate / 1000, gSpectrumResult.dblSSCDepth * 100);
+					if (gSpectrumResult.fSMI)
+						sprintf(strSMI, "periodic SMI %.3fms", gSpectrumResult.dblSMIPeriod * 1000);
+					sprintf(strtmp, "TSC vs. ACPI timer spectrum: %s, %s", strSSC, strSMI), worksheet_write_string(worksheet, CELL("B24"), strtmp, bold);
+				}
+				sprintf(strtmp, "Timestamp policy: %s, %lld TSC cycles overhead", grgstrTimestampPolicy[gnTimestampPolicy], grgqwTimestampOverhead[gnTimestampPolicy]), worksheet_write_string(worksheet, CELL("B27"), strtmp, bold);
+				if (0 != gcntClkWaitSamples)
+					sprintf(strtmp, "Counter glitches: %lld in %lld samples, verified reads %s, %s", gcntClkWaitGlitch, gcntClkWaitSamples, gfVerifiedRead ? "enabled" : "disabled", ClkWaitGlitchVerdict()), worksheet_write_string(worksheet, CELL("B28"), strtmp, bold);
+				for (int i = 0, row = 28; i < ELC(parms) && 0 != cntSamples; i++)
+				{
+					if (false == *parms[i].pEna)
+						continue;
+					sprintf(strtmp, "Drift std. deviation, calibration time %s: %.3fs per day (%s)", parms[i].szCalibrTime, DriftStdDev(parms[i].rgDriftSecPerDay, cntSamples), grgstrTimestampPolicy[gnTimestampPolicy]);
+					worksheet_write_string(worksheet, row++, 1, strtmp, bold);
+				}
+				if (0 != gClockServo.cntHist)
+					sprintf(strtmp, "Drift servo: %+.3f ppm, residual %+.1fus, converged %s", gClockServo.dblFreq * 1e6, gClockServo.dblOffset * 1e6, gClockServo.dblLockTime < 0.0 ? "no" : "yes"), worksheet_write_string(worksheet, CELL("B26"), strtmp, bold);
+				if (0 != gKalmanState.cntHist)
+				{
+					KALMAN_ESTIMATE* pEst = &gKalmanState.rgHist[gKalmanState.cntHist - 1];
+
+					sprintf(strtmp, "Kalman fusion: %.0f +/- %.0fHz (RTC), %.0f +/- %.0fHz (ACPI)", pEst->dblTSCPerSec, pEst->dblTSCPerSecSigma, pEst->dblTSCPerSecACPI, pEst->dblTSCPerSecACPISigma), worksheet_write_string(worksheet, CELL("B25"), strtmp, bold);
+				}
 
 			}
 
@@ -705,7 +1004,7 @@ int fnMnuItm_File_SaveAs(CTextWindow* pThis, void* pContext, void* pParm)
 
 				}
 				chart_title_set_name(chart, "Overall preview, drift in seconds per day. Parameter:\nCalibration time");
-				worksheet_insert_chart(worksheet, CELL("B25"), chart);
+				worksheet_insert_chart(worksheet, CELL("B35"), chart);
 			}
 
             //
@@ -749,7 +1048,7 @@ int fnMnuItm_File_SaveAs(CTextWindow* pThis, void* pContext, void* pParm)
 
                 chartsheet_set_landscape(chartsheet1);
 
-                worksheet_insert_chart(worksheet, CELL("B41"), chart);
+                worksheet_insert_chart(worksheet, CELL("B51"), chart);
             }
 
 			//
@@ -839,6 +1138,596 @@ int fnMnuItm_File_SaveAs(CTextWindow* pThis, void* pContext, void* pParm)
 				//	pThis->TextWindowUpdateProgress();
 			}
 
+			//
+			// HW latency detector results on separate worksheet
+			//
+			if (0 != gHwLatResult.qwTSCSampled)
+			{
+				HWLAT_RESULT* p = &gHwLatResult;
+				double dblTSCPerUs = (double)p->qwTSCPerUs;
+				lxw_worksheet* wsHwLat = workbook_add_worksheet(workbook, "HWLAT");
+				lxw_chart* chartHist = workbook_add_chart(workbook, LXW_CHART_COLUMN);
+				char strtmp[128], strCategory[64], strValue[64];
+
+				worksheet_set_column(wsHwLat, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsHwLat, COLS("D:F"), 18, nullptr);
+
+				worksheet_write_string(wsHwLat, CELL("A1"), "Hardware latency (SMI/stall) detector", bold);
+				sprintf(strtmp, "window: %d ms, threshold: %d us", gnCfgHwLatWindowMs, gnCfgHwLatThresholdUs), worksheet_write_string(wsHwLat, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "TSC reads: %lld, %.1f ns per read", p->cntLoops, (double)p->qwTSCSampled * 1000.0 / dblTSCPerUs / (double)p->cntLoops), worksheet_write_string(wsHwLat, CELL("A3"), strtmp, nullptr);
+				sprintf(strtmp, "gaps above threshold: %lld, %.1f us stalled", p->cntGaps, (double)p->qwTSCStalled / dblTSCPerUs), worksheet_write_string(wsHwLat, CELL("A4"), strtmp, nullptr);
+				sprintf(strtmp, "worst case: %.1f us @ %lld ms, SMI_COUNT delta %u", (double)p->qwTSCWorst / dblTSCPerUs, p->qwTSCWorstTimestamp / (p->qwTSCPerUs * 1000), p->dwSMIWorst), worksheet_write_string(wsHwLat, CELL("A5"), strtmp, nullptr);
+				if (p->fSMICount)
+					sprintf(strtmp, "SMI_COUNT (MSR 0x34): %u SMIs during detection", p->dwSMITotal);
+				else
+					sprintf(strtmp, "SMI_COUNT (MSR 0x34): N/A");
+				worksheet_write_string(wsHwLat, CELL("A6"), strtmp, nullptr);
+				sprintf(strtmp, "gaps recorded in detail: %u of %lld", p->cntRecorded, p->cntGaps), worksheet_write_string(wsHwLat, CELL("A7"), strtmp, nullptr);
+
+				//
+				// histogram
+				//
+				worksheet_write_string(wsHwLat, CELL("A10"), "histogram bin", bold);
+				worksheet_write_string(wsHwLat, CELL("B10"), "count", bold);
+				for (int i = 0; i < HWLAT_NUMBINS + 1; i++)
+				{
+					if (i < HWLAT_NUMBINS)
+						sprintf(strtmp, "%u..%uus", 0 == i ? p->dwThresholdUs : p->rgdwBinLimitUs[i - 1], p->rgdwBinLimitUs[i]);
+					else
+						sprintf(strtmp, ">%uus", p->rgdwBinLimitUs[i - 1]);
+					worksheet_write_string(wsHwLat, 10 + i, 0, strtmp, nullptr);
+					worksheet_write_number(wsHwLat, 10 + i, 1, (double)p->rgcntBin[i], nullptr);
+				}
+
+				sprintf(strCategory, "=HWLAT!$A$11:$A$%d", 11 + HWLAT_NUMBINS);
+				sprintf(strValue, "=HWLAT!$B$11:$B$%d", 11 + HWLAT_NUMBINS);
+				series = chart_add_series(chartHist, strCategory, strValue);
+				chart_series_set_name(series, "gaps above threshold");
+				chart_title_set_name(chartHist, "HW latency histogram");
+				worksheet_insert_chart(wsHwLat, CELL("H2"), chartHist);
+
+				//
+				// gap list
+				//
+				worksheet_write_string(wsHwLat, CELL("D10"), "timestamp [ms]", bold);
+				worksheet_write_string(wsHwLat, CELL("E10"), "duration [us]", bold);
+				worksheet_write_string(wsHwLat, CELL("F10"), "SMI_COUNT delta", bold);
+				for (uint32_t i = 0; i < p->cntRecorded; i++)
+				{
+					worksheet_write_number(wsHwLat, 10 + i, 3, (double)p->rgGap[i].qwTSCTimestamp / dblTSCPerUs / 1000.0, nullptr);
+					worksheet_write_number(wsHwLat, 10 + i, 4, (double)p->rgGap[i].qwTSCDuration / dblTSCPerUs, nullptr);
+					worksheet_write_number(wsHwLat, 10 + i, 5, (double)p->rgGap[i].dwSMIDelta, nullptr);
+				}
+
+				if (0 != p->cntRecorded)
+				{
+					lxw_chart* chartGaps = workbook_add_chart(workbook, LXW_CHART_SCATTER);
+
+					sprintf(strCategory, "=HWLAT!$D$11:$D$%d", 10 + p->cntRecorded);
+					sprintf(strValue, "=HWLAT!$E$11:$E$%d", 10 + p->cntRecorded);
+					series = chart_add_series(chartGaps, strCategory, strValue);
+					chart_series_set_name(series, "gap duration [us]");
+					chart_title_set_name(chartGaps, "HW latency gaps over time [ms]");
+					worksheet_insert_chart(wsHwLat, CELL("H18"), chartGaps);
+				}
+			}
+
+			//
+			// oscillator stability results on separate worksheet, ADEV and MTIE log-log
+			//
+			if (0 != gStabilityResult.cntTau)
+			{
+				STABILITY_RESULT* p = &gStabilityResult;
+				lxw_worksheet* wsAdev = workbook_add_worksheet(workbook, "ADEV");
+				lxw_chart* chartAdev = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT_WITH_MARKERS);
+				lxw_chart* chartMtie = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT_WITH_MARKERS);
+				lxw_chart* chartTie = workbook_add_chart(workbook, LXW_CHART_SCATTER);
+				char strtmp[128], strCategory[64], strValue[64];
+
+				worksheet_set_column(wsAdev, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsAdev, COLS("B:F"), 16, nullptr);
+
+				worksheet_write_string(wsAdev, CELL("A1"), "Oscillator stability, TSC vs. ACPI timer", bold);
+				sprintf(strtmp, "phase record: %u samples, tau0 %.3f ms", p->cntSamples, p->dblTau0 * 1000.0), worksheet_write_string(wsAdev, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "TSC frequency: %.0f Hz", p->dblTSCPerSec), worksheet_write_string(wsAdev, CELL("A3"), strtmp, nullptr);
+				sprintf(strtmp, "TSC frequency offset: %+.3f ppm, removed from MTIE/TIE", p->dblFreqOffset * 1e6), worksheet_write_string(wsAdev, CELL("A4"), strtmp, nullptr);
+
+				worksheet_write_string(wsAdev, CELL("A10"), "tau [s]", bold);
+				worksheet_write_string(wsAdev, CELL("B10"), "ADEV", bold);
+				worksheet_write_string(wsAdev, CELL("C10"), "MTIE [s]", bold);
+				for (uint32_t i = 0; i < p->cntTau; i++)
+				{
+					worksheet_write_number(wsAdev, 10 + i, 0, p->rgdblTau[i], nullptr);
+					worksheet_write_number(wsAdev, 10 + i, 1, p->rgdblAdev[i], nullptr);
+					worksheet_write_number(wsAdev, 10 + i, 2, p->rgdblMtie[i], nullptr);
+				}
+
+				worksheet_write_string(wsAdev, CELL("E10"), "time [s]", bold);
+				worksheet_write_string(wsAdev, CELL("F10"), "TIE [ns]", bold);
+				for (uint32_t i = 0; i < p->cntTie; i++)
+				{
+					worksheet_write_number(wsAdev, 10 + i, 4, p->dblTau0 * p->dwTieStep * i, nullptr);
+					worksheet_write_number(wsAdev, 10 + i, 5, p->rgdblTie[i] * 1e9, nullptr);
+				}
+
+				sprintf(strCategory, "=ADEV!$A$11:$A$%d", 10 + p->cntTau);
+				sprintf(strValue, "=ADEV!$B$11:$B$%d", 10 + p->cntTau);
+				series = chart_add_series(chartAdev, strCategory, strValue);
+				chart_series_set_name(series, "ADEV");
+				chart_title_set_name(chartAdev, "Allan deviation");
+				chart_axis_set_name(chartAdev->x_axis, "tau [s]");
+				chart_axis_set_log_base(chartAdev->x_axis, 10);
+				chart_axis_set_log_base(chartAdev->y_axis, 10);
+				worksheet_insert_chart(wsAdev, CELL("H2"), chartAdev);
+
+				sprintf(strValue, "=ADEV!$C$11:$C$%d", 10 + p->cntTau);
+				series = chart_add_series(chartMtie, strCategory, strValue);
+				chart_series_set_name(series, "MTIE [s]");
+				chart_title_set_name(chartMtie, "Maximum time interval error");
+				chart_axis_set_name(chartMtie->x_axis, "tau [s]");
+				chart_axis_set_log_base(chartMtie->x_axis, 10);
+				chart_axis_set_log_base(chartMtie->y_axis, 10);
+				worksheet_insert_chart(wsAdev, CELL("H18"), chartMtie);
+
+				sprintf(strCategory, "=ADEV!$E$11:$E$%d", 10 + p->cntTie);
+				sprintf(strValue, "=ADEV!$F$11:$F$%d", 10 + p->cntTie);
+				series = chart_add_series(chartTie, strCategory, strValue);
+				chart_series_set_name(series, "TIE [ns]");
+				chart_title_set_name(chartTie, "Time interval error over time [s]");
+				worksheet_insert_chart(wsAdev, CELL("H34"), chartTie);
+			}
+
+			//
+			// spectrum results on separate worksheet, log-log
+			//
+			if (0 != gSpectrumResult.cntPlot)
+			{
+				SPECTRUM_RESULT* p = &gSpectrumResult;
+				lxw_worksheet* wsSpec = workbook_add_worksheet(workbook, "SPECTRUM");
+				lxw_chart* chartFreqDev = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT);
+				lxw_chart* chartPhase = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT);
+				char strtmp[128], strCategory[64], strValue[64];
+
+				worksheet_set_column(wsSpec, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsSpec, COLS("B:G"), 16, nullptr);
+
+				worksheet_write_string(wsSpec, CELL("A1"), "Spectrum, TSC vs. ACPI timer", bold);
+				sprintf(strtmp, "FFT length: %u, fs %.3f kHz, resolution %.3f Hz", p->cntSamples, p->dblFs / 1000, p->dblDf), worksheet_write_string(wsSpec, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "TSC frequency offset: %+.3f ppm, phase spike samples: %u", p->dblFreqOffset * 1e6, p->cntSpikes), worksheet_write_string(wsSpec, CELL("A3"), strtmp, nullptr);
+				if (p->fSSC)
+					sprintf(strtmp, "SSC: %.3f kHz, depth %.3f%% (triangular)", p->dblSSCRate / 1000, p->dblSSCDepth * 100);
+				else
+					sprintf(strtmp, "SSC: not detected");
+				worksheet_write_string(wsSpec, CELL("A4"), strtmp, nullptr);
+				if (p->fSMI)
+					sprintf(strtmp, "periodic SMI: %.3f ms, %.1f ns phase amplitude, %u harmonics", p->dblSMIPeriod * 1000, p->dblSMIAmpl * 1e9, p->cntSMIHarm);
+				else
+					sprintf(strtmp, "periodic SMI: not detected");
+				worksheet_write_string(wsSpec, CELL("A5"), strtmp, nullptr);
+
+				worksheet_write_string(wsSpec, CELL("A10"), "frequency [Hz]", bold);
+				worksheet_write_string(wsSpec, CELL("B10"), "freq. dev. [ppm]", bold);
+				worksheet_write_string(wsSpec, CELL("C10"), "phase [ns]", bold);
+				for (uint32_t i = 0; i < p->cntPlot; i++)
+				{
+					worksheet_write_number(wsSpec, 10 + i, 0, p->rgdblPlotFreq[i], nullptr);
+					worksheet_write_number(wsSpec, 10 + i, 1, p->rgdblPlotFreqDev[i] * 1e6, nullptr);
+					worksheet_write_number(wsSpec, 10 + i, 2, p->rgdblPlotPhase[i] * 1e9, nullptr);
+				}
+
+				worksheet_write_string(wsSpec, CELL("E10"), "line [Hz]", bold);
+				worksheet_write_string(wsSpec, CELL("F10"), "freq. dev. [ppm]", bold);
+				worksheet_write_string(wsSpec, CELL("G10"), "phase [ns]", bold);
+				worksheet_write_string(wsSpec, CELL("H10"), "SNR", bold);
+				for (uint32_t i = 0; i < p->cntPeak; i++)
+				{
+					worksheet_write_number(wsSpec, 10 + i, 4, p->rgPeak[i].dblFreq, nullptr);
+					worksheet_write_number(wsSpec, 10 + i, 5, p->rgPeak[i].dblFreqDev * 1e6, nullptr);
+					worksheet_write_number(wsSpec, 10 + i, 6, p->rgPeak[i].dblPhase * 1e9, nullptr);
+					worksheet_write_number(wsSpec, 10 + i, 7, p->rgPeak[i].dblSNR, nullptr);
+				}
+
+				sprintf(strCategory, "=SPECTRUM!$A$11:$A$%d", 10 + p->cntPlot);
+				sprintf(strValue, "=SPECTRUM!$B$11:$B$%d", 10 + p->cntPlot);
+				series = chart_add_series(chartFreqDev, strCategory, strValue);
+				chart_series_set_name(series, "freq. dev. [ppm]");
+				chart_title_set_name(chartFreqDev, "Frequency deviation spectrum");
+				chart_axis_set_name(chartFreqDev->x_axis, "frequency [Hz]");
+				chart_axis_set_log_base(chartFreqDev->x_axis, 10);
+				chart_axis_set_log_base(chartFreqDev->y_axis, 10);
+				worksheet_insert_chart(wsSpec, CELL("J2"), chartFreqDev);
+
+				sprintf(strValue, "=SPECTRUM!$C$11:$C$%d", 10 + p->cntPlot);
+				series = chart_add_series(chartPhase, strCategory, strValue);
+				chart_series_set_name(series, "phase [ns]");
+				chart_title_set_name(chartPhase, "Phase spectrum");
+				chart_axis_set_name(chartPhase->x_axis, "frequency [Hz]");
+				chart_axis_set_log_base(chartPhase->x_axis, 10);
+				chart_axis_set_log_base(chartPhase->y_axis, 10);
+				worksheet_insert_chart(wsSpec, CELL("J18"), chartPhase);
+			}
+
+			//
+			// Kalman fusion convergence history on separate worksheet
+			//
+			if (0 != gKalmanState.cntHist)
+			{
+				KALMAN_STATE* p = &gKalmanState;
+				KALMAN_ESTIMATE* pEst = &p->rgHist[p->cntHist - 1];
+				lxw_worksheet* wsKalman = workbook_add_worksheet(workbook, "KALMAN");
+				lxw_chart* chartEst = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT);
+				lxw_chart* chartSigma = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT);
+				char strtmp[128], strCategory[64], strValue[64];
+				static const char* rgstrHdr[] = { "time [s]", "TSC/s RTC", "sigma [Hz]", "TSC/s ACPI", "sigma [Hz]", "ACPI vs RTC [ppm]", "sigma [ppm]", "PIT vs RTC [ppm]", "sigma [ppm]", "drift [ppb/s]", "sigma [ppb/s]" };
+
+				worksheet_set_column(wsKalman, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsKalman, COLS("B:L"), 16, nullptr);
+
+				worksheet_write_string(wsKalman, CELL("A1"), "Kalman filter, ACPI/PIT/RTC fusion", bold);
+				sprintf(strtmp, "observations: ACPI %lld, PIT %lld, RTC %lld", p->rgcntObs[KF_REF_ACPI], p->rgcntObs[KF_REF_PIT], p->rgcntObs[KF_REF_RTC]), worksheet_write_string(wsKalman, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "TSC frequency (RTC): %.1f +/- %.1f Hz", pEst->dblTSCPerSec, pEst->dblTSCPerSecSigma), worksheet_write_string(wsKalman, CELL("A3"), strtmp, nullptr);
+				sprintf(strtmp, "TSC frequency (ACPI): %.1f +/- %.1f Hz", pEst->dblTSCPerSecACPI, pEst->dblTSCPerSecACPISigma), worksheet_write_string(wsKalman, CELL("A4"), strtmp, nullptr);
+				sprintf(strtmp, "ACPI vs RTC: %+.3f +/- %.3f ppm, PIT vs RTC: %+.3f +/- %.3f ppm", pEst->dblACPIvsRTC * 1e6, pEst->dblACPIvsRTCSigma * 1e6, pEst->dblPITvsRTC * 1e6, pEst->dblPITvsRTCSigma * 1e6), worksheet_write_string(wsKalman, CELL("A5"), strtmp, nullptr);
+				sprintf(strtmp, "TSC drift: %+.3f +/- %.3f ppb/s", pEst->dblDrift * 1e9, pEst->dblDriftSigma * 1e9), worksheet_write_string(wsKalman, CELL("A6"), strtmp, nullptr);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsKalman, 9, 1 + i, rgstrHdr[i], bold);
+
+				for (uint32_t i = 0; i < p->cntHist; i++)
+				{
+					KALMAN_ESTIMATE* e = &p->rgHist[i];
+					double rgdbl[] = { e->dblTime, e->dblTSCPerSec, e->dblTSCPerSecSigma, e->dblTSCPerSecACPI, e->dblTSCPerSecACPISigma,
+						e->dblACPIvsRTC * 1e6, e->dblACPIvsRTCSigma * 1e6, e->dblPITvsRTC * 1e6, e->dblPITvsRTCSigma * 1e6, e->dblDrift * 1e9, e->dblDriftSigma * 1e9 };
+
+					for (int j = 0; j < (int)(sizeof(rgdbl) / sizeof(rgdbl[0])); j++)
+						worksheet_write_number(wsKalman, 10 + i, 1 + j, rgdbl[j], nullptr);
+				}
+
+				sprintf(strCategory, "=KALMAN!$B$11:$B$%d", 10 + p->cntHist);
+				sprintf(strValue, "=KALMAN!$C$11:$C$%d", 10 + p->cntHist);
+				series = chart_add_series(chartEst, strCategory, strValue);
+				chart_series_set_name(series, "TSC/s RTC");
+				sprintf(strValue, "=KALMAN!$E$11:$E$%d", 10 + p->cntHist);
+				series = chart_add_series(chartEst, strCategory, strValue);
+				chart_series_set_name(series, "TSC/s ACPI");
+				chart_title_set_name(chartEst, "TSC frequency estimate over time [s]");
+				worksheet_insert_chart(wsKalman, CELL("N2"), chartEst);
+
+				sprintf(strValue, "=KALMAN!$D$11:$D$%d", 10 + p->cntHist);
+				series = chart_add_series(chartSigma, strCategory, strValue);
+				chart_series_set_name(series, "sigma RTC [Hz]");
+				sprintf(strValue, "=KALMAN!$F$11:$F$%d", 10 + p->cntHist);
+				series = chart_add_series(chartSigma, strCategory, strValue);
+				chart_series_set_name(series, "sigma ACPI [Hz]");
+				chart_title_set_name(chartSigma, "TSC frequency uncertainty over time [s]");
+				chart_axis_set_log_base(chartSigma->x_axis, 10);
+				chart_axis_set_log_base(chartSigma->y_axis, 10);
+				worksheet_insert_chart(wsKalman, CELL("N18"), chartSigma);
+			}
+
+			//
+			// ACPI vs. PIT cross-reference on separate worksheet
+			//
+			if (0 != gXRefResult.dblSeconds)
+			{
+				XREF_RESULT* p = &gXRefResult;
+				lxw_worksheet* wsXRef = workbook_add_worksheet(workbook, "XREF");
+				lxw_chart* chartRes = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT);
+				char strtmp[128], strCategory[64], strValue[64];
+				static const char* rgstrHdr[] = { "time [s]", "ACPI residual [ns]", "PIT residual [ns]", "ACPI - PIT [ns]" };
+
+				worksheet_set_column(wsXRef, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsXRef, COLS("B:E"), 18, nullptr);
+
+				worksheet_write_string(wsXRef, CELL("A1"), "ACPI timer vs. PIT i8254 cross-reference", bold);
+				sprintf(strtmp, "run time: %.1f s, %u samples, %lld ACPI/PIT read pairs", p->dblSeconds, p->cntSamples, p->cntReads), worksheet_write_string(wsXRef, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "ACPI: %.1f Hz, PIT: %.1f Hz (TSC time scale)", p->rgdblHz[XREF_REF_ACPI], p->rgdblHz[XREF_REF_PIT]), worksheet_write_string(wsXRef, CELL("A3"), strtmp, nullptr);
+				sprintf(strtmp, "ACPI:PIT ratio: %.9f, %+.3f ppm vs. %.0f", p->dblRatio, p->dblRatioPpm, XREF_RATIO_NOMINAL), worksheet_write_string(wsXRef, CELL("A4"), strtmp, nullptr);
+				sprintf(strtmp, "ratio drift: %+.4f ppm/s", p->dblRatioDrift), worksheet_write_string(wsXRef, CELL("A5"), strtmp, nullptr);
+				sprintf(strtmp, "jitter vs. TSC: ACPI %.1f ns, PIT %.1f ns, ACPI - PIT %.1f ns", p->rgdblJitter[XREF_REF_ACPI] * 1e9, p->rgdblJitter[XREF_REF_PIT] * 1e9, p->dblJitterRel * 1e9), worksheet_write_string(wsXRef, CELL("A6"), strtmp, nullptr);
+				sprintf(strtmp, "calibration time for %.1f ppm: ACPI %.2f s, PIT %.2f s", XREF_PPM_TARGET, p->rgdblCalSec[XREF_REF_ACPI], p->rgdblCalSec[XREF_REF_PIT]), worksheet_write_string(wsXRef, CELL("A7"), strtmp, nullptr);
+				sprintf(strtmp, "recommended reference: %s", grgstrXRefName[p->nRecommended]), worksheet_write_string(wsXRef, CELL("A8"), strtmp, bold);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsXRef, 9, 1 + i, rgstrHdr[i], bold);
+
+				for (uint32_t i = 0; i < p->cntSamples; i++)
+				{
+					double dblResAcpi = CrossRefResidual(p, XREF_REF_ACPI, i), dblResPit = CrossRefResidual(p, XREF_REF_PIT, i);
+					double rgdbl[] = { (double)p->rgSample[i].rgqwTSC[XREF_REF_ACPI] / p->dblTSCNominal, dblResAcpi * 1e9, dblResPit * 1e9, (dblResAcpi - dblResPit) * 1e9 };
+
+					for (int j = 0; j < (int)(sizeof(rgdbl) / sizeof(rgdbl[0])); j++)
+						worksheet_write_number(wsXRef, 10 + i, 1 + j, rgdbl[j], nullptr);
+				}
+
+				sprintf(strCategory, "=XREF!$B$11:$B$%d", 10 + p->cntSamples);
+				sprintf(strValue, "=XREF!$C$11:$C$%d", 10 + p->cntSamples);
+				series = chart_add_series(chartRes, strCategory, strValue);
+				chart_series_set_name(series, "ACPI [ns]");
+				sprintf(strValue, "=XREF!$D$11:$D$%d", 10 + p->cntSamples);
+				series = chart_add_series(chartRes, strCategory, strValue);
+				chart_series_set_name(series, "PIT [ns]");
+				chart_title_set_name(chartRes, "residual vs. TSC over time [s]");
+				worksheet_insert_chart(wsXRef, CELL("G2"), chartRes);
+			}
+
+			//
+			// TimerLib benchmark on separate worksheet
+			//
+			if (0 != gTimerLibResult.cntLib)
+			{
+				TLB_RESULT* p = &gTimerLibResult;
+				lxw_worksheet* wsTlb = workbook_add_worksheet(workbook, "TIMERLIB");
+				char strtmp[128];
+				const char* rgstrHdr[] = { "TimerLib", "function", "requested", "requested [us]", "repetitions", "avg [us]", "min [us]", "max [us]", "error [%]" };
+				int row = 6;
+
+				worksheet_set_column(wsTlb, COLS("A:B"), 24, nullptr);
+				worksheet_set_column(wsTlb, COLS("C:I"), 14, nullptr);
+
+				worksheet_write_string(wsTlb, CELL("A1"), "TianoCore TimerLib MicroSecondDelay()/NanoSecondDelay() benchmark", bold);
+				sprintf(strtmp, "actual delay vs. TSC %.0fHz, interrupts disabled", p->dblTSCPerSec), worksheet_write_string(wsTlb, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "most POST time lost: %s, %.1f us per delay series", p->rgLib[p->nWorst].pstrName, p->rgLib[p->nWorst].dblExcessUs), worksheet_write_string(wsTlb, CELL("A3"), strtmp, bold);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsTlb, 5, i, rgstrHdr[i], bold);
+
+				for (int n = 0; n < TLB_NUMLIB; n++)
+				{
+					TLB_LIB* pLib = &p->rgLib[n];
+
+					if (!pLib->fAvailable)
+					{
+						worksheet_write_string(wsTlb, row, 0, pLib->pstrName, nullptr);
+						worksheet_write_string(wsTlb, row++, 1, "N/A", nullptr);
+						continue;
+					}
+
+					for (int f = 0; f < 2; f++)
+					{
+						for (int i = 0; i < TLB_NUMDELAY; i++, row++)
+						{
+							TLB_POINT* pPoint = 0 == f ? &pLib->rgMicro[i] : &pLib->rgNano[i];
+
+							sprintf(strtmp, "%s, %lld Hz", pLib->pstrName, pLib->qwFreq), worksheet_write_string(wsTlb, row, 0, strtmp, nullptr);
+							worksheet_write_string(wsTlb, row, 1, 0 == f ? "MicroSecondDelay()" : "NanoSecondDelay()", nullptr);
+							worksheet_write_number(wsTlb, row, 2, (double)pPoint->qwRequested, nullptr);
+							worksheet_write_number(wsTlb, row, 3, (double)grgdwTlbDelayUs[i], nullptr);
+							worksheet_write_number(wsTlb, row, 4, (double)pPoint->cntReps, nullptr);
+							worksheet_write_number(wsTlb, row, 5, pPoint->dblAvgUs, nullptr);
+							worksheet_write_number(wsTlb, row, 6, pPoint->dblMinUs, nullptr);
+							worksheet_write_number(wsTlb, row, 7, pPoint->dblMaxUs, nullptr);
+							worksheet_write_number(wsTlb, row, 8, pPoint->dblErrPct, nullptr);
+						}
+					}
+				}
+			}
+
+			//
+			// TSC delay service benchmark on separate worksheet
+			//
+			if (0 != gTscTimeBench.dblTSCPerSec)
+			{
+				TSCTIME_BENCH* p = &gTscTimeBench;
+				lxw_worksheet* wsTscTime = workbook_add_worksheet(workbook, "TSCDELAY");
+				char strtmp[128];
+				const char* rgstrHdr[] = { "delay", "requested [us]", "repetitions", "latency [ns]", "avg [ns]", "overshoot [ns]", "max. overshoot [ns]", "stddev [ns]", "precision TSC vs. ACPI" };
+				int row = 5;
+
+				worksheet_set_column(wsTscTime, COLS("A:A"), 24, nullptr);
+				worksheet_set_column(wsTscTime, COLS("B:I"), 18, nullptr);
+
+				worksheet_write_string(wsTscTime, CELL("A1"), "Calibrated TSC delay service vs. InternalAcpiDelay()", bold);
+				sprintf(strtmp, "actual delay vs. TSC %.0fHz, service runs on %lldHz, interrupts disabled", p->dblTSCPerSec, gqwTscTimeFreq), worksheet_write_string(wsTscTime, CELL("A2"), strtmp, nullptr);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsTscTime, 4, i, rgstrHdr[i], bold);
+
+				for (int n = 0; n < TSCTIME_NUMIMPL; n++)
+				{
+					if (TSCTIME_ACPI == n && !p->fAcpi)
+					{
+						worksheet_write_string(wsTscTime, row, 0, grgstrTscTimeName[n], nullptr);
+						worksheet_write_string(wsTscTime, row++, 1, "N/A", nullptr);
+						continue;
+					}
+
+					for (int i = 0; i < TSCTIME_NUMDELAY; i++, row++)
+					{
+						TSCTIME_POINT* pPoint = &p->rgPoint[n][i];
+
+						worksheet_write_string(wsTscTime, row, 0, grgstrTscTimeName[n], nullptr);
+						worksheet_write_number(wsTscTime, row, 1, (double)pPoint->dwRequestedUs, nullptr);
+						worksheet_write_number(wsTscTime, row, 2, (double)pPoint->cntReps, nullptr);
+						worksheet_write_number(wsTscTime, row, 3, p->rgdblLatencyNs[n], nullptr);
+						worksheet_write_number(wsTscTime, row, 4, pPoint->dblAvgNs, nullptr);
+						worksheet_write_number(wsTscTime, row, 5, pPoint->dblOvershootNs, nullptr);
+						worksheet_write_number(wsTscTime, row, 6, pPoint->dblMaxOvershootNs, nullptr);
+						worksheet_write_number(wsTscTime, row, 7, pPoint->dblStdDevNs, nullptr);
+						if (TSCTIME_ACPI == n)
+							worksheet_write_number(wsTscTime, row, 8, p->rgdblPrecision[i], nullptr);
+					}
+				}
+			}
+
+			//
+			// multi-core contention benchmark on separate worksheet
+			//
+			if (0 != gMpContResult.dblTSCPerSec)
+			{
+				MPCONT_RESULT* p = &gMpContResult;
+				lxw_worksheet* wsMpCont = workbook_add_worksheet(workbook, "MPCONTENTION");
+				char strtmp[128];
+				const char* rgstrHdr[] = { "timer", "cores", "reads", "reads/s", "avg latency [ns]", "max latency [ns]", "torn reads", "AP 0 TSC per sec", "calibration [ppm]" };
+				int row = 5;
+
+				worksheet_set_column(wsMpCont, COLS("A:A"), 24, nullptr);
+				worksheet_set_column(wsMpCont, COLS("B:I"), 18, nullptr);
+
+				worksheet_write_string(wsMpCont, CELL("A1"), "Multi-core concurrent timer reads, port I/O contention", bold);
+				sprintf(strtmp, "%u APs, AP 0 calibrates over %dms while the others poll, TSC %.0fHz", p->nAPs, MPCONT_CAL_MS, p->dblTSCPerSec), worksheet_write_string(wsMpCont, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "aggregate scaling %u vs. 1 core: ACPI %.2fx, PIT %.2fx", p->nAPs, p->rgdblScaling[MPCONT_ACPI], p->rgdblScaling[MPCONT_PIT]), worksheet_write_string(wsMpCont, CELL("A3"), strtmp, nullptr);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsMpCont, 4, i, rgstrHdr[i], bold);
+
+				for (int n = 0; n < MPCONT_NUMSRC; n++)
+				{
+					if (!p->rgfAvailable[n])
+					{
+						worksheet_write_string(wsMpCont, row, 0, grgstrMpContName[n], nullptr);
+						worksheet_write_string(wsMpCont, row++, 1, "N/A", nullptr);
+						continue;
+					}
+
+					for (uint32_t i = 0; i < p->nAPs; i++, row++)
+					{
+						MPCONT_POINT* pPoint = &p->rgPoint[n][i];
+
+						worksheet_write_string(wsMpCont, row, 0, grgstrMpContName[n], nullptr);
+						worksheet_write_number(wsMpCont, row, 1, (double)pPoint->nCores, nullptr);
+						worksheet_write_number(wsMpCont, row, 2, (double)pPoint->cntReads, nullptr);
+						worksheet_write_number(wsMpCont, row, 3, pPoint->dblReadsPerSec, nullptr);
+						worksheet_write_number(wsMpCont, row, 4, pPoint->dblAvgLatNs, nullptr);
+						worksheet_write_number(wsMpCont, row, 5, pPoint->dblMaxLatNs, nullptr);
+						worksheet_write_number(wsMpCont, row, 6, (double)pPoint->cntTorn, nullptr);
+						worksheet_write_number(wsMpCont, row, 7, pPoint->dblCalTSCPerSec, nullptr);
+						worksheet_write_number(wsMpCont, row, 8, pPoint->dblCalPpm, nullptr);
+					}
+				}
+			}
+
+			//
+			// timer primitives benchmark on separate worksheet
+			//
+			if (0 != gBenchResult.cntStat)
+			{
+				BENCH_RESULT* p = &gBenchResult;
+				double dblNsPerCycle = 1e9 / p->dblTSCPerSec;
+				lxw_worksheet* wsBench = workbook_add_worksheet(workbook, "BENCH");
+				char strtmp[128];
+				const char* rgstrHdr[] = { "primitive", "samples", "min [cyc]", "p50 [cyc]", "p99 [cyc]", "max [cyc]", "avg [cyc]", "p50 [ns]", "p99 [ns]", "max [ns]" };
+
+				worksheet_set_column(wsBench, COLS("A:A"), 24, nullptr);
+				worksheet_set_column(wsBench, COLS("B:J"), 12, nullptr);
+
+				worksheet_write_string(wsBench, CELL("A1"), "Timer read primitives benchmark", bold);
+				sprintf(strtmp, "measurement overhead %lld cycles subtracted, TSC %.0fHz", p->qwOverhead, p->dblTSCPerSec), worksheet_write_string(wsBench, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "ACPI wait rows: TSC per loop iteration incl. read over %d ticks, no overhead subtracted", BENCH_WAIT_TICKS), worksheet_write_string(wsBench, CELL("A3"), strtmp, nullptr);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsBench, 3, i, rgstrHdr[i], bold);
+
+				for (int n = 0; n < p->cntStat; n++)
+				{
+					BENCH_STAT* pStat = &p->rgStat[n];
+
+					worksheet_write_string(wsBench, 4 + n, 0, pStat->pstrName, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 1, (double)pStat->cntSamples, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 2, (double)pStat->qwMin, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 3, (double)pStat->qwP50, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 4, (double)pStat->qwP99, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 5, (double)pStat->qwMax, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 6, pStat->dblAvg, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 7, pStat->qwP50 * dblNsPerCycle, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 8, pStat->qwP99 * dblNsPerCycle, nullptr);
+					worksheet_write_number(wsBench, 4 + n, 9, pStat->qwMax * dblNsPerCycle, nullptr);
+				}
+			}
+
+			//
+			// local APIC timer vs. TSC, side-by-side on separate worksheet
+			//
+			if (0 != gApicTimerResult.dblHzRTC)
+			{
+				APIC_TIMER_RESULT* p = &gApicTimerResult;
+				double dblNsPerCycle = 1e9 / (double)gTSCPerSecRTC;
+				lxw_worksheet* wsApic = workbook_add_worksheet(workbook, "APICTIMER");
+				char strtmp[128];
+				const char* rgstrHdr[] = { "time source", "access", "frequency vs. RTC [Hz]", "frequency vs. ACPI [Hz]", "ACPI vs. RTC [ppm]", "read [cyc]", "read [ns]" };
+
+				worksheet_set_column(wsApic, COLS("A:G"), 24, nullptr);
+
+				worksheet_write_string(wsApic, CELL("A1"), "Local APIC timer vs. TSC", bold);
+				sprintf(strtmp, "measured within the same %.0f RTC seconds, APIC timer %s, counter range %lld", p->dblSeconds, p->fOwned ? "free running, divide by 1" : "firmware owned", p->qwModulus), worksheet_write_string(wsApic, CELL("A2"), strtmp, nullptr);
+
+				for (int i = 0; i < (int)(sizeof(rgstrHdr) / sizeof(rgstrHdr[0])); i++)
+					worksheet_write_string(wsApic, 3, i, rgstrHdr[i], bold);
+
+				worksheet_write_string(wsApic, 4, 0, "TSC", nullptr);
+				worksheet_write_string(wsApic, 4, 1, grgstrTimestampPolicy[gnTimestampPolicy], nullptr);
+				worksheet_write_number(wsApic, 4, 2, p->dblTSCHzRTC, nullptr);
+				worksheet_write_number(wsApic, 4, 3, p->dblTSCHzACPI, nullptr);
+				if (0 != p->dblTSCHzACPI)
+					worksheet_write_number(wsApic, 4, 4, (p->dblTSCHzACPI - p->dblTSCHzRTC) / p->dblTSCHzRTC * 1e6, nullptr);
+				worksheet_write_number(wsApic, 4, 5, (double)grgqwTimestampOverhead[gnTimestampPolicy], nullptr);
+				worksheet_write_number(wsApic, 4, 6, grgqwTimestampOverhead[gnTimestampPolicy] * dblNsPerCycle, nullptr);
+
+				worksheet_write_string(wsApic, 5, 0, "local APIC timer", nullptr);
+				worksheet_write_string(wsApic, 5, 1, APIC_ACCESS_X2APIC == p->nAccess ? "x2APIC MSR" : "xAPIC MMIO", nullptr);
+				worksheet_write_number(wsApic, 5, 2, p->dblHzRTC, nullptr);
+				worksheet_write_number(wsApic, 5, 3, p->dblHzACPI, nullptr);
+				if (0 != p->dblHzACPI)
+					worksheet_write_number(wsApic, 5, 4, (p->dblHzACPI - p->dblHzRTC) / p->dblHzRTC * 1e6, nullptr);
+				worksheet_write_number(wsApic, 5, 5, (double)p->qwReadCost, nullptr);
+				worksheet_write_number(wsApic, 5, 6, p->qwReadCost * dblNsPerCycle, nullptr);
+			}
+
+			//
+			// drift servo history on separate worksheet
+			//
+			if (0 != gClockServo.cntHist)
+			{
+				CLOCK_SERVO* p = &gClockServo;
+				lxw_worksheet* wsServo = workbook_add_worksheet(workbook, "SERVO");
+				lxw_chart* chartOffset = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT_WITH_MARKERS);
+				lxw_chart* chartFreq = workbook_add_chart(workbook, LXW_CHART_SCATTER_STRAIGHT_WITH_MARKERS);
+				char strtmp[128], strCategory[64], strValue[64];
+
+				worksheet_set_column(wsServo, COLS("A:A"), 60, nullptr);
+				worksheet_set_column(wsServo, COLS("B:F"), 16, nullptr);
+
+				worksheet_write_string(wsServo, CELL("A1"), "Disciplined TSC clock, PLL/FLL servo vs. RTC", bold);
+				sprintf(strtmp, "free running TSC: %.0f Hz", p->dblTSCNominal), worksheet_write_string(wsServo, CELL("A2"), strtmp, nullptr);
+				sprintf(strtmp, "frequency correction: %+.3f ppm", p->dblFreq * 1e6), worksheet_write_string(wsServo, CELL("A3"), strtmp, nullptr);
+				sprintf(strtmp, "RTC reads: %u in %.0f s", p->cntUpdates, p->dblRefTime), worksheet_write_string(wsServo, CELL("A4"), strtmp, nullptr);
+				if (p->dblLockTime < 0.0)
+					sprintf(strtmp, "convergence time: not locked");
+				else
+					sprintf(strtmp, "convergence time: %.0f s, offset < %.0f us", p->dblLockTime, SERVO_LOCK_US);
+				worksheet_write_string(wsServo, CELL("A5"), strtmp, nullptr);
+
+				worksheet_write_string(wsServo, CELL("B10"), "time [s]", bold);
+				worksheet_write_string(wsServo, CELL("C10"), "servo offset [us]", bold);
+				worksheet_write_string(wsServo, CELL("D10"), "free run offset [us]", bold);
+				worksheet_write_string(wsServo, CELL("E10"), "freq. corr. [ppm]", bold);
+				worksheet_write_string(wsServo, CELL("F10"), "poll [s]", bold);
+				for (uint32_t i = 0; i < p->cntHist; i++)
+				{
+					worksheet_write_number(wsServo, 10 + i, 1, p->rgHist[i].dblTime, nullptr);
+					worksheet_write_number(wsServo, 10 + i, 2, p->rgHist[i].dblOffset * 1e6, nullptr);
+					worksheet_write_number(wsServo, 10 + i, 3, p->rgHist[i].dblOffsetFree * 1e6, nullptr);
+					worksheet_write_number(wsServo, 10 + i, 4, p->rgHist[i].dblFreq * 1e6, nullptr);
+					worksheet_write_number(wsServo, 10 + i, 5, (double)p->rgHist[i].nPoll, nullptr);
+				}
+
+				sprintf(strCategory, "=SERVO!$B$11:$B$%d", 10 + p->cntHist);
+				sprintf(strValue, "=SERVO!$C$11:$C$%d", 10 + p->cntHist);
+				series = chart_add_series(chartOffset, strCategory, strValue);
+				chart_series_set_name(series, "servo offset [us]");
+				sprintf(strValue, "=SERVO!$D$11:$D$%d", 10 + p->cntHist);
+				series = chart_add_series(chartOffset, strCategory, strValue);
+				chart_series_set_name(series, "free run offset [us]");
+				chart_title_set_name(chartOffset, "Phase error vs. RTC over time [s]");
+				worksheet_insert_chart(wsServo, CELL("H2"), chartOffset);
+
+				sprintf(strValue, "=SERVO!$E$11:$E$%d", 10 + p->cntHist);
+				series = chart_add_series(chartFreq, strCategory, strValue);
+				chart_series_set_name(series, "freq. corr. [ppm]");
+				chart_title_set_name(chartFreq, "Frequency correction over time [s]");
+				worksheet_insert_chart(wsServo, CELL("H18"), chartFreq);
+			}
+
 			lxw_error lxwerr = workbook_close(workbook);
 		}
 	}//if (fCreateOvrd)
@@ -865,7 +1754,7 @@ int fnMnuItm_View_SysInfo(CTextWindow* pThis, void* pContext, void* pParm)
 		// 
 		pRoot->TextPrint({ 2, 2 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI OemId                       : %s", gstrACPIOemId);
 		pRoot->TextPrint({ 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI OemTableId                  : %s", gstrACPIOemTableId);
-		pRoot->TextPrint({ 2, 4 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer I/O Address           : %s", gstrACPIPmTmrBlkAddr);
+		pRoot->TextPrint({ 2, 4 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer Address               : %s", gstrACPIPmTmrBlkAddr);
 		//pRoot->TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer Size                  : %s", gACPIPmTmrBlkSize);
 		pRoot->TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI PCIEBase                    : %s", gACPIPCIEBase);
 
@@ -893,6 +1782,7 @@ int fnMnuItm_View_SysInfo(CTextWindow* pThis, void* pContext, void* pParm)
 		pRoot->TextPrint({ 2, 19 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "target .XLSX                     : %s", gCfgStr_File_SaveAs);
 		pRoot->TextPrint({ 2, 20 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Calibration Method               : %s", gCfgStr_CalibrMethod);
 		pRoot->TextPrint({ 2, 21 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Error correction                 : %s", 0 == gfErrorCorrection ? "disabled" : (pfnDelay == &InternalAcpiDelay ? "N/A on TIANOCORE" : "enabled"));
+		pRoot->TextPrint({ 2, 22 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Timestamp policy                 : %s, %lld TSC cycles overhead        ", grgstrTimestampPolicy[gnTimestampPolicy], grgqwTimestampOverhead[gnTimestampPolicy]);
 	}
 	return 0;
 }
@@ -972,20 +1862,29 @@ const wchar_t* wcsTimerDelayAcpiStrings[2][5] =
 	},
 };
 
-const wchar_t* wcsCalibMethod[2][3] =
+const wchar_t* wcsCalibMethod[2][6] =
 {
 	{
 		L"- Calibration Method:  TIANO  ACPI",
 		L"- Calibration Method: TSCSYNC PIT ",
 		L"- Calibration Method: TSCSYNC ACPI",
+		L"- Calibration Method:  TIMESTAMP  ",
+		L"- Calibration Method: TSCSYNC APIC",
+		L"- Calibration Method: TSCSYNC OUT2",
 	},
 	{
 		L"+ Calibration Method:  TIANO  ACPI",
 		L"+ Calibration Method: TSCSYNC PIT ",
 		L"+ Calibration Method: TSCSYNC ACPI",
+		L"+ Calibration Method:  TIMESTAMP  ",
+		L"+ Calibration Method: TSCSYNC APIC",
+		L"+ Calibration Method: TSCSYNC OUT2",
 	},
 };
 
+const wchar_t* wcsCalibMethodTSTAMPNA = L"  Calibration Method: TIMESTMP N/A";
+const wchar_t* wcsCalibMethodAPICNA   = L"  Calibration Method: APIC     N/A";
+
 const wchar_t* wcsErrorCorrection[3][1] =
 {
 	{
@@ -999,6 +1898,19 @@ const wchar_t* wcsErrorCorrection[3][1] =
 	},
 };
 
+const wchar_t* wcsVerifiedRead[3][1] =
+{
+	{
+		L"- Verified Reads: disabled        ",
+	},
+	{
+		L"+ Verified Reads: enabled         ",
+	},
+	{
+		L"  Verified Reads: N/A for method  ",
+	},
+};
+
 int fnMnuItm_Config_ACPIDelaySelect1(CTextWindow* pThis, void* pContext, void* pParm) { CTextWindow* pRoot = pThis->TextWindowGetRoot(); char* pParmStr = (char*)pParm; menu_t* pMenu = (menu_t*)pContext; int nRet = 0; if (0 == strcmp("ENTER", pParmStr))pThis->TextClearWindow(pRoot->WinAtt); else { gfCfgMngMnuItm_Config_ACPIDelaySelect1 ^= 1;		pMenu->rgwcsMenuItem[0/* menu item 0 */] = (wchar_t*)(wcsTimerDelayAcpiStrings[gfCfgMngMnuItm_Config_ACPIDelaySelect1][0]); nRet = 1; }return nRet; }
 int fnMnuItm_Config_ACPIDelaySelect2(CTextWindow* pThis, void* pContext, void* pParm) { CTextWindow* pRoot = pThis->TextWindowGetRoot(); char* pParmStr = (char*)pParm; menu_t* pMenu = (menu_t*)pContext; int nRet = 0; if (0 == strcmp("ENTER", pParmStr))pThis->TextClearWindow(pRoot->WinAtt); else { gfCfgMngMnuItm_Config_ACPIDelaySelect2 ^= 1;		pMenu->rgwcsMenuItem[1/* menu item 1 */] = (wchar_t*)(wcsTimerDelayAcpiStrings[gfCfgMngMnuItm_Config_ACPIDelaySelect2][1]); nRet = 1; }return nRet; }
 int fnMnuItm_Config_ACPIDelaySelect3(CTextWindow* pThis, void* pContext, void* pParm) { CTextWindow* pRoot = pThis->TextWindowGetRoot(); char* pParmStr = (char*)pParm; menu_t* pMenu = (menu_t*)pContext; int nRet = 0; if (0 == strcmp("ENTER", pParmStr))pThis->TextClearWindow(pRoot->WinAtt); else { gfCfgMngMnuItm_Config_ACPIDelaySelect3 ^= 1;		pMenu->rgwcsMenuItem[2/* menu item 2 */] = (wchar_t*)(wcsTimerDelayAcpiStrings[gfCfgMngMnuItm_Config_ACPIDelaySelect3][2]); nRet = 1; }return nRet; }
@@ -1017,13 +1929,31 @@ int fnMnuItm_Config_ErrorCorrection(CTextWindow* pThis, void* pContext, void* pP
 	else {
 		gfErrorCorrection ^= true;
 
-		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
 		nRet = 1;
 	}
 	return nRet;
 }
 
-int fnMnuItm_Config_CalibMethodSelectTIANOACPI(CTextWindow* pThis, void* pContext, void* pParm)
+int fnMnuItm_Config_VerifiedRead(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+	char* pParmStr = (char*)pParm;
+	menu_t* pMenu = (menu_t*)pContext;
+	int nRet = 0;
+
+	if (0 == strcmp("ENTER", pParmStr))
+		pThis->TextClearWindow(pRoot->WinAtt);
+	else {
+		gfVerifiedRead ^= true;
+
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[pfnDelay == &InternalAcpiDelay ? 2/*"  Verified Reads: N/A for method  "*/ : gfVerifiedRead][0]);
+		nRet = 1;
+	}
+	return nRet;
+}
+
+int fnMnuItm_Config_CalibMethodSelectTIANOACPI(CTextWindow* pThis, void* pContext, void* pParm)
 { 
 	CTextWindow* pRoot = pThis->TextWindowGetRoot(); 
 	char* pParmStr = (char*)pParm; menu_t* pMenu = (menu_t*)pContext; 
@@ -1038,6 +1968,9 @@ int fnMnuItm_Config_CalibMethodSelectTIANOACPI(CTextWindow* pThis, void* pContex
 		gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = true,
 			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false,
 			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false,
 
 		strcpy(gCfgStr_CalibrMethod, "original TIANOCORE");
 		pfnDelay = &InternalAcpiDelay;
@@ -1045,10 +1978,16 @@ int fnMnuItm_Config_CalibMethodSelectTIANOACPI(CTextWindow* pThis, void* pContex
 		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]); 
 		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
 		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
+
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
 
-		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
+		pMenu->rgfnMnuItm[15] = nullptr;
 
-		pMenu->rgfnMnuItm[12] = nullptr;
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[2][0]);
+		pMenu->rgfnMnuItm[16] = nullptr;
 
 		nRet = 1;
 		nRet = 1;
@@ -1069,7 +2008,10 @@ int fnMnuItm_Config_CalibMethodSelectTSCSYNCPIT(CTextWindow* pThis, void* pConte
 
 		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = true,
 			gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false,
-			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 		
 		strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT");
 		pfnDelay = &PITClkWait;
@@ -1077,10 +2019,16 @@ int fnMnuItm_Config_CalibMethodSelectTSCSYNCPIT(CTextWindow* pThis, void* pConte
 		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]);
 		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
 		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
 
-		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
 		
-		pMenu->rgfnMnuItm[12] = &fnMnuItm_Config_ErrorCorrection;
+		pMenu->rgfnMnuItm[15] = &fnMnuItm_Config_ErrorCorrection;
+
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[gfVerifiedRead][0]);
+		pMenu->rgfnMnuItm[16] = &fnMnuItm_Config_VerifiedRead;
 
 		nRet = 1;
 	}
@@ -1100,7 +2048,10 @@ int fnMnuItm_Config_CalibMethodSelectTSCSYNCACPI(CTextWindow* pThis, void* pCont
 
 		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = true,
 			gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false,
-			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 
 		strcpy(gCfgStr_CalibrMethod, "native TSCSync ACPI");
 		pfnDelay = &AcpiClkWait;
@@ -1108,10 +2059,136 @@ int fnMnuItm_Config_CalibMethodSelectTSCSYNCACPI(CTextWindow* pThis, void* pCont
 		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]);
 		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
 		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
+
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
+
+		pMenu->rgfnMnuItm[15] = &fnMnuItm_Config_ErrorCorrection;
+
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[gfVerifiedRead][0]);
+		pMenu->rgfnMnuItm[16] = &fnMnuItm_Config_VerifiedRead;
+
+		nRet = 1;
+
+	}
+	return nRet;
+}
+
+int fnMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+	char* pParmStr = (char*)pParm;
+	menu_t* pMenu = (menu_t*)pContext;
+	int nRet = 0;
+
+	if (0 == strcmp("ENTER", pParmStr))
+		pThis->TextClearWindow(pRoot->WinAtt);
+	else {
+
+		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = true,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
+
+		strcpy(gCfgStr_CalibrMethod, "native TSCSync EFI_TIMESTAMP_PROTOCOL");
+		pfnDelay = &TimestampClkWait;
+
+		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]);
+		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
+		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
+
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[gfErrorCorrection][0]);
+		pMenu->rgfnMnuItm[15] = &fnMnuItm_Config_ErrorCorrection;
+
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[2][0]);
+		pMenu->rgfnMnuItm[16] = nullptr;
+
+		nRet = 1;
+
+	}
+	return nRet;
+}
+
+int fnMnuItm_Config_CalibMethodSelectTSCSYNCAPIC(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+	char* pParmStr = (char*)pParm;
+	menu_t* pMenu = (menu_t*)pContext;
+	int nRet = 0;
+
+	if (0 == strcmp("ENTER", pParmStr))
+		pThis->TextClearWindow(pRoot->WinAtt);
+	else {
+
+		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = true,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
+
+		strcpy(gCfgStr_CalibrMethod, "native TSCSync local APIC timer");
+		pfnDelay = &ApicClkWait;
+
+		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]);
+		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
+		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
+
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[gfErrorCorrection][0]);
+		pMenu->rgfnMnuItm[15] = &fnMnuItm_Config_ErrorCorrection;
+
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[gfVerifiedRead][0]);
+		pMenu->rgfnMnuItm[16] = &fnMnuItm_Config_VerifiedRead;
+
+		nRet = 1;
+
+	}
+	return nRet;
+}
+
+int fnMnuItm_Config_CalibMethodSelectTSCSYNCOUT2(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+	char* pParmStr = (char*)pParm;
+	menu_t* pMenu = (menu_t*)pContext;
+	int nRet = 0;
+
+	if (0 == strcmp("ENTER", pParmStr))
+		pThis->TextClearWindow(pRoot->WinAtt);
+	else {
+
+		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = true,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+			gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+
+		strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT OUT2 edges");
+		pfnDelay = &PITOut2ClkWait;
+
+		pMenu->rgwcsMenuItem[8 /* menu item 8 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0]);
+		pMenu->rgwcsMenuItem[9 /* menu item 9 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1]);
+		pMenu->rgwcsMenuItem[10/* menu item10 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2]);
+		pMenu->rgwcsMenuItem[11/* menu item11 */] = (wchar_t*)(nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3]);
+		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4]);
+		pMenu->rgwcsMenuItem[13/* menu item13 */] = (wchar_t*)(wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5]);
 
-		pMenu->rgwcsMenuItem[12/* menu item12 */] = (wchar_t*)(wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2/*"  Error Correction: N/A for TIANO "*/ : gfErrorCorrection][0]);
+		pMenu->rgwcsMenuItem[15/* menu item15 */] = (wchar_t*)(wcsErrorCorrection[gfErrorCorrection][0]);
+		pMenu->rgfnMnuItm[15] = &fnMnuItm_Config_ErrorCorrection;
 
-		pMenu->rgfnMnuItm[12] = &fnMnuItm_Config_ErrorCorrection;
+		pMenu->rgwcsMenuItem[16/* menu item16 */] = (wchar_t*)(wcsVerifiedRead[2][0]);
+		pMenu->rgfnMnuItm[16] = nullptr;
 
 		nRet = 1;
 
@@ -1132,7 +2209,7 @@ int fnMnuItm_NumSamples(CTextWindow* pThis, void* pContext, void* pParm)
 	CTextWindow* pRoot = pThis->TextWindowGetRoot();
 	CTextWindow* pSubMnuTextWindow = new CTextWindow(
 		pThis,
-		{ pThis->WinPos.X + pThis->WinDim.X,pThis->WinPos.Y + pThis->WinDim.Y - 8 },
+		{ pThis->WinPos.X + pThis->WinDim.X,pThis->WinPos.Y + pThis->WinDim.Y - 14 },
 		{ 10,6 },
 		EFI_BACKGROUND_CYAN | EFI_YELLOW);
 	menu_t* pMenu = (menu_t*)pContext;
@@ -1211,6 +2288,93 @@ int fnMnuItm_NumSamples(CTextWindow* pThis, void* pContext, void* pParm)
 	return nRet;
 }
 
+const wchar_t* wcsTimestampPolicy[2][TSPOL_NUM] =
+{
+	{L"- RDTSC              ",L"- LFENCE+RDTSC       ",L"- RDTSCP             ",L"- MFENCE+LFENCE+RDTSC"},/* non-selected strings */
+	{L"+ RDTSC              ",L"+ LFENCE+RDTSC       ",L"+ RDTSCP             ",L"+ MFENCE+LFENCE+RDTSC"},/*     selected strings */
+};
+
+int fnMnuItm_TimestampPolicy(CTextWindow* pThis, void* pContext, void* pParm)
+{ 
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+	CTextWindow* pSubMnuTextWindow = new CTextWindow(
+		pThis,
+		{ pThis->WinPos.X + pThis->WinDim.X,pThis->WinPos.Y + pThis->WinDim.Y - 2 },
+		{ 25,6 },
+		EFI_BACKGROUND_CYAN | EFI_YELLOW);
+	menu_t* pMenu = (menu_t*)pContext;
+	int nRet = 0;
+	int idxMnuItm = 0, idxMnuItmChecked = gnTimestampPolicy/*checked with space bar*/;
+	int idxMnuItmNUM = TSPOL_NUM;		/* number of lines within the pulldown menu */;
+	TEXT_KEY key = NO_KEY;
+
+
+	pSubMnuTextWindow->TextBorder({ 0, 0 }, pSubMnuTextWindow->WinDim,
+		BOXDRAW_DOWN_RIGHT,
+		BOXDRAW_DOWN_LEFT,
+		BOXDRAW_UP_RIGHT,
+		BOXDRAW_UP_LEFT,
+		BOXDRAW_HORIZONTAL,
+		BOXDRAW_VERTICAL,
+		nullptr);
+
+	//
+	// fill menu with menuitem strings at once
+	//
+	pSubMnuTextWindow->TextBlockDraw({ 2,1 }, EFI_BACKGROUND_CYAN | EFI_YELLOW, L"%s\n%s\n%s\n%s",
+		wcsTimestampPolicy[TSPOL_RDTSC == gnTimestampPolicy/* selected/non-selected */][TSPOL_RDTSC],
+		wcsTimestampPolicy[TSPOL_LFENCE_RDTSC == gnTimestampPolicy/* selected/non-selected */][TSPOL_LFENCE_RDTSC],
+		wcsTimestampPolicy[TSPOL_RDTSCP == gnTimestampPolicy/* selected/non-selected */][TSPOL_RDTSCP],
+		wcsTimestampPolicy[TSPOL_MFENCE_LFENCE_RDTSC == gnTimestampPolicy/* selected/non-selected */][TSPOL_MFENCE_LFENCE_RDTSC]
+		);
+	// highlight the first string initially
+	pSubMnuTextWindow->TextPrint({ 2,1 }, EFI_BACKGROUND_MAGENTA | EFI_YELLOW, wcsTimestampPolicy[0 == gnTimestampPolicy/* selected/non-selected */][idxMnuItm]);
+
+	//
+	// "Message"-Loop, receive keyboard messages...
+	//
+	for (	key = NO_KEY;
+			KEY_ESC != key && KEY_ENTER != key; 
+			key = pThis->TextGetKey(), 
+				pThis->TextWindowUpdateProgress()
+		)
+	{
+		if (KEY_DOWN == key) {
+
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItm + 1 }, EFI_BACKGROUND_CYAN | EFI_YELLOW, wcsTimestampPolicy[idxMnuItm == gnTimestampPolicy/* selected/non-selected */][idxMnuItm]);	// de-highlight previous menu item
+			idxMnuItm = (++idxMnuItm == idxMnuItmNUM ? 0 : idxMnuItm);
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItm + 1 }, EFI_BACKGROUND_MAGENTA | EFI_YELLOW, wcsTimestampPolicy[idxMnuItm == gnTimestampPolicy/* selected/non-selected */][idxMnuItm]);	// highlight current menu item
+		}
+		else if (KEY_UP == key) {
+
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItm + 1 }, EFI_BACKGROUND_CYAN | EFI_YELLOW, wcsTimestampPolicy[idxMnuItm == gnTimestampPolicy/* selected/non-selected */][idxMnuItm]);	// de-highlight previous menu item
+			idxMnuItm = (--idxMnuItm < 0 ? idxMnuItmNUM - 1 : idxMnuItm);
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItm + 1 }, EFI_BACKGROUND_MAGENTA | EFI_YELLOW, wcsTimestampPolicy[idxMnuItm == gnTimestampPolicy/* selected/non-selected */][idxMnuItm]);	// highlight current menu item
+		}
+
+		if (KEY_SPACE == key) {
+
+			gnTimestampPolicy = idxMnuItm;
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItmChecked + 1 }, EFI_BACKGROUND_CYAN | EFI_YELLOW, wcsTimestampPolicy[0][idxMnuItmChecked]);	// de-highlight previous menu item
+			pSubMnuTextWindow->TextPrint({ 2,idxMnuItm + 1 }, EFI_BACKGROUND_MAGENTA | EFI_YELLOW, wcsTimestampPolicy[1][idxMnuItm]);			// highlight current menu item
+			idxMnuItmChecked = idxMnuItm;
+		}
+	}
+
+	pSubMnuTextWindow->BgAtt = EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK;
+	if (KEY_ENTER == key)
+	{
+		delete pSubMnuTextWindow->pParent;									// destroy the CONFIG menu window
+		delete pSubMnuTextWindow;											// destroy the SUBMENU window
+		nRet = 0;															// do not refresh menu window, it is destroyed
+	}
+	else {
+		delete pSubMnuTextWindow;											// destroy the SUBMENU window
+		nRet = 1;															// refresh menu window
+	}
+	return nRet;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 // About - BOX
@@ -1261,6 +2425,7 @@ int fnMnuItm_About_0(CTextWindow* pThis, void* pContext, void* pParm)
 		pAboutBox->TextPrint({ 1,16 }, "  /NUM:0/1/2/3      - number of samples 0: 10, 1: 50, 2: 250, 3: 1250");
 		pAboutBox->TextPrint({ 1,17 }, "  /ERRCODIS         - disable error correction of additionally gone through");
 		pAboutBox->TextPrint({ 1,18 }, "                       counter ticks. N/A for TIANOCORE measurement method");
+		pAboutBox->TextPrint({ 1,19 }, "  /HWLAT:<ms>,<us>  - run hardware latency (SMI/stall) detector");
 
     }
 	//RealTimeClock Analyser
@@ -1299,6 +2464,119 @@ void resetconsole(void)
 	gSystemTable->ConOut->SetAttribute(gSystemTable->ConOut, EFI_BACKGROUND_BLACK + EFI_WHITE);
 }
 
+//
+// clear main window since refresh for text block is not yet fully supported (for multiple text blocks, only for one...)
+//
+void MainWindowClear(CTextWindow* pRoot)
+{
+	wchar_t wcstmp[16];
+	swprintf(wcstmp, INT_MAX, L"%%.%ds", pRoot->WinDim.X - 2);
+
+	for (int i = 2; i < pRoot->WinDim.Y - 2; i++)
+		pRoot->TextPrint({ 1, i + pRoot->WinPos.Y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, wcstmp, pRoot->pwcsWinClrLine);
+}
+
+//
+// red "ATTENTION: ..." status line while a measurement is running
+//
+void StatusLineAttention(CTextWindow* pRoot, const char* strFmt, ...)
+{
+	char* pLineKill = new char[pRoot->ScrDim.X];
+	char strtmp[256];
+	va_list ap;
+
+	memset(pLineKill, '\x20', pRoot->ScrDim.X),
+		pLineKill[pRoot->ScrDim.X - 1] = '\0';
+
+	va_start(ap, strFmt);
+	vsnprintf(strtmp, sizeof(strtmp), strFmt, ap);
+	va_end(ap);
+
+	pRoot->TextPrint({ 0, pRoot->ScrDim.Y - 1 }, EFI_BACKGROUND_RED | EFI_WHITE, pLineKill);
+	pRoot->TextPrint({ 1, pRoot->ScrDim.Y - 1 }, EFI_BACKGROUND_RED | EFI_WHITE, "%s", strtmp);
+
+	delete[] pLineKill;
+}
+
+//
+// blue status/help line when the measurement is finished
+//
+void StatusLineHelp(CTextWindow* pRoot)
+{
+	wchar_t wcsARROW_LEFT[2] = { ARROW_LEFT ,'\0' },
+		wcsARROW_UP[2] = { ARROW_UP ,'\0' },
+		wcsARROW_RIGHT[2] = { ARROW_RIGHT ,'\0' },
+		wcsARROW_DOWN[2] = { ARROW_DOWN ,'\0' };
+	char* pLineKill = new char[pRoot->ScrDim.X];
+
+	memset(pLineKill, '\x20', pRoot->ScrDim.X),
+		pLineKill[pRoot->ScrDim.X - 1] = '\0';
+
+	pRoot->TextPrint({ 0, pRoot->ScrDim.Y - 1 }, EFI_BACKGROUND_BLUE | EFI_WHITE, pLineKill);
+	pRoot->TextPrint({ 1, pRoot->ScrDim.Y - 1 }, EFI_BACKGROUND_BLUE | EFI_WHITE, L"F10:Menu \x25C4\x2518:Select SPACE:Check ESC:Return %s%s%s%s:Navigate", wcsARROW_LEFT, wcsARROW_RIGHT, wcsARROW_UP, wcsARROW_DOWN);
+
+	delete[] pLineKill;
+}
+
+//
+// rate limited telemetry of the measurement kernels: samples are posted after each kernel call,
+// the display is drained max. CLKWAIT_TELEMETRY_HZ times per second, outside the timed section
+//
+#define CLKWAIT_TELEMETRY_HZ 4
+static struct {
+	uint64_t qwTSCNextDrain;	// TSC of next display update
+	uint32_t cntPosted;			// samples posted since reset
+	CLKWAIT_DIAG Last;			// most recent sample
+	int64_t qwOvershootMin;
+	int64_t qwOvershootMax;
+	uint32_t cntGlitch;			// glitches since reset
+}gClkWaitTelemetry;
+
+void ClkWaitTelemetryReset(void)
+{
+	memset(&gClkWaitTelemetry, 0, sizeof(gClkWaitTelemetry));
+	gClkWaitTelemetry.qwOvershootMin = INT64_MAX;
+	gClkWaitTelemetry.qwOvershootMax = INT64_MIN;
+}
+
+void ClkWaitTelemetryPost(CLKWAIT_DIAG* pDiag)
+{
+	gClkWaitTelemetry.cntPosted++;
+	gClkWaitTelemetry.Last = *pDiag;
+	gClkWaitTelemetry.cntGlitch += pDiag->cntGlitch;
+	gcntClkWaitGlitch += pDiag->cntGlitch;
+	gcntClkWaitSamples++;
+	gcntClkWaitWrapLost += pDiag->cntWrapLost;
+	gqwClkWaitWindowMax = pDiag->qwTSCWindowMax > gqwClkWaitWindowMax ? pDiag->qwTSCWindowMax : gqwClkWaitWindowMax;
+	if (pDiag->qwOvershoot < gClkWaitTelemetry.qwOvershootMin)
+		gClkWaitTelemetry.qwOvershootMin = pDiag->qwOvershoot;
+	if (pDiag->qwOvershoot > gClkWaitTelemetry.qwOvershootMax)
+		gClkWaitTelemetry.qwOvershootMax = pDiag->qwOvershoot;
+}
+
+void ClkWaitTelemetryDrain(CTextWindow* pRoot, int32_t Y)
+{
+	uint64_t qwTSC = __rdtsc();
+
+	if (0 == gClkWaitTelemetry.cntPosted || qwTSC < gClkWaitTelemetry.qwTSCNextDrain)
+		return;
+
+	gClkWaitTelemetry.qwTSCNextDrain = qwTSC + gTSCPerSecRTC / CLKWAIT_TELEMETRY_HZ;
+
+	pRoot->TextPrint({ 2, Y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Additional ticks gone through: %lld (min %lld, max %lld), %u reads, max. step %u        ",
+		gClkWaitTelemetry.Last.qwOvershoot,
+		gClkWaitTelemetry.qwOvershootMin,
+		gClkWaitTelemetry.qwOvershootMax,
+		gClkWaitTelemetry.Last.cntReads,
+		gClkWaitTelemetry.Last.dwMaxStep);
+	if (0 != gClkWaitTelemetry.Last.qwTSCRaw)
+		pRoot->TextPrint({ 2, Y + 1 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Kernel loop rate             : %.3f M reads/s, %.1f TSC per read, %u glitches %s        ",
+			(double)gClkWaitTelemetry.Last.cntReads * (double)gTSCPerSecRTC / (double)gClkWaitTelemetry.Last.qwTSCRaw / 1e6,
+			(double)gClkWaitTelemetry.Last.qwTSCRaw / (double)gClkWaitTelemetry.Last.cntReads,
+			gClkWaitTelemetry.cntGlitch,
+			gfVerifiedRead ? "rejected" : "detected");
+}
+
 int fnMnuItm_RunConfig_0(CTextWindow* pThis, void* pContext, void* pParm)
 {
 	CTextWindow* pRoot = pThis->TextWindowGetRoot();
@@ -1333,6 +2611,107 @@ int fnMnuItm_RunDriftTest_0(CTextWindow* pThis, void* pContext, void* pParm)
 	return 0;
 }
 
+int fnMnuItm_RunDriftServo_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	ServoInit(&gClockServo, (double)gTSCPerSecRTC);		// free running clock is the one of the DRIFT TEST
+	gfRunDriftServo = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunHwLat_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunHwLat = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunAdev_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunAdev = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunSpectrum_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunSpectrum = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunBench_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunBench = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunKalman_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunKalman = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunXRef_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunXRef = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunTimerLib_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunTimerLib = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunTscTime_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunTscTime = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
+int fnMnuItm_RunMpCont_0(CTextWindow* pThis, void* pContext, void* pParm)
+{
+	CTextWindow* pRoot = pThis->TextWindowGetRoot();
+
+	gfRunMpCont = true;
+
+	pThis->TextClearWindow(pRoot->WinAtt);
+	return 0;
+}
+
 int main(int argc, char** argv)
 {
 	int nRet = 1;
@@ -1351,7 +2730,7 @@ int main(int argc, char** argv)
 
 		for (int j = 123456; j <= 123456; j++)
 			for (int64_t i = 0, n; i < 10; i++)
-				n = (*pfnDelay)(j),
+				n = (*pfnDelay)(j, nullptr),
 				printf("%s-> %lld, %d\n",n != j ? "ERROR " : "OKAY  " ,n,j);
 
 
@@ -1368,11 +2747,46 @@ int main(int argc, char** argv)
 	sprintf(gstrACPIOemId, "%.6s", (char*)&pFACP->Header.OemId);
 	sprintf(gstrACPIOemTableId, "%.8s", (char*)&pFACP->Header.OemTableId);
 
-	sprintf(gstrACPIPmTmrBlkAddr, "%04X", pFACP->PmTmrBlk);
-	sprintf(gACPIPmTmrBlkSize, "%sBit", (0 != (pFACP->Flags & (1 << 8))) ? "32" : "24");
+	sprintf(gACPIPmTmrBlkSize, "%sBit", (0 != (pFACP->Flags & EFI_ACPI_6_2_TMR_VAL_EXT)) ? "32" : "24");
 
 	gPmTmrBlkAddr = static_cast<uint16_t> (pFACP->PmTmrBlk);				// save ACPI timer base adress
+	gCOUNTER_WIDTH = (0 != (pFACP->Flags & EFI_ACPI_6_2_TMR_VAL_EXT)) ? 32 : 24;
+
+	//
+	// X_PM_TMR_BLK Generic Address Structure supersedes PM_TMR_BLK, if present
+	//
+	if (pFACP->Header.Length >= offsetof(EFI_ACPI_6_2_FIXED_ACPI_DESCRIPTION_TABLE, XPmTmrBlk) + sizeof(EFI_ACPI_6_2_GENERIC_ADDRESS_STRUCTURE)
+		&& 0 != pFACP->XPmTmrBlk.Address)
+	{
+		if (EFI_ACPI_6_2_SYSTEM_IO == pFACP->XPmTmrBlk.AddressSpaceId)
+			gPmTmrBlkAddr = static_cast<uint16_t> (pFACP->XPmTmrBlk.Address);
+
+		if (EFI_ACPI_6_2_SYSTEM_MEMORY == pFACP->XPmTmrBlk.AddressSpaceId)
+			gpPmTmrMmio = (volatile uint32_t*)(uintptr_t)pFACP->XPmTmrBlk.Address;
+	}
 	gPm1aCntBlkAddr = (uint16_t)pFACP->Pm1aCntBlk;
+	gPm1aEvtBlkAddr = (uint16_t)pFACP->Pm1aEvtBlk;													// PM1_STS, TMR_STS
+
+	if (pFACP->Header.Length >= offsetof(EFI_ACPI_6_2_FIXED_ACPI_DESCRIPTION_TABLE, XPm1aEvtBlk) + sizeof(EFI_ACPI_6_2_GENERIC_ADDRESS_STRUCTURE)
+		&& 0 != pFACP->XPm1aEvtBlk.Address && EFI_ACPI_6_2_SYSTEM_IO == pFACP->XPm1aEvtBlk.AddressSpaceId)
+		gPm1aEvtBlkAddr = static_cast<uint16_t> (pFACP->XPm1aEvtBlk.Address);
+
+	gPm1aEnAddr = gPm1aEvtBlkAddr + pFACP->Pm1EvtLen / 2;
+
+	//
+	// get HPET register block for the TimerLib benchmark
+	//
+	if (1)
+	{
+		static uint8_t HPET[1024];
+		EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER* pHPET = (EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER*)&HPET[0];
+		uint32_t len = GetSystemFirmwareTable('ACPI', 'TEPH', &HPET[0], sizeof(HPET));
+
+		if (len >= sizeof(EFI_ACPI_HIGH_PRECISION_EVENT_TIMER_TABLE_HEADER)
+			&& EFI_ACPI_6_2_SYSTEM_MEMORY == pHPET->BaseAddressLower32Bit.AddressSpaceId
+			&& 0 != pHPET->BaseAddressLower32Bit.Address)
+			gpHpetMmio = (volatile uint8_t*)(uintptr_t)pHPET->BaseAddressLower32Bit.Address;
+	}
 
 	//
 	// get DSDT to find S5 SLP_TYP
@@ -1429,6 +2843,24 @@ int main(int argc, char** argv)
 				sprintf(gstrTIMESTAMP_PROTOCOL, "%lldHz", efi_timestamp_properties.Frequency),
 				gTIMESTAMP_PROTOCOLPerSec = (int64_t)efi_timestamp_properties.Frequency;
 
+			//
+			// GetTimestamp() as live reference, latency and real frequency against RTC
+			//
+			if (EFI_SUCCESS == Status && 0 != efi_timestamp_properties.Frequency)
+			{
+				gpfnGetTimestamp = pEFI_TIMESTAMP_PROTOCOL->GetTimestamp;
+				gqwTimestampEnd = efi_timestamp_properties.EndValue;
+
+				printf("Measuring EFI_TIMESTAMP_PROTOCOL frequency against RTC, %d seconds...\n", synctime);
+				gqwTimestampFreq = TimestampFreqRtc(synctime);
+				gqwTimestampLatency = TimestampLatency();
+
+				if (0 == gqwTimestampFreq)										// GetTimestamp() doesn't count
+					gpfnGetTimestamp = nullptr;
+				else
+					sprintf(&gstrTIMESTAMP_PROTOCOL[strlen(gstrTIMESTAMP_PROTOCOL)], ", real %lldHz, GetTimestamp() %lld TSC", gqwTimestampFreq, gqwTimestampLatency);
+			}
+
 		}
 
 
@@ -1497,7 +2929,14 @@ int main(int argc, char** argv)
 				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI  = %hhu\n\
 				gidxCfgMngMnuItm_Config_NumSamples = %d\n\
 				gCfgStr_File_SaveAs = %s\n\
-				gfErrorCorrection = %hhu\n",
+				gfErrorCorrection = %hhu\n\
+				gnTimestampPolicy = %d\n\
+				gfVerifiedRead = %d\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = %hhu\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = %hhu\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = %hhu\n\
+				gfAcpiTmrSts = %d\n\
+				gfChunkedWait = %d\n",
 
 				(char*)&gfCfgMngMnuItm_View_Clock,
 				(char*)&gfCfgMngMnuItm_View_Calendar,
@@ -1519,12 +2958,24 @@ int main(int argc, char** argv)
 
 				(int*)&gidxCfgMngMnuItm_Config_NumSamples,
 				&gCfgStr_File_SaveAs[0],
-				&gfErrorCorrection
+				&gfErrorCorrection,
+				&gnTimestampPolicy,
+				&gfVerifiedRead,
+				(char*)&gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP,
+				(char*)&gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC,
+				(char*)&gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2,
+				&gfAcpiTmrSts,
+				&gfChunkedWait
 			);
 
+			if (gnTimestampPolicy < 0 || gnTimestampPolicy >= TSPOL_NUM)
+				gnTimestampPolicy = TSPOL_RDTSC;
+
 		}
 	}
 
+	bool fMethodApic = false;							// /METHOD:APIC, checked after ApicTimerInit()
+
 	//
 	// process command line
 	// 
@@ -1547,10 +2998,51 @@ int main(int argc, char** argv)
 //			printf("   /SYNCREF:<parm>   - choose RTC/ACPI/i8254 timer reference, (default ACPI)\n");
             printf("   /OUT:<fname.xlsx> - assign filname of EXCEL logfile in .XLSX fileformat\n");
             printf("   /METHOD:<type>    - calibration method TIANO (InternalAcpiDelay()),\n");
-            printf("                       ACPI (TSCSYNC-ACPI) or i8254 (TSCSYNC-PIT-i8254)\n");
+            printf("                       ACPI (TSCSYNC-ACPI), i8254 (TSCSYNC-PIT-i8254) or\n");
+            printf("                       TIMESTAMP (TSCSYNC-EFI_TIMESTAMP_PROTOCOL) or\n");
+            printf("                       APIC (TSCSYNC-local APIC timer) or\n");
+            printf("                       i8254OUT2 (TSCSYNC-PIT-i8254 OUT2 edge counting)\n");
             printf("   /NUM:0/1/2/3      - number of samples 0: 10, 1: 50, 2: 250, 3: 1250\n");
             printf("   /ERRCODIS         - disable error correction of additionally gone through\n");
             printf("                       counter ticks. N/A for TIANOCORE measurement method\n");
+            printf("   /HWLAT[:<ms>[,<us>]] - run hardware latency (SMI/stall) detector for <ms>,\n");
+            printf("                       record gaps above <us>, default %dms, %dus\n", HWLAT_DFLT_WINDOW, HWLAT_DFLT_THRSHLD);
+            printf("   /ADEV[:<s>]       - record TSC vs. ACPI phase for <s> seconds, default %d,\n", STAB_DFLT_SECONDS);
+            printf("                       run Allan deviation and MTIE/TIE analysis\n");
+            printf("   /SPECTRUM[:<s>]   - record TSC vs. ACPI phase at %.0fkHz for <s> seconds, default %d,\n", PHASE_ACPI_FREQ / SPEC_TICKS_PER_SAMPLE / 1000, SPEC_DFLT_SECONDS);
+            printf("                       detect spread spectrum clocking and periodic SMIs by FFT\n");
+            printf("   /KALMAN[:<s>]     - fuse ACPI, PIT and RTC observations for <s> seconds, default %d,\n", KF_DFLT_SECONDS);
+            printf("                       Kalman filter estimate of TSC frequency and drift\n");
+            printf("   /XREF[:<s>]       - read ACPI timer and PIT interleaved for <s> seconds, default %d,\n", XREF_DFLT_SECONDS);
+            printf("                       ACPI:PIT frequency ratio, ratio drift and jitter\n");
+            printf("   /TIMERLIB         - benchmark TianoCore TimerLib MicroSecondDelay()/NanoSecondDelay()\n");
+            printf("                       implementations side-by-side against the calibrated TSC,\n");
+            printf("                       print table, no user interface\n");
+            printf("   /TSCDELAY         - benchmark calibrated TSC deadline delay vs. InternalAcpiDelay()\n");
+            printf("                       latency, overshoot and precision from 1us to 100ms,\n");
+            printf("                       print table, no user interface\n");
+            printf("   /MPCONTENTION     - read ACPI timer and PIT on 1..N APs concurrently, aggregate\n");
+            printf("                       reads per second, read latency and calibration error\n");
+            printf("   /APLOAD:<t>[,<n>] - synthetic load on <n> APs during RUN CONFIG, default all,\n");
+            printf("                       <t>: MEM, INT, AVX, IO joined by '+' or ALL\n");
+            printf("   /MULTSHIFT[:<s>]  - write %s, divide free TSC/ns mult/shift constants\n", TSCTIME_MS_FILENAME);
+            printf("                       for a conversion range of <s> seconds, default %d\n", TSCTIME_MS_DFLT_SECONDS);
+            printf("   /CAMPAIGN:<n>[,<s>] - cold boot campaign, append calibration to %s, then\n", CAMPAIGN_FILENAME);
+            printf("                       wake by RTC alarm from S5 after <s> seconds, default %d,\n", CAMPAIGN_DFLT_WAKE);
+            printf("                       until <n> records. Start TSCSync by startup.nsh\n");
+            printf("   /PUBLISH          - install TSCSYNC_PROTOCOL with the calibrated TSC frequency,\n");
+            printf("                       subsequent applications can skip calibration\n");
+            printf("   /VERIFY           - verified, glitch resistant ACPI/PIT counter reads\n");
+            printf("   /PMTMR:<type>     - ACPI PM timer access IO or MMIO (FADT X_PM_TMR_BLK),\n");
+            printf("                       default: the faster one\n");
+            printf("   /TMRSTS           - wait long ACPI intervals coarse on the PM1_STS TMR_STS\n");
+            printf("                       overflow edge, fine counter polling at start and end only\n");
+            printf("   /CHUNKED          - interrupt friendly calibration, interrupts disabled for\n");
+            printf("                       %dus segments only, not for i8254OUT2\n", CLKWAIT_CHUNK_US);
+            printf("   /TSPOLICY:<type>  - timestamp policy RDTSC, LFENCE (LFENCE+RDTSC), RDTSCP or\n");
+            printf("                       MFENCE (MFENCE+LFENCE+RDTSC), default RDTSC\n");
+            printf("   /BENCH            - benchmark timer read primitives, print table and CSV,\n");
+            printf("                       no user interface\n");
 			exit(0);
 		}
 
@@ -1559,6 +3051,231 @@ int main(int argc, char** argv)
             gfErrorCorrection = false;
         }
 
+        if (0 == _strnicmp(argv[arg], "/HWLAT", strlen("/HWLAT")))
+        {
+            uint32_t window = gnCfgHwLatWindowMs, threshold = gnCfgHwLatThresholdUs;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/HWLAT")])
+                t = sscanf(&argv[arg][strlen("/HWLAT:")], "%u,%u", &window, &threshold);
+            else if ('\0' != argv[arg][strlen("/HWLAT")])
+                t = -1;
+
+            if (t < 1 || 0 == window || 0 == threshold)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/HWLAT:<window ms>,<threshold us>\"", argv[arg]);
+                exit(1);
+            }
+
+            gnCfgHwLatWindowMs = window;
+            gnCfgHwLatThresholdUs = threshold;
+            gfRunHwLat = true;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/ADEV", strlen("/ADEV")))
+        {
+            uint32_t seconds = gnCfgAdevSeconds;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/ADEV")])
+                t = sscanf(&argv[arg][strlen("/ADEV:")], "%u", &seconds);
+            else if ('\0' != argv[arg][strlen("/ADEV")])
+                t = -1;
+
+            if (t != 1 || 0 == seconds)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/ADEV:<seconds>\"", argv[arg]);
+                exit(1);
+            }
+
+            gnCfgAdevSeconds = seconds;
+            gfRunAdev = true;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/SPECTRUM", strlen("/SPECTRUM")))
+        {
+            uint32_t seconds = gnCfgSpectrumSeconds;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/SPECTRUM")])
+                t = sscanf(&argv[arg][strlen("/SPECTRUM:")], "%u", &seconds);
+            else if ('\0' != argv[arg][strlen("/SPECTRUM")])
+                t = -1;
+
+            if (t != 1 || 0 == seconds)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/SPECTRUM:<seconds>\"", argv[arg]);
+                exit(1);
+            }
+
+            gnCfgSpectrumSeconds = seconds;
+            gfRunSpectrum = true;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/KALMAN", strlen("/KALMAN")))
+        {
+            uint32_t seconds = gnCfgKalmanSeconds;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/KALMAN")])
+                t = sscanf(&argv[arg][strlen("/KALMAN:")], "%u", &seconds);
+            else if ('\0' != argv[arg][strlen("/KALMAN")])
+                t = -1;
+
+            if (t != 1 || 0 == seconds)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/KALMAN:<seconds>\"", argv[arg]);
+                exit(1);
+            }
+
+            gnCfgKalmanSeconds = seconds;
+            gfRunKalman = true;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/XREF", strlen("/XREF")))
+        {
+            uint32_t seconds = gnCfgXRefSeconds;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/XREF")])
+                t = sscanf(&argv[arg][strlen("/XREF:")], "%u", &seconds);
+            else if ('\0' != argv[arg][strlen("/XREF")])
+                t = -1;
+
+            if (t != 1 || 0 == seconds || seconds > (uint32_t)(XREF_MAXSAMPLES * XREF_SAMPLE_TICKS / XREF_ACPI_FREQ))
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/XREF:<seconds>\", max. %d seconds", argv[arg], (int)(XREF_MAXSAMPLES * XREF_SAMPLE_TICKS / XREF_ACPI_FREQ));
+                exit(1);
+            }
+
+            gnCfgXRefSeconds = seconds;
+            gfRunXRef = true;
+        }
+
+        if (0 == _stricmp(argv[arg], "/TIMERLIB"))
+            gfTimerLibExit = true;
+
+        if (0 == _stricmp(argv[arg], "/TSCDELAY"))
+            gfTscTimeExit = true;
+
+        if (0 == _stricmp(argv[arg], "/MPCONTENTION"))
+            gfRunMpCont = true;
+
+        if (0 == _strnicmp(argv[arg], "/APLOAD", strlen("/APLOAD")))
+        {
+            char strTypes[64] = { "" };
+            uint32_t cores = 0;
+            int t = -1;
+
+            if (':' == argv[arg][strlen("/APLOAD")])
+                t = sscanf(&argv[arg][strlen("/APLOAD:")], "%63[^,],%u", strTypes, &cores);
+
+            if (t < 1 || 0 != ApLoadParse(strTypes, &gApLoad.dwTypes))
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/APLOAD:<MEM+INT+AVX+IO|ALL>,<APs>\"", argv[arg]);
+                exit(1);
+            }
+
+            gApLoad.nAPs = cores;
+        }
+
+        if (0 == _stricmp(argv[arg], "/PUBLISH"))
+            gfPublish = true;
+
+        if (0 == _strnicmp(argv[arg], "/CAMPAIGN", strlen("/CAMPAIGN")))
+        {
+            uint32_t iterations = 0, wake = CAMPAIGN_DFLT_WAKE;
+            int t = -1;
+
+            if (':' == argv[arg][strlen("/CAMPAIGN")])
+                t = sscanf(&argv[arg][strlen("/CAMPAIGN:")], "%u,%u", &iterations, &wake);
+
+            if (t < 1 || 0 == iterations || iterations > CAMPAIGN_MAXITER || wake < CAMPAIGN_MIN_WAKE || wake >= 86400)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/CAMPAIGN:<iterations>,<wake seconds>\", max. %d iterations, min. %d seconds", argv[arg], CAMPAIGN_MAXITER, CAMPAIGN_MIN_WAKE);
+                exit(1);
+            }
+
+            gCampaign.nTotal = iterations;
+            gCampaign.dwWakeSec = wake;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/MULTSHIFT", strlen("/MULTSHIFT")))
+        {
+            uint32_t seconds = gdwTscTimeRangeSec;
+            int t = 1;
+
+            if (':' == argv[arg][strlen("/MULTSHIFT")])
+                t = sscanf(&argv[arg][strlen("/MULTSHIFT:")], "%u", &seconds);
+            else if ('\0' != argv[arg][strlen("/MULTSHIFT")])
+                t = -1;
+
+            if (t != 1 || 0 == seconds || seconds > TSCTIME_MS_MAXSECONDS)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/MULTSHIFT:<seconds>\", max. %d seconds", argv[arg], TSCTIME_MS_MAXSECONDS);
+                exit(1);
+            }
+
+            gdwTscTimeRangeSec = seconds;
+            gfMultShiftEmit = true;
+        }
+
+        if (0 == _stricmp(argv[arg], "/VERIFY"))
+        {
+            gfVerifiedRead = true;
+        }
+
+        if (0 == _stricmp(argv[arg], "/CHUNKED"))
+        {
+            gfChunkedWait = true;
+        }
+
+        if (0 == _stricmp(argv[arg], "/TMRSTS"))
+        {
+            if (0 == gPm1aEvtBlkAddr)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", FADT PM1a_EVT_BLK not available in SystemIO space", argv[arg]);
+                exit(1);
+            }
+            gfAcpiTmrSts = true;
+        }
+
+        if (0 == _strnicmp(argv[arg], "/PMTMR", strlen("/PMTMR")))
+        {
+            if (0 == _stricmp(&argv[arg][strlen("/PMTMR")], ":IO") && 0 != gPmTmrBlkAddr)
+                gnPmTmrAccess = PMTMR_ACCESS_IO;
+            else if (0 == _stricmp(&argv[arg][strlen("/PMTMR")], ":MMIO") && nullptr != gpPmTmrMmio)
+                gnPmTmrAccess = PMTMR_ACCESS_MMIO;
+            else
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/PMTMR:<IO/MMIO>\", FADT PM timer I/O %04X, MMIO %p", argv[arg], gPmTmrBlkAddr, gpPmTmrMmio);
+                exit(1);
+            }
+        }
+
+        if (0 == _strnicmp(argv[arg], "/TSPOLICY", strlen("/TSPOLICY")))
+        {
+            const char* rgstrPolicy[TSPOL_NUM] = { ":RDTSC", ":LFENCE", ":RDTSCP", ":MFENCE" };
+            int nPolicy = -1;
+
+            for (int i = 0; i < TSPOL_NUM; i++)
+                if (0 == _stricmp(&argv[arg][strlen("/TSPOLICY")], rgstrPolicy[i]))
+                    nPolicy = i;
+
+            if (nPolicy < 0)
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/TSPOLICY:<RDTSC/LFENCE/RDTSCP/MFENCE>\"", argv[arg]);
+                exit(1);
+            }
+
+            gnTimestampPolicy = nPolicy;
+        }
+
+        if (0 == _stricmp(argv[arg], "/BENCH"))
+        {
+            gfBenchExit = true;
+        }
+
 
         if (0 == _strnicmp(argv[arg], "/NUM", strlen("/NUM")))
         {
@@ -1626,6 +3343,9 @@ int main(int argc, char** argv)
 				gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = true;
 				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
                 gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 
 				strcpy(gCfgStr_CalibrMethod, "original TIANOCORE");
 				pfnDelay = &InternalAcpiDelay;
@@ -1635,6 +3355,9 @@ int main(int argc, char** argv)
                 gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false;
 				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
                 gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = true;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 
 				strcpy(gCfgStr_CalibrMethod, "native TSCSync ACPI");
 				pfnDelay = &AcpiClkWait;
@@ -1644,36 +3367,124 @@ int main(int argc, char** argv)
 				gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false;
 				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = true;
                 gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
 
 				strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT");
 				pfnDelay = &PITClkWait;
 			}
+			else if (0 == _stricmp(strtmp2, "TIMESTAMP") && nullptr != gpfnGetTimestamp)
+			{
+				gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false;
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = true;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
+
+				strcpy(gCfgStr_CalibrMethod, "native TSCSync EFI_TIMESTAMP_PROTOCOL");
+				pfnDelay = &TimestampClkWait;
+			}
+			else if (0 == _stricmp(strtmp2, "APIC"))
+			{
+				fMethodApic = true;
+
+				gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false;
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = true;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = false;
+
+				strcpy(gCfgStr_CalibrMethod, "native TSCSync local APIC timer");
+				pfnDelay = &ApicClkWait;
+			}
+			else if (0 == _stricmp(strtmp2, "i8254OUT2"))
+			{
+				gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI = false;
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+                gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = true;
+
+				strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT OUT2 edges");
+				pfnDelay = &PITOut2ClkWait;
+			}
 			else
                 fErr = true;
 
             if (true == fErr)
             {
-                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/METHOD:TIANO\" or \"/METHOD:ACPI\" or \"/METHOD:i8254\", Tokens %d, \"%s:%s\"\n", argv[arg],t,strtmp,strtmp2);
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/METHOD:TIANO\" or \"/METHOD:ACPI\" or \"/METHOD:i8254\" or \"/METHOD:TIMESTAMP\" (EFI_TIMESTAMP_PROTOCOL %s) or \"/METHOD:APIC\" or \"/METHOD:i8254OUT2\", Tokens %d, \"%s:%s\"\n", argv[arg], nullptr != gpfnGetTimestamp ? "available" : "N/A", t, strtmp, strtmp2);
                 exit(1);
             }
+        }
 
-            if (0 == _strnicmp(argv[arg], "/TIMERWIDTH", strlen("/TIMERWIDTH")))
-            {
-                char strtmp[16];
-                int t;
+        if (0 == _strnicmp(argv[arg], "/TIMERWIDTH", strlen("/TIMERWIDTH")))
+        {
+            char strtmp[16];
+            int t;
 
-                t = sscanf(argv[arg], "%11s:%d", &strtmp, &gCOUNTER_WIDTH);
+            t = sscanf(argv[arg], "%11s:%u", &strtmp, &gCOUNTER_WIDTH);
 
-                if (t != 2 || 1 > gCOUNTER_WIDTH)
-                {
-                    fprintf(stderr, "Parameter failure \"%s\", consider format: \"/TIMERWIDTH:24\"", argv[arg]);
-                    exit(1);
-                }
+            if (t != 2 || (24 != gCOUNTER_WIDTH && 32 != gCOUNTER_WIDTH))
+            {
+                fprintf(stderr, "Parameter failure \"%s\", consider format: \"/TIMERWIDTH:24\" or \"/TIMERWIDTH:32\"\n", argv[arg]);
+                exit(1);
             }
         }
 
     }
 
+    //
+    // select ACPI PM timer access path, I/O or MMIO, benchmark both if both are available
+    //
+    if (1)
+    {
+        if (0 != gPmTmrBlkAddr && nullptr != gpPmTmrMmio)
+        {
+            gqwPmTmrCostIO = AcpiPmTmrReadCost(false);
+            gqwPmTmrCostMMIO = AcpiPmTmrReadCost(true);
+        }
+
+        if (PMTMR_ACCESS_AUTO == gnPmTmrAccess)
+            gfPmTmrMmio = nullptr != gpPmTmrMmio && (0 == gPmTmrBlkAddr || gqwPmTmrCostMMIO < gqwPmTmrCostIO);
+        else
+            gfPmTmrMmio = PMTMR_ACCESS_MMIO == gnPmTmrAccess;
+
+        if (gfPmTmrMmio)
+            sprintf(gstrACPIPmTmrBlkAddr, "%llX MMIO", (unsigned long long)(uintptr_t)gpPmTmrMmio);
+        else
+            sprintf(gstrACPIPmTmrBlkAddr, "%04X I/O", gPmTmrBlkAddr);
+
+        if (0 != gqwPmTmrCostIO && 0 != gqwPmTmrCostMMIO)
+            sprintf(&gstrACPIPmTmrBlkAddr[strlen(gstrACPIPmTmrBlkAddr)], ", TSC per read I/O %lld, MMIO %lld", gqwPmTmrCostIO, gqwPmTmrCostMMIO);
+
+        printf("ACPI PM timer: %s\n", gstrACPIPmTmrBlkAddr);
+
+        if (0 == gPm1aEvtBlkAddr)
+            gfAcpiTmrSts = false;                                   // e.g. stale tscsync.cfg
+        if (gfAcpiTmrSts)
+            printf("ACPI PM timer: long intervals coarse on TMR_STS, PM1_STS %04X\n", gPm1aEvtBlkAddr);
+    }
+
+    //
+    // local APIC timer, taken as free running counter if no one else uses it
+    //
+    if (APIC_ACCESS_NONE != ApicTimerInit())
+    {
+        atexit(ApicTimerRestore);
+        printf("local APIC timer: %s, %s\n", APIC_ACCESS_X2APIC == gnApicAccess ? "x2APIC MSR" : "xAPIC MMIO", gApicTimerResult.fOwned ? "free running" : "firmware owned, read-only");
+    }
+
+    if (true == fMethodApic && false == gApicTimerResult.fOwned)
+    {
+        fprintf(stderr, "Parameter failure \"/METHOD:APIC\", local APIC timer %s\n", APIC_ACCESS_NONE == gnApicAccess ? "N/A" : "firmware owned, read-only");
+        exit(1);
+    }
+
     //
     // set initial calibration method
     //
@@ -1691,10 +3502,32 @@ int main(int argc, char** argv)
             strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT"),
             pfnDelay = &PITClkWait;
 
+        if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP && nullptr == gpfnGetTimestamp)    // configured, but not available
+            gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = false,
+            gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = true;
+
+        if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP)
+            strcpy(gCfgStr_CalibrMethod, "native TSCSync EFI_TIMESTAMP_PROTOCOL"),
+            pfnDelay = &TimestampClkWait;
+
+        if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC && false == gApicTimerResult.fOwned)    // configured, but not available
+            gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false,
+            gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = true;
+
+        if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC)
+            strcpy(gCfgStr_CalibrMethod, "native TSCSync local APIC timer"),
+            pfnDelay = &ApicClkWait;
+
+        if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2)
+            strcpy(gCfgStr_CalibrMethod, "native TSCSync i8254 PIT OUT2 edges"),
+            pfnDelay = &PITOut2ClkWait;
+
         printf("Initial calibration Method: %s\n", gCfgStr_CalibrMethod);
         
     }
 
+    size_t eflagsStartup = __readeflags();                  // interrupts are disabled by the timer characterization below
+
     //
     // record ACPI timer charcteristics
     //
@@ -1705,7 +3538,7 @@ int main(int argc, char** argv)
         _disable();
 
         for (int i = 0; i < MAXNUM; i++)
-            ACPIB2BStat[i] = _inpd(gPmTmrBlkAddr);
+            ACPIB2BStat[i] = gfPmTmrMmio ? *gpPmTmrMmio : _inpd(gPmTmrBlkAddr);
 
         for (int i = 1; i < MAXNUM; i++)
         {
@@ -1768,6 +3601,8 @@ int main(int argc, char** argv)
 	{
 		int SECONDS = gnCfgRefSyncTime;
 		int64_t qwTSCEnd = 0 , qwTSCStart = 0;
+		int bSec, bSecPrev, cntSec = 0, cntEdgeMissed = 0;
+		CLKWAIT_DIAG AcpiDiag = { 0 };
 
 		//
 		// wait UP (update ended) interrupt flag to start on time https://www.nxp.com/docs/en/data-sheet/MC146818.pdf#page=16
@@ -1787,22 +3622,43 @@ int main(int argc, char** argv)
 			;
 		while (0 != (0x80 & _inp(0x71)))
 			;
-		qwTSCStart = __rdtsc();									// get start TSC at falling edge
+		qwTSCStart = ReadTSC();									// get start TSC at falling edge
+		_outp(0x70, 0x00), bSecPrev = _inp(0x71), _outp(0x70, 0x0A);	// seconds anchor of the start edge, BCD
 
-		for (int i = 0; i < SECONDS; i++)
+		//
+		// the seconds are counted on the seconds register at each falling edge, not on the edges:
+		// an interrupt window or an SMI longer than the UIP pulse misses an edge, the next edge
+		// then reports 2 seconds, the interval stays stitched and the missed edge is reported
+		//
+		while (cntSec < SECONDS)
 		{
-			while (0 == (0x80 & _inp(0x71)))
-				;
+			int n;
+
+			//
+			// chunked: let interrupts in while UIP is low only, the falling edge is taken interrupt disabled
+			//
+			for (n = 0; 0 == (0x80 & _inp(0x71)); n++)
+				if (gfChunkedWait && CLKWAIT_CHUNK_RTCREADS == n)
+					n = 0, ClkWaitChunkWindow(eflagsStartup), _outp(0x70, 0x0A);	// reselect RTC Register A
 			while (0 != (0x80 & _inp(0x71)))					// wait for second falling edge
 				;
+			qwTSCEnd = ReadTSC();								// get end TSC
+			_outp(0x70, 0x00), bSec = _inp(0x71), _outp(0x70, 0x0A);
+
+			n = (60 + (bSec / 16) * 10 + (bSec & 0x0F) - (bSecPrev / 16) * 10 - (bSecPrev & 0x0F)) % 60;
+			n = 0 == n ? 1 : n;									// unreadable seconds register, count the edge
+			cntEdgeMissed += n - 1;
+			cntSec += n;
+			bSecPrev = bSec;
 		}
-		qwTSCEnd = __rdtsc();									// get end TSC
-		gTSCPerSecRTC = (int64_t)((qwTSCEnd - qwTSCStart) / SECONDS);
+		gTSCPerSecRTC = (int64_t)((qwTSCEnd - qwTSCStart) / cntSec);
 
 		//
 		// ACPI calibration
 		//
-		qwTSCEnd = AcpiClkWait(SECONDS * 3579543);				// this function returns the diff
+		if (gfChunkedWait && (0x200 & eflagsStartup))
+			_enable();											// the kernels disable interrupts per segment only
+		qwTSCEnd = AcpiClkWait(SECONDS * 3579543, &AcpiDiag);				// this function returns the diff
 
 		gTSCPerSecACPI = (int64_t)((qwTSCEnd) / SECONDS);
 		gTSCPerSecACPIRnd = gTSCPerSecACPI;
@@ -1970,6 +3826,66 @@ int main(int argc, char** argv)
 		sprintf(gstrCPUSpeedRTC, "%lldHz", gTSCPerSecRTC);
 		sprintf(gstrCPUSpeedACPI, "%lldHz", gTSCPerSecACPI);
 		sprintf(gstrCPUSpeedRND, "%lldHz", gTSCPerSecACPIRnd);
+
+		if (gfChunkedWait || 0 != cntEdgeMissed)
+			printf("startup calibration: RTC %d s, %d update edges missed, ACPI %u segments, max. window %lldus, %u counter wraps lost in windows restored\n",
+				cntSec, cntEdgeMissed, AcpiDiag.cntSegments, (int64_t)AcpiDiag.qwTSCWindowMax * 1000000 / gTSCPerSecRTC, AcpiDiag.cntWrapLost);
+
+		TscTimeInit((uint64_t)gTSCPerSecACPIRnd);		// calibrated TSC time and delay service
+
+		printf("TSC to ns mult/shift: %u/%u, %+.3f ppb, ns to TSC: %u/%u, %+.3f ppb, range %u s\n",
+			gTscTimeToNs.dwMult, gTscTimeToNs.dwShift, gTscTimeToNs.dblErrPpb, gTscTimeFromNs.dwMult, gTscTimeFromNs.dwShift, gTscTimeFromNs.dblErrPpb, gdwTscTimeRangeSec);
+
+		if (gfMultShiftEmit)
+		{
+			FILE* fp = fopen(TSCTIME_MS_FILENAME, "w");
+
+			if (NULL == fp)
+			{
+				fprintf(stderr, "Can't write %s\n", TSCTIME_MS_FILENAME);
+				exit(1);
+			}
+
+			TscTimeEmitHeader(fp);
+			fclose(fp);
+			printf("%s written\n", TSCTIME_MS_FILENAME);
+		}
+
+		//
+		// TSCSYNC_PROTOCOL, publish the calibrated TSC frequency for subsequent applications
+		//
+		if (1)
+		{
+			TSCSYNC_PROTOCOL* pTscSync = nullptr;
+
+			if (EFI_SUCCESS == TscSyncProtocolLocate(gSystemTable->BootServices, &pTscSync))
+				printf("TSCSYNC_PROTOCOL found: %lluHz +/- %lluHz, published %.0fs ago\n", 
+					pTscSync->TscFrequency, pTscSync->TscFrequencyUncertainty, (double)(ReadTSC() - pTscSync->CalibrationTsc) / gTSCPerSecACPIRnd);
+
+			if (gfPublish)
+			{
+				static TSCSYNC_PROTOCOL TscSync;
+				EFI_STATUS Status;
+				int64_t llRnd = llabs(gTSCPerSecACPIRnd - gTSCPerSecACPI), llRTC = llabs(gTSCPerSecRTC - gTSCPerSecACPI);
+
+				TscSync.TscFrequency = (UINT64)gTSCPerSecACPIRnd;
+				TscSync.TscFrequencyUncertainty = (UINT64)(llRnd > llRTC ? llRnd : llRTC);	// rounding and RTC vs. ACPI
+				TscSync.CalibrationTsc = ReadTSC();
+				TscSync.TscNsMult = gTscTimeToNs.dwMult;
+				TscSync.TscNsShift = gTscTimeToNs.dwShift;
+				TscSync.MultShiftRange = gTscTimeToNs.dwMaxSec;
+				TscSync.NumberOfCpus = TscOfsHwRun(TscSync.TscOffset, TSCSYNC_MAXCPU);
+				snprintf(TscSync.Method, sizeof(TscSync.Method), "%s", gCfgStr_CalibrMethod);
+
+				Status = TscSyncProtocolPublish(gSystemTable->BootServices, &TscSync, nullptr);
+				if (EFI_UNSUPPORTED == Status)
+					printf("TSCSYNC_PROTOCOL not published, incompatible instance installed\n");
+				else if (EFI_SUCCESS != Status)
+					printf("TSCSYNC_PROTOCOL not published, \"%s\"\n", _strefierror(Status));
+				else
+					printf("TSCSYNC_PROTOCOL published: %lluHz +/- %lluHz, TSC offset of %u CPUs\n", TscSync.TscFrequency, TscSync.TscFrequencyUncertainty, TscSync.NumberOfCpus);
+			}
+		}
 		
 		//
 		// TIMESTAMP_PROTOCOL Seconds Drift Per Day 
@@ -2036,6 +3952,110 @@ int main(int argc, char** argv)
 
 	}while (0);
 
+	//
+	// overhead of each timestamp policy
+	//
+	for (int i = 0; i < TSPOL_NUM; i++)
+		grgqwTimestampOverhead[i] = TimestampOverhead(i);
+	printf("Timestamp policy: %s, %lld TSC cycles overhead\n", grgstrTimestampPolicy[gnTimestampPolicy], grgqwTimestampOverhead[gnTimestampPolicy]);
+
+	//
+	// local APIC timer frequency against RTC and ACPI timer, read cost
+	//
+	if (APIC_ACCESS_NONE != gnApicAccess)
+	{
+		printf("Measuring local APIC timer against RTC and ACPI, %d seconds...\n", APIC_DFLT_SECONDS);
+
+		if (0 == ApicTimerCharacterize(&gApicTimerResult, APIC_DFLT_SECONDS))
+			gqwApicTimerFreq = (uint64_t)gApicTimerResult.dblHzRTC;
+
+		printf("local APIC timer: %.0fHz RTC, %.0fHz ACPI, %lld TSC per read\n", gApicTimerResult.dblHzRTC, gApicTimerResult.dblHzACPI, gApicTimerResult.qwReadCost);
+	}
+
+	if (true == gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC && 0 == gqwApicTimerFreq)	// APIC timer doesn't count
+	{
+		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = false;
+		gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = true;
+		gApicTimerResult.fOwned = false;
+		strcpy(gCfgStr_CalibrMethod, "native TSCSync ACPI");
+		pfnDelay = &AcpiClkWait;
+	}
+
+	//
+	// cold boot campaign, append this boot's calibration, then S5 until the RTC alarm
+	//
+	if (0 != gCampaign.nTotal)
+	{
+		CAMPAIGN_RECORD Record = { __rdtsc(), gTSCPerSecRTC, gTSCPerSecACPI, gTSCPerSecACPIRnd, gTIMESTAMP_PROTOCOLPerSec, gCfgStr_CalibrMethod };
+		int nRet;
+
+		gCampaign.wPm1aEvtBlk = gPm1aEvtBlkAddr;
+		gCampaign.wPm1aEn = gPm1aEnAddr;
+		gCampaign.wPm1aCntBlk = gPm1aCntBlkAddr;
+		gCampaign.bS5Val = S5Val;
+
+		if (0 == gPm1aEvtBlkAddr || 0 == gPm1aCntBlkAddr)
+		{
+			fprintf(stderr, "Campaign failure, no PM1a event/control block in FADT\n");
+			exit(1);
+		}
+
+		printf("Campaign: record %u of %u to %s, %u s in S5...\n", CampaignCount(CAMPAIGN_FILENAME) + 1, gCampaign.nTotal, CAMPAIGN_FILENAME, gCampaign.dwWakeSec);
+
+		nRet = CampaignStep(&gCampaign, &gCampaignIoHw, CAMPAIGN_FILENAME, &Record);
+
+		if (CAMPAIGN_ERROR == nRet)
+		{
+			fprintf(stderr, "Campaign failure, %s not writable or RTC not readable\n", CAMPAIGN_FILENAME);
+			exit(1);
+		}
+
+		if (CAMPAIGN_DONE == nRet)
+		{
+			printf("Campaign complete: %u records in %s\n", gCampaign.nDone, CAMPAIGN_FILENAME);
+			exit(0);
+		}
+
+		printf("S5 not entered, SLP_TYP %X\n", S5Val);	// CAMPAIGN_CONTINUE doesn't return
+		exit(1);
+	}
+
+	//
+	// non-interactive timer primitives benchmark
+	//
+	if (gfBenchExit)
+	{
+		if (0 != BenchRun(&gBenchResult, (double)gTSCPerSecRTC))
+		{
+			fprintf(stderr, "Benchmark failure, out of memory\n");
+			exit(1);
+		}
+
+		printf("\n");
+		BenchPrintTable(stdout, &gBenchResult);
+		printf("\n");
+		BenchPrintCsv(stdout, &gBenchResult);
+		exit(0);
+	}
+
+	if (gfTimerLibExit)
+	{
+		TimerLibBenchRun(&gTimerLibResult, (double)gTSCPerSecRTC);
+
+		printf("\n");
+		TimerLibBenchPrintTable(stdout, &gTimerLibResult);
+		exit(0);
+	}
+
+	if (gfTscTimeExit)
+	{
+		TscTimeBenchRun(&gTscTimeBench, (double)gTSCPerSecRTC);
+
+		printf("\n");
+		TscTimeBenchPrintTable(stdout, &gTscTimeBench);
+		exit(0);
+	}
+
 	do
 	{
 		char* pc = new char[256];
@@ -2050,7 +4070,7 @@ int main(int argc, char** argv)
 																								L"SoftOFF/S5...                          ",
 																								L"Save and Exit...                       "},
 																							{&fnMnuItm_File_SaveAs, nullptr, &fnMnuItm_File_Exit,&fnMnuItm_File_SwitchOff,&fnMnuItm_File_SaveExit}},
-			{{ 8,0},	L" CONF ",	nullptr,{38,15	/* # menuitems + 2 */},	/*{false, false, true, false},*/
+			{{ 8,0},	L" CONF ",	nullptr,{38,21	/* # menuitems + 2 */},	/*{false, false, true, false},*/
 				{
 					/*index 3 */ wcsTimerDelayAcpiStrings[gfCfgMngMnuItm_Config_ACPIDelaySelect1][0],	/* selected by default menu strings */
 					/*index 4 */ wcsTimerDelayAcpiStrings[gfCfgMngMnuItm_Config_ACPIDelaySelect2][1],
@@ -2063,8 +4083,14 @@ int main(int argc, char** argv)
 					/*index11 */ wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI][0],
 					/*index12 */ wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCPIT][1],
 					/*index13 */ wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI][2],
-					/*index14 */ wcsSeparator17,
-					/*index15 */ wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2 : gfErrorCorrection][0],
+					/*index14 */ nullptr == gpfnGetTimestamp ? wcsCalibMethodTSTAMPNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP][3],
+					/*index15 */ false == gApicTimerResult.fOwned ? wcsCalibMethodAPICNA : wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC][4],
+					/*index16 */ wcsCalibMethod[gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2][5],
+					/*index17 */ wcsSeparator17,
+					/*index18 */ wcsErrorCorrection[pfnDelay == &InternalAcpiDelay ? 2 : gfErrorCorrection][0],
+					/*index19 */ wcsVerifiedRead[pfnDelay == &InternalAcpiDelay || pfnDelay == &TimestampClkWait || pfnDelay == &PITOut2ClkWait ? 2 : gfVerifiedRead][0],
+					/*index20 */ wcsSeparator17,
+					/*index21 */ L"  Timestamp policy            \x25BA ",
 				},
 				{
 					/*index 3 */ &fnMnuItm_Config_ACPIDelaySelect1,
@@ -2078,11 +4104,17 @@ int main(int argc, char** argv)
 					/*index11 */ &fnMnuItm_Config_CalibMethodSelectTIANOACPI,
 					/*index12 */ &fnMnuItm_Config_CalibMethodSelectTSCSYNCPIT,
 					/*index13 */ &fnMnuItm_Config_CalibMethodSelectTSCSYNCACPI,
-					/*index14 */ nullptr/* nullptr identifies SEPARATOR */,
-					/*index15 */ gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI ? nullptr : fnMnuItm_Config_ErrorCorrection/* nullptr identifies SEPARATOR */,
+					/*index14 */ nullptr == gpfnGetTimestamp ? nullptr : &fnMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP,
+					/*index15 */ false == gApicTimerResult.fOwned ? nullptr : &fnMnuItm_Config_CalibMethodSelectTSCSYNCAPIC,
+					/*index16 */ &fnMnuItm_Config_CalibMethodSelectTSCSYNCOUT2,
+					/*index17 */ nullptr/* nullptr identifies SEPARATOR */,
+					/*index18 */ gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI ? nullptr : fnMnuItm_Config_ErrorCorrection/* nullptr identifies SEPARATOR */,
+					/*index19 */ gfCfgMngMnuItm_Config_CalibMethodSelectTIANOACPI || gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP || gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 ? nullptr : fnMnuItm_Config_VerifiedRead,
+					/*index20 */ nullptr/* nullptr identifies SEPARATOR */,
+					/*index21 */ &fnMnuItm_TimestampPolicy,
 					}
 				},
-			{{15,0},	L" RUN  ",		nullptr,{20,4/* # menuitems + 2 */},	/*{false, false},*/ {L"Run CONFIG      ",L"Run DRIFT TEST  "},{&fnMnuItm_RunConfig_0,&fnMnuItm_RunDriftTest_0}},
+			{{15,0},	L" RUN  ",		nullptr,{20,14/* # menuitems + 2 */},	/*{false, false, false, false},*/ {L"Run CONFIG      ",L"Run DRIFT TEST  ",L"Run DRIFT SERVO ",L"Run HWLAT DETECT",L"Run ADEV/MTIE   ",L"Run SPECTRUM    ",L"Run KALMAN FUSE ",L"Run ACPI/PIT REF",L"Run BENCHMARK   ",L"Run TIMERLIB    ",L"Run TSC DELAY   ",L"Run MULTICORE   "},{&fnMnuItm_RunConfig_0,&fnMnuItm_RunDriftTest_0,&fnMnuItm_RunDriftServo_0,&fnMnuItm_RunHwLat_0,&fnMnuItm_RunAdev_0,&fnMnuItm_RunSpectrum_0,&fnMnuItm_RunKalman_0,&fnMnuItm_RunXRef_0,&fnMnuItm_RunBench_0,&fnMnuItm_RunTimerLib_0,&fnMnuItm_RunTscTime_0,&fnMnuItm_RunMpCont_0}},
 			{{22,0},	L" VIEW ",		nullptr,{23,5/* # menuitems + 2 */},	/*{false},*/ {L"System Information ",L"Clock              ",L"Calendar           " },{&fnMnuItm_View_SysInfo,&fnMnuItm_View_Clock,&fnMnuItm_View_Calendar}},
 			{{29,0},	L" HELP ",		nullptr,{20,4/* # menuitems + 2 */},	/*{false, false},*/ {L"About           ",L"KEYBOARD DEBUG  "},{&fnMnuItm_About_0, &fnMnuItm_About_1 }},
 		};
@@ -2150,7 +4182,7 @@ int main(int argc, char** argv)
 		// 
 		FullScreen.TextPrint({ 2, 2 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI OemId                       : %s", gstrACPIOemId);
 		FullScreen.TextPrint({ 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI OemTableId                  : %s", gstrACPIOemTableId);
-		FullScreen.TextPrint({ 2, 4 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer I/O Address           : %s", gstrACPIPmTmrBlkAddr);
+		FullScreen.TextPrint({ 2, 4 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer Address               : %s", gstrACPIPmTmrBlkAddr);
 		//FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI Timer Size                  : %s", gACPIPmTmrBlkSize);
 		FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK,  "ACPI PCIEBase                    : %s", gACPIPCIEBase);
 
@@ -2178,6 +4210,7 @@ int main(int argc, char** argv)
 		FullScreen.TextPrint({ 2, 19 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "target .XLSX                     : %s", gCfgStr_File_SaveAs);
 		FullScreen.TextPrint({ 2, 20 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Calibration Method               : %s", gCfgStr_CalibrMethod);
         FullScreen.TextPrint({ 2, 21 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Error correction                 : %s", 0 == gfErrorCorrection ? "disabled" : (pfnDelay == &InternalAcpiDelay ? "N/A on TIANOCORE" : "enabled"));
+		FullScreen.TextPrint({ 2, 22 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Timestamp policy                 : %s, %lld TSC cycles overhead", grgstrTimestampPolicy[gnTimestampPolicy], grgqwTimestampOverhead[gnTimestampPolicy]);
 		
 		
 		if (true == gfAutoRun)
@@ -2299,6 +4332,7 @@ int main(int argc, char** argv)
 					// stop currently running activity
 					//
 					gfRunDriftTest = false,
+					gfRunDriftServo = false,
 
 					state = MENU_IS_ACTIVE;
 					break;
@@ -2469,7 +4503,7 @@ int main(int argc, char** argv)
 						key = NO_KEY;
 					while (0) {
 						//AcpiClkWait(5 * 3579545);
-						PITClkWait(3579545/3);
+						PITClkWait(3579545/3, nullptr);
 						gfHexView ^= true;
 						if (true == gfHexView)
 						{
@@ -2484,9 +4518,11 @@ int main(int argc, char** argv)
 					{ 
 						CDE_APP_IF* pCdeAppIf = (CDE_APP_IF*)__cdeGetAppIf();						// get access to CdePkg internally
 						time_t RTCtime64=time(NULL);												// pre-initialize RTC time with Date from Standard C Time
-						int bcdsec = rtcrd(0);
-						int bcdmin = rtcrd(2);
-						int bcdhour = rtcrd(4);
+						RTC_SNAPSHOT RtcSnap;
+						int fRtcSnap = 0 == RtcSnapshotRead(&RtcSnap);								// hh:mm:ss from one UIP safe window
+						int bcdsec = fRtcSnap ? RtcSnap.bSec : rtcrd(0);
+						int bcdmin = fRtcSnap ? RtcSnap.bMin : rtcrd(2);
+						int bcdhour = fRtcSnap ? RtcSnap.bHour : rtcrd(4);
 						int hour = (bcdhour / 16) * 10 + (bcdhour & 0x0F);
 						int min = (bcdmin / 16) * 10 + (bcdmin & 0x0F);
 						int sec = (bcdsec / 16) * 10 + (bcdsec & 0x0F);
@@ -2610,6 +4646,496 @@ int main(int argc, char** argv)
 
 					}while (0);//if do (gfRunDriftTest)
 
+					if (gfRunDriftServo)
+					{
+						CLOCK_SERVO* p = &gClockServo;
+						static const char* rgstrState[] = { "NSET", "FREQ", "SYNC" };
+
+						//
+						// take the next RTC second edge not before the poll interval is through
+						//
+						if (SERVO_NSET == p->nState || ServoClock(p, __rdtsc()) - p->dblRefTime >= (double)(1U << p->nPollExp) - 1.0)
+						{
+							ServoUpdate(p, ServoWaitRtcEdge());
+
+							FullScreen.TextBlockDraw({ (FullScreen.WinDim.X - (int32_t)strlen("DISCIPLINED TSC CLOCK, PLL/FLL SERVO vs. RTC")) / 2 ,4 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "DISCIPLINED TSC CLOCK, PLL/FLL SERVO vs. RTC");
+
+							FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "servo state, poll      : %s, %d s, %d RTC reads in %.0f s        ",
+								rgstrState[p->nState],
+								1U << p->nPollExp,
+								p->cntUpdates,
+								p->dblRefTime);
+							FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "frequency correction   : %+.3f ppm, disciplined TSC %.0fHz        ",
+								p->dblFreq * 1e6,
+								p->dblTSCNominal / (1.0 + p->dblFreq));
+							FullScreen.TextPrint({ 2, 9 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "residual phase error   : %+.1f us, jitter %.1f us        ",
+								p->dblOffset * 1e6,
+								p->dblJitter * 1e6);
+							if (0 != p->cntHist)
+								FullScreen.TextPrint({ 2, 10 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "free running clock     : %+.1f us @ %lldHz        ",
+									p->rgHist[p->cntHist - 1].dblOffsetFree * 1e6,
+									gTSCPerSecRTC);
+							if (p->dblLockTime < 0.0)
+								FullScreen.TextPrint({ 2, 11 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "convergence time       : not yet locked, offset < %.0f us        ", SERVO_LOCK_US);
+							else
+								FullScreen.TextPrint({ 2, 11 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "convergence time       : %.0f s, offset < %.0f us                 ", p->dblLockTime, SERVO_LOCK_US);
+						}
+					}
+
+					if (gfRunHwLat)
+					{
+						uint64_t qwTSCPerMs = gTSCPerSecACPIRnd / 1000;
+						uint32_t nRemainingMs = gnCfgHwLatWindowMs;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: HW latency detection running for %d ms", gnCfgHwLatWindowMs);
+						FullScreen.TextPrint({ 5, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "running HW latency detector, window %d ms, threshold %d us ... ", gnCfgHwLatWindowMs, gnCfgHwLatThresholdUs);
+
+						//
+						// do the measurement, interrupts are disabled for max. HWLAT_WIDTH_MS at once
+						//
+						HwLatDetectInit(&gHwLatResult, gTSCPerSecACPIRnd / 1000000, gnCfgHwLatThresholdUs, 0 == strcmp(gstrCPUID0, "GenuineIntel"));
+
+						while (nRemainingMs > 0)
+						{
+							uint32_t nWidthMs = nRemainingMs > HWLAT_WIDTH_MS ? HWLAT_WIDTH_MS : nRemainingMs;
+
+							HwLatDetect(&gHwLatResult, qwTSCPerMs * nWidthMs);
+							nRemainingMs -= nWidthMs;
+
+							FullScreen.TextWindowUpdateProgress();
+						}
+
+						gfRunHwLat = false;
+
+						//
+						// show the result
+						//
+						if (1)
+						{
+							HWLAT_RESULT* p = &gHwLatResult;
+							double dblTSCPerUs = (double)p->qwTSCPerUs;
+							uint64_t cntBinMax = 1;
+							char strBar[32];
+
+							FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("HARDWARE LATENCY (SMI/STALL) DETECTOR")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "HARDWARE LATENCY (SMI/STALL) DETECTOR");
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "window, threshold       : %d ms, %d us, %lld TSC reads, %.1f ns per read                ",
+								gnCfgHwLatWindowMs,
+								gnCfgHwLatThresholdUs,
+								p->cntLoops,
+								(double)p->qwTSCSampled * 1000.0 / dblTSCPerUs / (double)p->cntLoops);
+							FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "gaps above threshold    : %lld, %.1f us stalled, %lld ppm of sampled time",
+								p->cntGaps,
+								(double)p->qwTSCStalled / dblTSCPerUs,
+								(p->qwTSCStalled * 1000000) / p->qwTSCSampled);
+							FullScreen.TextPrint({ 2, 7 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "worst case              : %.1f us @ %lld ms, SMI_COUNT delta %u",
+								(double)p->qwTSCWorst / dblTSCPerUs,
+								p->qwTSCWorstTimestamp / (p->qwTSCPerUs * 1000),
+								p->dwSMIWorst);
+							if (p->fSMICount)
+								FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "SMI_COUNT (MSR 0x34)    : %u SMIs during detection", p->dwSMITotal);
+							else
+								FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "SMI_COUNT (MSR 0x34)    : N/A");
+
+							for (int i = 0; i < HWLAT_NUMBINS + 1; i++)
+								cntBinMax = p->rgcntBin[i] > cntBinMax ? p->rgcntBin[i] : cntBinMax;
+
+							for (int i = 0; i < HWLAT_NUMBINS + 1; i++)
+							{
+								int nBar = (int)((p->rgcntBin[i] * (sizeof(strBar) - 1)) / cntBinMax);
+
+								memset(strBar, '#', nBar), strBar[nBar] = '\0';
+
+								if (i < HWLAT_NUMBINS)
+									FullScreen.TextPrint({ 2, 10 + i }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%6u .. %6u us : %8lld %s",
+										0 == i ? p->dwThresholdUs : p->rgdwBinLimitUs[i - 1], p->rgdwBinLimitUs[i], p->rgcntBin[i], strBar);
+								else
+									FullScreen.TextPrint({ 2, 10 + i }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%6u .. ...    us : %8lld %s",
+										p->rgdwBinLimitUs[i - 1], p->rgcntBin[i], strBar);
+							}
+						}
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunAdev)
+					{
+						PHASE_RECORD PhaseRec;
+						uint32_t cntNeeded = (uint32_t)(gnCfgAdevSeconds * PHASE_ACPI_FREQ / PHASE_ACPI_TAU0) + 1;
+						uint32_t nDecimation = (cntNeeded + PHASE_MAXNUM - 1) / PHASE_MAXNUM;	// enlarge tau0 for very long records
+						uint32_t cntChunk;
+						int nRet = -1;
+
+						memset(&PhaseRec, 0, sizeof(PhaseRec));
+						PhaseRec.dwTicksPerSample = PHASE_ACPI_TAU0 * nDecimation;
+						PhaseRec.cntMax = (uint32_t)(gnCfgAdevSeconds * PHASE_ACPI_FREQ / PhaseRec.dwTicksPerSample) + 1;
+						PhaseRec.rgqwTSC = (uint64_t*)malloc(PhaseRec.cntMax * sizeof(uint64_t));
+						cntChunk = (uint32_t)(PHASE_ACPI_FREQ / 2 / PhaseRec.dwTicksPerSample) + 1;	// interrupts disabled for ~0.5s at once
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: recording TSC vs. ACPI timer phase for %d s", gnCfgAdevSeconds);
+						FullScreen.TextPrint({ 5, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "recording phase, %d samples, tau0 %.3f ms ... ", PhaseRec.cntMax, PhaseRec.dwTicksPerSample * 1000.0 / PHASE_ACPI_FREQ);
+
+						if (nullptr != PhaseRec.rgqwTSC)
+						{
+							while (PhaseRec.cnt < PhaseRec.cntMax)
+							{
+								AcpiPhaseCapture(&PhaseRec, cntChunk);
+								FullScreen.TextWindowUpdateProgress();
+							}
+
+							nRet = StabilityAnalyze(&PhaseRec, PHASE_ACPI_FREQ, (double)gTSCPerSecACPI, &gStabilityResult);
+
+							free(PhaseRec.rgqwTSC);
+						}
+
+						gfRunAdev = false;
+
+						//
+						// show the result
+						//
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("OSCILLATOR STABILITY, TSC vs. ACPI TIMER")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "OSCILLATOR STABILITY, TSC vs. ACPI TIMER");
+
+						if (0 != nRet)
+						{
+							memset(&gStabilityResult, 0, sizeof(gStabilityResult));
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_RED, "phase record failed, out of memory or record too short                      ");
+						}
+						else
+						{
+							STABILITY_RESULT* p = &gStabilityResult;
+
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "phase record           : %u samples, tau0 %.3f ms, %.1f s                    ",
+								p->cntSamples,
+								p->dblTau0 * 1000.0,
+								p->dblTau0 * (p->cntSamples - 1));
+							FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "TSC frequency offset   : %+.3f ppm vs. %lldHz (removed from MTIE/TIE)",
+								p->dblFreqOffset * 1e6,
+								gTSCPerSecACPI);
+
+							FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "      tau [s]          ADEV        MTIE [ns]");
+
+							for (uint32_t i = 0; i < p->cntTau && 9 + (int)i < FullScreen.WinDim.Y - 3; i++)
+								FullScreen.TextPrint({ 2, 9 + (int32_t)i }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%13.3f    %10.3e   %12.1f",
+									p->rgdblTau[i],
+									p->rgdblAdev[i],
+									p->rgdblMtie[i] * 1e9);
+						}
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunSpectrum)
+					{
+						PHASE_RECORD PhaseRec;
+						uint32_t n = 1U << SPEC_MINLOG2N, cntChunk;
+						int nRet = -1;
+
+						while (n < gnCfgSpectrumSeconds * PHASE_ACPI_FREQ / SPEC_TICKS_PER_SAMPLE && n < (1U << SPEC_MAXLOG2N))
+							n <<= 1;
+
+						memset(&PhaseRec, 0, sizeof(PhaseRec));
+						PhaseRec.dwTicksPerSample = SPEC_TICKS_PER_SAMPLE;
+						PhaseRec.cntMax = n + 1;
+						PhaseRec.rgqwTSC = (uint64_t*)malloc(PhaseRec.cntMax * sizeof(uint64_t));
+						cntChunk = (uint32_t)(PHASE_ACPI_FREQ / 2 / SPEC_TICKS_PER_SAMPLE);	// interrupts disabled for ~0.5s at once
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: recording TSC vs. ACPI timer phase for %.1f s", n / (PHASE_ACPI_FREQ / SPEC_TICKS_PER_SAMPLE));
+						FullScreen.TextPrint({ 5, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "recording phase, %d samples at %.0f kHz ... ", PhaseRec.cntMax, PHASE_ACPI_FREQ / SPEC_TICKS_PER_SAMPLE / 1000);
+
+						if (nullptr != PhaseRec.rgqwTSC)
+						{
+							while (PhaseRec.cnt < PhaseRec.cntMax)
+							{
+								AcpiPhaseCapture(&PhaseRec, cntChunk);
+								FullScreen.TextWindowUpdateProgress();
+							}
+
+							FullScreen.TextPrint({ 5, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "running FFT, %d points ...                          ", n);
+
+							nRet = SpectrumAnalyze(&PhaseRec, PHASE_ACPI_FREQ, (double)gTSCPerSecACPI, &gSpectrumResult);
+
+							free(PhaseRec.rgqwTSC);
+						}
+
+						gfRunSpectrum = false;
+
+						//
+						// show the result
+						//
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("SPECTRUM, TSC vs. ACPI TIMER")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "SPECTRUM, TSC vs. ACPI TIMER");
+
+						if (0 != nRet)
+						{
+							memset(&gSpectrumResult, 0, sizeof(gSpectrumResult));
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_RED, "phase record failed, out of memory                                          ");
+						}
+						else
+						{
+							SPECTRUM_RESULT* p = &gSpectrumResult;
+
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "FFT                    : %u points, fs %.1f kHz, resolution %.3f Hz        ",
+								p->cntSamples,
+								p->dblFs / 1000,
+								p->dblDf);
+							FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "TSC frequency offset   : %+.3f ppm, %u phase spike samples",
+								p->dblFreqOffset * 1e6,
+								p->cntSpikes);
+							if (p->fSSC)
+								FullScreen.TextPrint({ 2, 7 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "spread spectrum clock  : %.3f kHz, depth %.3f%% (triangular)",
+									p->dblSSCRate / 1000,
+									p->dblSSCDepth * 100);
+							else
+								FullScreen.TextPrint({ 2, 7 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "spread spectrum clock  : not detected");
+							if (p->fSMI)
+								FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "periodic SMI           : %.3f ms, %.1f ns phase amplitude, %u harmonics",
+									p->dblSMIPeriod * 1000,
+									p->dblSMIAmpl * 1e9,
+									p->cntSMIHarm);
+							else
+								FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "periodic SMI           : not detected");
+
+							FullScreen.TextPrint({ 2, 10 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "   frequency [Hz]   freq. dev. [ppm]     phase [ns]        SNR");
+
+							for (uint32_t i = 0; i < p->cntPeak && 11 + (int)i < FullScreen.WinDim.Y - 3; i++)
+								FullScreen.TextPrint({ 2, 11 + (int32_t)i }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%17.3f %18.4f %14.3f %10.1f",
+									p->rgPeak[i].dblFreq,
+									p->rgPeak[i].dblFreqDev * 1e6,
+									p->rgPeak[i].dblPhase * 1e9,
+									p->rgPeak[i].dblSNR);
+						}
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunKalman)
+					{
+						uint64_t qwTSCPerMs = gTSCPerSecACPIRnd / 1000;
+						uint32_t nRemainingMs = gnCfgKalmanSeconds * 1000;
+						KALMAN_STATE* p = &gKalmanState;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: Kalman fusion of ACPI, PIT and RTC running for %d s", gnCfgKalmanSeconds);
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("KALMAN FILTER, ACPI/PIT/RTC FUSION")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "KALMAN FILTER, ACPI/PIT/RTC FUSION");
+
+						KalmanInit(p, (double)gTSCPerSecACPI);
+
+						//
+						// interrupts are disabled for max. KF_WIDTH_MS at once, the estimate is shown after each chunk
+						//
+						while (nRemainingMs > 0)
+						{
+							uint32_t nWidthMs = nRemainingMs > KF_WIDTH_MS ? KF_WIDTH_MS : nRemainingMs;
+							KALMAN_ESTIMATE Est;
+
+							KalmanCapture(p, qwTSCPerMs * nWidthMs);
+							nRemainingMs -= nWidthMs;
+
+							KalmanEstimate(p, &Est);
+
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "time, observations     : %.1f s, ACPI %lld, PIT %lld, RTC %lld        ",
+								Est.dblTime,
+								p->rgcntObs[KF_REF_ACPI],
+								p->rgcntObs[KF_REF_PIT],
+								p->rgcntObs[KF_REF_RTC]);
+							FullScreen.TextPrint({ 2, 7 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "TSC frequency, RTC     : %.1f +/- %.1f Hz        ", Est.dblTSCPerSec, Est.dblTSCPerSecSigma);
+							FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "TSC frequency, ACPI    : %.1f +/- %.1f Hz        ", Est.dblTSCPerSecACPI, Est.dblTSCPerSecACPISigma);
+							FullScreen.TextPrint({ 2, 9 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "ACPI vs. RTC           : %+.3f +/- %.3f ppm, %+.2f s per day        ", Est.dblACPIvsRTC * 1e6, Est.dblACPIvsRTCSigma * 1e6, Est.dblACPIvsRTC * 86400);
+							FullScreen.TextPrint({ 2, 10 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "PIT vs. RTC            : %+.3f +/- %.3f ppm        ", Est.dblPITvsRTC * 1e6, Est.dblPITvsRTCSigma * 1e6);
+							FullScreen.TextPrint({ 2, 11 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "TSC drift              : %+.3f +/- %.3f ppb/s        ", Est.dblDrift * 1e9, Est.dblDriftSigma * 1e9);
+							FullScreen.TextPrint({ 2, 13 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "startup calibration    : %lldHz ACPI, %lldHz RTC", gTSCPerSecACPI, gTSCPerSecRTC);
+
+							FullScreen.TextWindowUpdateProgress();
+						}
+
+						gfRunKalman = false;
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunXRef)
+					{
+						uint64_t qwTSCPerMs = gTSCPerSecACPIRnd / 1000;
+						uint32_t nRemainingMs = gnCfgXRefSeconds * 1000;
+						XREF_RESULT* p = &gXRefResult;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: ACPI timer vs. PIT cross-reference running for %d s", gnCfgXRefSeconds);
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("ACPI TIMER VS. PIT I8254 CROSS-REFERENCE")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "ACPI TIMER VS. PIT I8254 CROSS-REFERENCE");
+
+						CrossRefInit(p, (double)gTSCPerSecACPI);
+
+						//
+						// interrupts are disabled for max. XREF_WIDTH_MS at once, the result is shown after each chunk
+						//
+						while (nRemainingMs > 0)
+						{
+							uint32_t nWidthMs = nRemainingMs > XREF_WIDTH_MS ? XREF_WIDTH_MS : nRemainingMs;
+
+							CrossRefCapture(p, qwTSCPerMs * nWidthMs);
+							nRemainingMs -= nWidthMs;
+
+							CrossRefAnalyze(p);
+
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "time, samples          : %.1f s, %u samples, %lld read pairs        ", p->dblSeconds, p->cntSamples, p->cntReads);
+							FullScreen.TextPrint({ 2, 7 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "ACPI, PIT frequency    : %.1f Hz, %.1f Hz        ", p->rgdblHz[XREF_REF_ACPI], p->rgdblHz[XREF_REF_PIT]);
+							FullScreen.TextPrint({ 2, 8 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "ACPI:PIT ratio         : %.9f, %+.3f ppm        ", p->dblRatio, p->dblRatioPpm);
+							FullScreen.TextPrint({ 2, 9 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "ratio drift            : %+.4f ppm/s        ", p->dblRatioDrift);
+							FullScreen.TextPrint({ 2, 10 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "jitter ACPI, PIT, rel. : %.1f ns, %.1f ns, %.1f ns        ", p->rgdblJitter[XREF_REF_ACPI] * 1e9, p->rgdblJitter[XREF_REF_PIT] * 1e9, p->dblJitterRel * 1e9);
+							FullScreen.TextPrint({ 2, 11 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "time for %.1f ppm      : ACPI %.2f s, PIT %.2f s        ", XREF_PPM_TARGET, p->rgdblCalSec[XREF_REF_ACPI], p->rgdblCalSec[XREF_REF_PIT]);
+							FullScreen.TextPrint({ 2, 13 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "recommended reference  : %s        ", grgstrXRefName[p->nRecommended]);
+
+							FullScreen.TextWindowUpdateProgress();
+						}
+
+						gfRunXRef = false;
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunTimerLib)
+					{
+						TLB_RESULT* p = &gTimerLibResult;
+						int y = 7;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: TimerLib benchmark running, interrupts disabled per delay point");
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("TIANOCORE TIMERLIB BENCHMARK")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "TIANOCORE TIMERLIB BENCHMARK");
+
+						TimerLibBenchRun(p, (double)gTSCPerSecRTC);
+
+						FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "MicroSecondDelay() error in %% vs. TSC %.0f Hz", p->dblTSCPerSec);
+						FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s %7s %7s %7s %7s %7s %7s %7s %11s", "TimerLib", "1us", "10us", "100us", "1ms", "10ms", "100ms", "1s", "excess [us]");
+
+						for (int n = 0; n < TLB_NUMLIB; n++, y++)
+						{
+							TLB_LIB* pLib = &p->rgLib[n];
+
+							if (!pLib->fAvailable)
+							{
+								FullScreen.TextPrint({ 2, y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s N/A", pLib->pstrName);
+								continue;
+							}
+
+							FullScreen.TextPrint({ 2, y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s %+7.1f %+7.1f %+7.1f %+7.1f %+7.1f %+7.1f %+7.1f %11.1f",
+								pLib->pstrName,
+								pLib->rgMicro[0].dblErrPct, pLib->rgMicro[1].dblErrPct, pLib->rgMicro[2].dblErrPct, pLib->rgMicro[3].dblErrPct,
+								pLib->rgMicro[4].dblErrPct, pLib->rgMicro[5].dblErrPct, pLib->rgMicro[6].dblErrPct,
+								pLib->dblExcessUs);
+						}
+
+						if (0 != p->cntLib)
+							FullScreen.TextPrint({ 2, y + 1 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "most POST time lost     : %s, %.1f us per delay series", p->rgLib[p->nWorst].pstrName, p->rgLib[p->nWorst].dblExcessUs);
+
+						gfRunTimerLib = false;
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunTscTime)
+					{
+						TSCTIME_BENCH* p = &gTscTimeBench;
+						int y = 7;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: TSC delay service benchmark running, interrupts disabled per call");
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("TSC DELAY VS. INTERNALACPIDELAY")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "TSC DELAY VS. INTERNALACPIDELAY");
+
+						TscTimeBenchRun(p, (double)gTSCPerSecRTC);
+
+						FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "actual delay vs. TSC %.0f Hz, service runs on %lld Hz", p->dblTSCPerSec, gqwTscTimeFreq);
+						FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s %12s %10s %14s %14s %12s", "delay", "latency [ns]", "requested", "overshoot [ns]", "max. ovs. [ns]", "stddev [ns]");
+
+						for (int n = 0; n < TSCTIME_NUMIMPL; n++)
+						{
+							if (TSCTIME_ACPI == n && !p->fAcpi)
+							{
+								FullScreen.TextPrint({ 2, y++ }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s N/A", grgstrTscTimeName[n]);
+								continue;
+							}
+
+							for (int i = 0; i < TSCTIME_NUMDELAY; i++, y++)
+							{
+								TSCTIME_POINT* pPoint = &p->rgPoint[n][i];
+
+								FullScreen.TextPrint({ 2, y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-18s %12.1f %8uus %14.1f %14.1f %12.1f", 0 == i ? grgstrTscTimeName[n] : "", p->rgdblLatencyNs[n], pPoint->dwRequestedUs, pPoint->dblOvershootNs, pPoint->dblMaxOvershootNs, pPoint->dblStdDevNs);
+							}
+						}
+
+						if (p->fAcpi)
+							FullScreen.TextPrint({ 2, y + 1 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "precision TSC vs. ACPI  : %.0fx at 1us, %.0fx at 10us, %.0fx at 100us", p->rgdblPrecision[0], p->rgdblPrecision[1], p->rgdblPrecision[2]);
+
+						gfRunTscTime = false;
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunMpCont)
+					{
+						MPCONT_RESULT* p = &gMpContResult;
+						int y = 7;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: multi-core contention benchmark running on all APs");
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("MULTI-CORE TIMER READ CONTENTION")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "MULTI-CORE TIMER READ CONTENTION");
+
+						if (0 == MpContHwInit() || 0 != MpContentionRun(p, &gMpContHw, (double)gTSCPerSecRTC))
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "EFI_MP_SERVICES_PROTOCOL N/A, no AP enabled or AP startup failed");
+						else
+						{
+							FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%u APs, AP 0 calibrates over %dms while the others poll, TSC %.0f Hz", p->nAPs, MPCONT_CAL_MS, p->dblTSCPerSec);
+							FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-20s %5s %12s %10s %12s %8s %10s", "timer", "cores", "reads/s", "avg [ns]", "max [ns]", "torn", "cal. [ppm]");
+
+							for (int n = 0; n < MPCONT_NUMSRC; n++)
+							{
+								if (!p->rgfAvailable[n])
+								{
+									FullScreen.TextPrint({ 2, y++ }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-20s %5s", grgstrMpContName[n], "N/A");
+									continue;
+								}
+
+								for (uint32_t i = 0; i < p->nAPs && y < FullScreen.WinDim.Y - 4; i++, y++)	// all points in the MPCONTENTION worksheet
+								{
+									MPCONT_POINT* pPoint = &p->rgPoint[n][i];
+
+									FullScreen.TextPrint({ 2, y }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-20s %5u %12.0f %10.1f %12.1f %8llu %10.2f", 0 == i ? grgstrMpContName[n] : "", pPoint->nCores, pPoint->dblReadsPerSec, pPoint->dblAvgLatNs, pPoint->dblMaxLatNs, pPoint->cntTorn, pPoint->dblCalPpm);
+								}
+							}
+
+							FullScreen.TextPrint({ 2, y + 1 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "aggregate scaling %u vs. 1 core: ACPI %.2fx, PIT %.2fx", p->nAPs, p->rgdblScaling[MPCONT_ACPI], p->rgdblScaling[MPCONT_PIT]);
+						}
+
+						gfRunMpCont = false;
+
+						StatusLineHelp(&FullScreen);
+					}
+
+					if (gfRunBench)
+					{
+						BENCH_RESULT* p = &gBenchResult;
+						double dblNsPerCycle = 1e9 / (double)gTSCPerSecRTC;
+
+						MainWindowClear(&FullScreen);
+						StatusLineAttention(&FullScreen, "ATTENTION: timer primitives benchmark running");
+						FullScreen.TextPrint({ (FullScreen.WinDim.X - (int32_t)strlen("TIMER READ PRIMITIVES BENCHMARK")) / 2, 3 }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "TIMER READ PRIMITIVES BENCHMARK");
+
+						BenchRun(p, (double)gTSCPerSecRTC);
+
+						gfRunBench = false;
+
+						FullScreen.TextPrint({ 2, 5 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-22s %8s %8s %8s %10s %10s %10s", "primitive", "p50", "p99", "max", "p50", "p99", "max");
+						FullScreen.TextPrint({ 2, 6 }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-22s %8s %8s %8s %10s %10s %10s", "", "[cyc]", "[cyc]", "[cyc]", "[ns]", "[ns]", "[ns]");
+						for (int n = 0; n < p->cntStat; n++)
+							FullScreen.TextPrint({ 2, 7 + n }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%-22s %8lld %8lld %8lld %10.1f %10.1f %10.1f",
+								p->rgStat[n].pstrName,
+								p->rgStat[n].qwP50, p->rgStat[n].qwP99, p->rgStat[n].qwMax,
+								p->rgStat[n].qwP50 * dblNsPerCycle, p->rgStat[n].qwP99 * dblNsPerCycle, p->rgStat[n].qwMax * dblNsPerCycle);
+						FullScreen.TextPrint({ 2, 8 + BENCH_NUMPRIM }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "%d samples, overhead %lld cycles subtracted except ACPI wait, TSC %lldHz", BENCH_SAMPLES, p->qwOverhead, gTSCPerSecRTC);
+
+						StatusLineHelp(&FullScreen);
+					}
+
 					if (gfRunConfig)
 					{
 						uint64_t seconds = 0;
@@ -2660,6 +5186,20 @@ int main(int argc, char** argv)
 							clock_t endsec = (clock_t)seconds + clock() / CLOCKS_PER_SEC;
 							bool fStop = false;
 
+							gcntClkWaitGlitch = gcntClkWaitSamples = gcntClkWaitWrapLost = gqwClkWaitWindowMax = 0;
+
+							//
+							// synthetic background load on APs, /APLOAD
+							//
+							if (0 != gApLoad.dwTypes)
+							{
+								gApLoadHw.nAPs = MpContHwInit();
+								gApLoadHw.pfnReadIo = gMpContHw.pfnReadAcpi;			// NULL without PM timer, IO dropped
+
+								if (0 == ApLoadStart(&gApLoad, &gApLoadHw))		// report now, no AP enabled, out of memory or AP startup failed
+									FullScreen.TextPrint({ 5, 7 + 3 * (int)ELC(parms) }, EFI_BACKGROUND_LIGHTGRAY | EFI_RED, "AP load during calibration: %s", ApLoadDescribe(&gApLoad, gstrApLoad, sizeof(gstrApLoad)));
+							}
+
 							for (int i = 0, l = 0; i < ELC(parms); i++)
 							{
 								char strbuftmp[128];
@@ -2674,8 +5214,13 @@ int main(int argc, char** argv)
 								if (1)
 								{
 									uint64_t secondsold = 0;
+
+									ClkWaitTelemetryReset();
+
 									for (int j = 0; j < cntSamples; j++)
 									{
+										CLKWAIT_DIAG Diag;
+
                                         //
                                         // kgtest
                                         //
@@ -2684,8 +5229,9 @@ int main(int argc, char** argv)
                                         //    iCPD = 0;//kgtest
                                         //}
 
-										FullScreen.TextBlockDraw({ 2,2}, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "Additional ticks gone through: ");
-										parms[i].rgDiffTSC[j] = pfnDelay(parms[i].delay);
+										parms[i].rgDiffTSC[j] = pfnDelay(parms[i].delay, &Diag);
+										ClkWaitTelemetryPost(&Diag);
+										ClkWaitTelemetryDrain(&FullScreen, 2);
 
                                         //
                                         // kgtest
@@ -2732,8 +5278,17 @@ int main(int argc, char** argv)
 								}
 
 								FullScreen.TextBlockDraw({ 5 + (int)strlen(strbuftmp),5 + 3 * l }, EFI_BACKGROUND_LIGHTGRAY | EFI_WHITE, "FINISHED");
+								FullScreen.TextPrint({ 5, 6 + 3 * l }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "drift std. deviation %.3fs per day, timestamp policy %s", DriftStdDev(parms[i].rgDriftSecPerDay, cntSamples), grgstrTimestampPolicy[gnTimestampPolicy]);
 								l++;
 							}//for (int i = 0, l = 0; i < ELC(parms); i++)
+
+							ApLoadStop(&gApLoad, &gApLoadHw);
+							ApLoadDescribe(&gApLoad, gstrApLoad, sizeof(gstrApLoad));
+							if (0 != gApLoad.nActive || 0 == gApLoad.dwTypes)	// a failed start is reported already
+								FullScreen.TextPrint({ 5, 7 + 3 * (int)ELC(parms) }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "AP load during calibration: %s", gstrApLoad);
+
+							if (pfnDelay != &InternalAcpiDelay)
+								FullScreen.TextPrint({ 5, 6 + 3 * (int)ELC(parms) }, EFI_BACKGROUND_LIGHTGRAY | EFI_BLACK, "counter glitches: %lld in %lld samples, %s", gcntClkWaitGlitch, gcntClkWaitSamples, ClkWaitGlitchVerdict());
 						}
 
 						if (1)
@@ -2822,7 +5377,14 @@ int main(int argc, char** argv)
 				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCACPI = %hhd\n\
 				gidxCfgMngMnuItm_Config_NumSamples = %d\n\
 				gCfgStr_File_SaveAs = %s\n\
-				gfErrorCorrection = %hhd\n",
+				gfErrorCorrection = %hhd\n\
+				gnTimestampPolicy = %d\n\
+				gfVerifiedRead = %d\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP = %hhd\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC = %hhd\n\
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2 = %hhd\n\
+				gfAcpiTmrSts = %d\n\
+				gfChunkedWait = %d\n",
 				
 				gfCfgMngMnuItm_View_Clock,
 				gfCfgMngMnuItm_View_Calendar,
@@ -2843,7 +5405,14 @@ int main(int argc, char** argv)
 
 				gidxCfgMngMnuItm_Config_NumSamples,
 				gCfgStr_File_SaveAs,
-				gfErrorCorrection
+				gfErrorCorrection,
+				gnTimestampPolicy,
+				gfVerifiedRead,
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCTSTAMP,
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCAPIC,
+				gfCfgMngMnuItm_Config_CalibMethodSelectTSCSYNCOUT2,
+				gfAcpiTmrSts,
+				gfChunkedWait
 
 			);
 			fclose(fp);